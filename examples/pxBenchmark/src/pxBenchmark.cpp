@@ -271,6 +271,12 @@ void benchmarkWindow::reset()
         case pxApiFixture::type::xDrawTextureQuads:
             mGroupName = "DrawTextureQuads";
             break;
+        case pxApiFixture::type::xDrawTextScaled:
+            mGroupName = "DrawTextScaled";
+            break;
+        case pxApiFixture::type::xDrawTextScaledSDF:
+            mGroupName = "DrawTextScaledSDF";
+            break;
         /*case pxApiFixture::type::xDrawImage9Ran:
             mGroupName = "DrawImage9Ran";
             break;
@@ -388,6 +394,13 @@ void benchmarkWindow::onDraw(pxSurfaceNative/*&*/ sn)
         float fillColor[] = {0.0, 0.0, 0.0, 1.0};
         context.clear(0, 0, fillColor);
         
+        if (mApiFixture->popExperimentValue().Value == pxApiFixture::type::xDrawTextScaled ||
+            mApiFixture->popExperimentValue().Value == pxApiFixture::type::xDrawTextScaledSDF)
+        {
+            // glyph textures rasterised so far; SDF mode should add one set only
+            std::cout << mGroupName << " glyph textures: " << pxFontManager::glyphTextureCount() << std::endl;
+        }
+        
         mApiFixture->popExperimentValue().Value++;
         
         mApiFixture->setIterationCounter(0);
@@ -631,6 +644,41 @@ void pxApiFixture::TestDrawTextureQuads()
     context.drawTexturedQuads(1, verts, uvs, mTextureRef, color);
 }
 
+// Emulates a focus zoom on a tile title: the same string drawn while the
+// scale sweeps between 1x and 3x.  Coverage glyphs are rasterised again for
+// each pixel size bucket, SDF glyphs are rasterised once and scaled in the shader.
+void pxApiFixture::TestDrawTextScaled(bool sdf)
+{
+#ifdef PXSCENE_FONT_ATLAS
+    static float color[4] = {1.0, 1.0, 1.0, 1.0};
+    
+    if (mFont.getPtr() == NULL)
+        mFont = pxFontManager::getFont(defaultFont);
+    
+    if (!mFont->isFontLoaded())
+        return;
+    
+    pxFontManager::setSDFEnabled(sdf);
+    
+    float scale = 1.0f + 2.0f * (float)(mIterationCounter % 64) / 64.0f;
+    
+    pxMatrix4f m;
+    m.translate(mCurrentX, mCurrentY);
+    m.scale(scale, scale);
+    context.setMatrix(m);
+    
+    mFont->renderTextToQuads("Focus Zoom Tile Title 0123456789", 20, scale, scale, mTextQuads);
+    mTextQuads.draw(0, 0, color);
+    
+    pxMatrix4f identity;
+    context.setMatrix(identity);
+    
+    pxFontManager::setSDFEnabled(false);
+#else
+    (void)sdf;
+#endif
+}
+
 void pxApiFixture::TestDrawOffscreen()
 {
     /*pxOffscreen offscreen;
@@ -768,6 +816,12 @@ void pxApiFixture::onExperimentStart(const celero::TestFixture::ExperimentValue&
         case xDrawTextureQuads:
             TestDrawTextureQuads();
             break;
+        case xDrawTextScaled:
+            TestDrawTextScaled(false);
+            break;
+        case xDrawTextScaledSDF:
+            TestDrawTextScaled(true);
+            break;
         /*case xDrawImage9Ran:
             TestDrawImage9Ran();
             break;
@@ -34,6 +34,7 @@
 using namespace celero;
 
 #include "pxTexture.h"
+#include "pxFont.h"
 //-----------------------------------------------------------------------------------
 //  class pxBenchmarkExperimentValue
 //  Notes: This is class is degined to test the performance of graphics API
@@ -96,6 +97,10 @@ class pxApiFixture : public celero::TestFixture
     pxTextureRef                              mTextureMaskRef;
     bool                                      mDoCreateTexture;
     std::shared_ptr<Experiment>                    mExp;
+#ifdef PXSCENE_FONT_ATLAS
+    rtRef<pxFont>                             mFont;
+    pxTexturedQuads                           mTextQuads;
+#endif
     
     void TestDrawRect ();
     void TestDrawDiagLine ();
@@ -109,6 +114,7 @@ class pxApiFixture : public celero::TestFixture
     void TestDrawImageMasked ();
     void TestDrawTextureQuads ();
     void TestDrawOffscreen ();
+    void TestDrawTextScaled (bool sdf);
     
     void TestDrawImageRan ();
     void TestDrawImage9Ran ();
@@ -129,6 +135,8 @@ public:
         xDrawImageBorder9,
         xDrawImageMasked,
         xDrawTextureQuads,
+        xDrawTextScaled,
+        xDrawTextScaledSDF,
         //xDrawOffscreen,
         /*xDrawImageRan,
         xDrawImage9Ran,
@@ -290,6 +290,9 @@ protected:
     pxFontManager::clearAllFonts();
     rtLogInfo("cleared all the fonts during close");
     fflush(stdout);
+#if defined(ENABLE_RT_NODE) && defined(RUNINMAIN)
+    pxScriptView::clearContextPool();
+#endif
     context.term();
 #ifdef RUNINMAIN
     script.pump();
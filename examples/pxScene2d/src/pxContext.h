@@ -129,6 +129,11 @@ class pxContext {
   // 6 vertices (12 floats) and 6 uvs (12 floats) per quad
   void drawTexturedQuads(int numQuads, const void *verts, const void* uvs,
                           pxTextureRef t, float* color);
+  // Same layout as drawTexturedQuads but t holds signed distance field glyphs.
+  // spread is the distance encoded on each side of the outline, in the same
+  // units as verts, and is used to antialias the edge at the current scale.
+  void drawSDFTexturedQuads(int numQuads, const void *verts, const void* uvs,
+                          pxTextureRef t, float* color, float spread);
 #endif                          
 
   void drawImage9(float w, float h, float x1, float y1,
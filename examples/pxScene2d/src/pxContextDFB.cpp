@@ -595,16 +595,19 @@ public:
 
     // premultiply
 #if 1
-    for (int y = 0; y < mOffscreen.height(); y++)
+    if (!o.premultiplied())
     {
-      pxPixel* d  = mOffscreen.scanline(y);
-      pxPixel* de = d + mOffscreen.width();
-      while (d < de)
+      for (int y = 0; y < mOffscreen.height(); y++)
       {
-        d->r = (d->r * d->a)/255;
-        d->g = (d->g * d->a)/255;
-        d->b = (d->b * d->a)/255;
-        d++;
+        pxPixel* d  = mOffscreen.scanline(y);
+        pxPixel* de = d + mOffscreen.width();
+        while (d < de)
+        {
+          d->r = (d->r * d->a)/255;
+          d->g = (d->g * d->a)/255;
+          d->b = (d->b * d->a)/255;
+          d++;
+        }
       }
     }
 #endif
@@ -32,6 +32,7 @@
 #include <algorithm>
 #include <ctime>
 #include <cstdlib>
+#include <cstring>
 
 #ifdef __APPLE__
 #include <GLUT/glut.h>
@@ -123,7 +124,7 @@ extern pxContext context;
 rtThreadQueue* gUIThreadQueue = new rtThreadQueue();
 
 enum pxCurrentGLProgram { PROGRAM_UNKNOWN = 0, PROGRAM_SOLID_SHADER,  PROGRAM_A_TEXTURE_SHADER, PROGRAM_TEXTURE_SHADER,
-    PROGRAM_TEXTURE_MASKED_SHADER, PROGRAM_TEXTURE_BORDER_SHADER};
+    PROGRAM_TEXTURE_MASKED_SHADER, PROGRAM_TEXTURE_BORDER_SHADER, PROGRAM_SDF_TEXTURE_SHADER};
 
 pxCurrentGLProgram currentGLProgram = PROGRAM_UNKNOWN;
 
@@ -136,6 +137,14 @@ extern EGLContext defaultEglContext;
 static int gResW, gResH;
 static pxMatrix4f gMatrix;
 static float gAlpha = 1.0;
+static bool gAutoMipmapImages = false;
+// GLES2 leaves a mipmapped NPOT texture with REPEAT wrap incomplete
+static bool gNpotMipmaps = true;
+
+static inline bool isPowerOfTwo(int n)
+{
+  return n > 0 && (n & (n - 1)) == 0;
+}
 uint32_t gRenderTick = 0;
 std::vector<pxTexture*> textureList;
 rtMutex textureListMutex;
@@ -294,6 +303,27 @@ static const char *fATextureShaderText =
   "  gl_FragColor = a_color*a;"
   "}";
 
+#ifdef PXSCENE_FONT_ATLAS
+// assume premultiplied
+// distance fields are stored with the outline at 0.5; u_smoothing is the
+// half width of the antialiasing ramp in distance units for one screen pixel
+static const char *fSDFTextureShaderText =
+  "#ifdef GL_ES \n"
+  "  precision mediump float; \n"
+  "#endif \n"
+  "uniform sampler2D s_texture;"
+  "uniform float u_alpha;"
+  "uniform float u_smoothing;"
+  "uniform vec4 a_color;"
+  "varying vec2 v_uv;"
+  "void main()"
+  "{"
+  "  float d = texture2D(s_texture, v_uv).a;"
+  "  float a = u_alpha * smoothstep(0.5 - u_smoothing, 0.5 + u_smoothing, d);"
+  "  gl_FragColor = a_color*a;"
+  "}";
+#endif //PXSCENE_FONT_ATLAS
+
 static const char *vShaderText =
   "uniform vec2 u_resolution;"
   "uniform mat4 amymatrix;"
@@ -646,29 +676,21 @@ public:
       while (newTextureWidth > MAX_TEXTURE_WIDTH)
       {
         horizontalScale <<= 1;
-        newTextureWidth >>= 1;
+        newTextureWidth = (srcTextureWidth + horizontalScale - 1) / horizontalScale;
       }
       while (newTextureHeight > MAX_TEXTURE_HEIGHT)
       {
         verticalScale <<= 1;
-        newTextureHeight >>= 1;
+        newTextureHeight = (srcTextureHeight + verticalScale - 1) / verticalScale;
       }
     }
     mWidth = srcTextureWidth;
     mHeight = srcTextureHeight;
     if ( (horizontalScale > 1) || (verticalScale > 1 ) )
     {
-       mOffscreen.init(newTextureWidth, newTextureHeight);
-       mOffscreen.setUpsideDown(true);
-       int y = 0;
-       for (int j = 0; j < srcTextureHeight-1; j += verticalScale, y++ )
-       {
-          int x = 0;
-          for (int k = 0; k < srcTextureWidth-1; k += horizontalScale, x++)
-          {
-             o.blit(mOffscreen, x, y, 1,1,k,j);
-          }
-       }
+       // Box filter rather than point sample so the reduced texture doesn't
+       // alias; flipped to match GL FBO layout
+       pxReduceImage(o, mOffscreen, horizontalScale, verticalScale, true);
     }
     else
     {
@@ -687,16 +709,19 @@ public:
 #endif //ENABLE_MAX_TEXTURE_SIZE
 
     // premultiply
-    for (int y = 0; y < mOffscreen.height(); y++)
+    if (!o.premultiplied())
     {
-      pxPixel* d = mOffscreen.scanline(y);
-      pxPixel* de = d + mOffscreen.width();
-      while (d < de)
+      for (int y = 0; y < mOffscreen.height(); y++)
       {
-        d->r = (d->r * d->a)/255;
-        d->g = (d->g * d->a)/255;
-        d->b = (d->b * d->a)/255;
-        d++;
+        pxPixel* d = mOffscreen.scanline(y);
+        pxPixel* de = d + mOffscreen.width();
+        while (d < de)
+        {
+          d->r = (d->r * d->a)/255;
+          d->g = (d->g * d->a)/255;
+          d->b = (d->b * d->a)/255;
+          d++;
+        }
       }
     }
 
@@ -952,6 +977,60 @@ public:
     return PX_OK;
   }
 
+  // Replaces part of an uploaded texture.  buffer holds w*h straight alpha
+  // pixels, top row first.  Fails if the texture isn't on the GPU at full size
+  // so the caller can recreate it instead.
+  virtual pxError updateTexture(int x, int y, int w, int h, void* buffer)
+  {
+    if (!mInitialized || !mTextureUploaded || mTextureName == 0 || buffer == NULL)
+    {
+      return PX_FAIL;
+    }
+#ifdef ENABLE_MAX_TEXTURE_SIZE
+    if (mWidth > MAX_TEXTURE_WIDTH || mHeight > MAX_TEXTURE_HEIGHT)
+    {
+      return PX_FAIL;
+    }
+#endif //ENABLE_MAX_TEXTURE_SIZE
+    if (x < 0 || y < 0 || w <= 0 || h <= 0 || x + w > mWidth || y + h > mHeight)
+    {
+      return PX_FAIL;
+    }
+
+    // premultiply and flip to match the GL FBO layout used by createTexture
+    pxPixel* pixels = (pxPixel*)malloc(w * h * sizeof(pxPixel));
+    if (pixels == NULL)
+    {
+      return PX_FAIL;
+    }
+    for (int j = 0; j < h; j++)
+    {
+      pxPixel* s = (pxPixel*)buffer + (h - 1 - j) * w;
+      pxPixel* d = pixels + j * w;
+      pxPixel* de = d + w;
+      while (d < de)
+      {
+        d->r = (s->r * s->a)/255;
+        d->g = (s->g * s->a)/255;
+        d->b = (s->b * s->a)/255;
+        d->a = s->a;
+        d++;
+        s++;
+      }
+    }
+
+    glBindTexture(GL_TEXTURE_2D, mTextureName);   TRACK_TEX_CALLS();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, mHeight - y - h, w, h,
+                    GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    if (mMipmapCreated)
+    {
+      glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    free(pixels);
+    return PX_OK;
+  }
+
   virtual pxError getOffscreen(pxOffscreen& o)
   {
     if (!mInitialized)
@@ -1563,6 +1642,84 @@ aTextureShaderProgram *gATextureShader = NULL;
 
 //====================================================================================================================================================================================
 
+#ifdef PXSCENE_FONT_ATLAS
+class sdfTextureShaderProgram: public shaderProgram
+{
+protected:
+  virtual void prelink()
+  {
+    mPosLoc = 0;
+    mUVLoc = 1;
+    glBindAttribLocation(mProgram, mPosLoc, "pos");
+    glBindAttribLocation(mProgram, mUVLoc,  "uv");
+  }
+
+  virtual void postlink()
+  {
+    mResolutionLoc = getUniformLocation("u_resolution");
+    mMatrixLoc     = getUniformLocation("amymatrix");
+    mColorLoc      = getUniformLocation("a_color");
+    mAlphaLoc      = getUniformLocation("u_alpha");
+    mSmoothingLoc  = getUniformLocation("u_smoothing");
+    mTextureLoc    = getUniformLocation("s_texture");
+  }
+
+public:
+  pxError draw(int resW, int resH, float* matrix, float alpha,
+            int count,
+            const void* pos,
+            const void* uv,
+            pxTextureRef texture,
+            const float* color,
+            float smoothing)
+  {
+    if (currentGLProgram != PROGRAM_SDF_TEXTURE_SHADER)
+    {
+      use();
+      currentGLProgram = PROGRAM_SDF_TEXTURE_SHADER;
+    }
+    glUniform2f(mResolutionLoc, static_cast<GLfloat>(resW), static_cast<GLfloat>(resH));
+    glUniformMatrix4fv(mMatrixLoc, 1, GL_FALSE, matrix);
+    glUniform1f(mAlphaLoc, alpha);
+    glUniform1f(mSmoothingLoc, smoothing);
+    glUniform4fv(mColorLoc, 1, color);
+
+    if (texture->bindGLTexture(mTextureLoc) != PX_OK)
+    {
+      return PX_FAIL;
+    }
+
+    glVertexAttribPointer(mPosLoc, 2, GL_FLOAT, GL_FALSE, 0, pos);
+    glVertexAttribPointer(mUVLoc, 2, GL_FLOAT, GL_FALSE, 0, uv);
+    glEnableVertexAttribArray(mPosLoc);
+    glEnableVertexAttribArray(mUVLoc);
+    glDrawArrays(GL_TRIANGLES, 0, count);  TRACK_DRAW_CALLS();
+    glDisableVertexAttribArray(mPosLoc);
+    glDisableVertexAttribArray(mUVLoc);
+
+    return PX_OK;
+  }
+
+private:
+  GLint mResolutionLoc;
+  GLint mMatrixLoc;
+
+  GLint mPosLoc;
+  GLint mUVLoc;
+
+  GLint mColorLoc;
+  GLint mAlphaLoc;
+  GLint mSmoothingLoc;
+
+  GLint mTextureLoc;
+
+}; //CLASS - sdfTextureShaderProgram
+
+sdfTextureShaderProgram *gSDFTextureShader = NULL;
+#endif //PXSCENE_FONT_ATLAS
+
+//====================================================================================================================================================================================
+
 class textureShaderProgram: public shaderProgram
 {
 protected:
@@ -2202,6 +2359,9 @@ pxContext::~pxContext()
   SAFE_DELETE(gTextureShader);
   SAFE_DELETE(gTextureBorderShader);
   SAFE_DELETE(gTextureMaskedShader);
+#ifdef PXSCENE_FONT_ATLAS
+  SAFE_DELETE(gSDFTextureShader);
+#endif
 }
 
 void pxContext::init()
@@ -2220,6 +2380,9 @@ void pxContext::init()
   SAFE_DELETE(gTextureShader);
   SAFE_DELETE(gTextureBorderShader);
   SAFE_DELETE(gTextureMaskedShader);
+#ifdef PXSCENE_FONT_ATLAS
+  SAFE_DELETE(gSDFTextureShader);
+#endif
 
   gSolidShader = new solidShaderProgram();
   gSolidShader->init(vShaderText,fSolidShaderText);
@@ -2235,6 +2398,11 @@ void pxContext::init()
 
   gTextureMaskedShader = new textureMaskedShaderProgram();
   gTextureMaskedShader->init(vShaderText,fTextureMaskedShaderText);
+
+#ifdef PXSCENE_FONT_ATLAS
+  gSDFTextureShader = new sdfTextureShaderProgram();
+  gSDFTextureShader->init(vShaderText,fSDFTextureShaderText);
+#endif
   
   glEnable(GL_BLEND);
 
@@ -2257,6 +2425,14 @@ void pxContext::init()
   {
     setTextureMemoryLimit((int64_t)val.toInt32() * (int64_t)1024 * (int64_t)1024);
   }
+  if (RT_OK == rtSettings::instance()->value("autoMipmapImages", val))
+  {
+    gAutoMipmapImages = val.toString().compare("true") == 0;
+  }
+#if defined(PX_PLATFORM_WAYLAND_EGL) || defined(PX_PLATFORM_GENERIC_EGL)
+  const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+  gNpotMipmaps = extensions && strstr(extensions, "GL_OES_texture_npot") != NULL;
+#endif
   if (mEnableTextureMemoryMonitoring)
   {
     rtLogInfo("texture memory limit set to %" PRId64 " bytes, threshold padding %" PRId64 " bytes",
@@ -2609,6 +2785,18 @@ void pxContext::drawImage(float x, float y, float w, float h,
   }
 
   t->setLastRenderTick(gRenderTick);
+
+  // Minified by half or more on screen ... sample a mip chain so the image
+  // doesn't shimmer and reads less texture memory
+  if (gAutoMipmapImages && !downscaleSmooth)
+  {
+    float* m = gMatrix.data();
+    float screenW = w * sqrtf(m[0]*m[0] + m[1]*m[1]);
+    float screenH = h * sqrtf(m[4]*m[4] + m[5]*m[5]);
+
+    downscaleSmooth = (screenW * 2 <= t->width()) && (screenH * 2 <= t->height()) &&
+                      (gNpotMipmaps || (isPowerOfTwo(t->width()) && isPowerOfTwo(t->height())));
+  }
   t->setDownscaleSmooth(downscaleSmooth);
 
   if (mask.getPtr() != NULL)
@@ -2658,6 +2846,41 @@ void pxContext::drawTexturedQuads(int numQuads, const void *verts, const void* u
   premultiply(colorPM,color);
   gATextureShader->draw(gResW,gResH,gMatrix.data(),gAlpha,GL_TRIANGLES,6*numQuads,verts,uvs,t,colorPM);
 }
+
+void pxContext::drawSDFTexturedQuads(int numQuads, const void *verts, const void* uvs,
+                          pxTextureRef t, float* color, float spread)
+{
+#ifdef DEBUG_SKIP_IMAGE
+#warning "DEBUG_SKIP_IMAGE enabled ... Skipping "
+  return;
+#endif
+
+  // TRANSPARENT
+  if(gAlpha == 0.0)
+  {
+    return;
+  }
+
+  // TEXTURELESS
+  if (t.getPtr() == NULL)
+  {
+    return;
+  }
+
+  t->setLastRenderTick(gRenderTick);
+
+  // spread in screen pixels; the field covers 2*spread pixels over [0,1]
+  // so a one pixel wide ramp is 1/(2*spread) wide, half of that each side
+  float* m = gMatrix.data();
+  float screenSpread = spread * sqrtf(m[0]*m[0] + m[1]*m[1]);
+  if (screenSpread < 0.001f)
+    screenSpread = 0.001f;
+  float smoothing = pxClamp<float>(0.25f / screenSpread, 0.001f, 0.5f);
+
+  float colorPM[4];
+  premultiply(colorPM,color);
+  gSDFTextureShader->draw(gResW,gResH,gMatrix.data(),gAlpha,6*numQuads,verts,uvs,t,colorPM,smoothing);
+}
 #endif
 
 void pxContext::drawDiagRect(float x, float y, float w, float h, float* color)
@@ -24,6 +24,8 @@
 #include "pxTimer.h"
 #include "pxText.h"
 
+#include "rtSettings.h"
+
 #include <math.h>
 #include <map>
 
@@ -81,6 +83,109 @@ uint32_t npot(uint32_t i)
 
 #ifdef PXSCENE_FONT_ATLAS
 pxFontAtlas gFontAtlas;
+
+// SDF glyphs are keyed by a pixel size that no rasterised glyph can use
+#define PXSCENE_FONT_SDF_KEY_SIZE (0x80000000 | PXSCENE_FONT_SDF_PIXEL_SIZE)
+
+struct sdfPoint
+{
+  int32_t dx, dy;
+  int32_t dist2() const { return dx*dx + dy*dy; }
+};
+
+static const sdfPoint sdfInside = { 0, 0 };
+static const sdfPoint sdfEmpty = { 9999, 9999 };
+
+static inline void sdfCompare(vector<sdfPoint>& g, int32_t w, int32_t h, sdfPoint& p,
+                              int32_t x, int32_t y, int32_t ox, int32_t oy)
+{
+  int32_t nx = x + ox;
+  int32_t ny = y + oy;
+  if (nx < 0 || ny < 0 || nx >= w || ny >= h)
+    return;
+  sdfPoint other = g[ny*w+nx];
+  other.dx += ox;
+  other.dy += oy;
+  if (other.dist2() < p.dist2())
+    p = other;
+}
+
+// 8SSEDT - two pass sequential euclidean distance transform
+static void sdfTransform(vector<sdfPoint>& g, int32_t w, int32_t h)
+{
+  for (int32_t y = 0; y < h; y++)
+  {
+    for (int32_t x = 0; x < w; x++)
+    {
+      sdfPoint p = g[y*w+x];
+      sdfCompare(g, w, h, p, x, y, -1,  0);
+      sdfCompare(g, w, h, p, x, y,  0, -1);
+      sdfCompare(g, w, h, p, x, y, -1, -1);
+      sdfCompare(g, w, h, p, x, y,  1, -1);
+      g[y*w+x] = p;
+    }
+    for (int32_t x = w-1; x >= 0; x--)
+    {
+      sdfPoint p = g[y*w+x];
+      sdfCompare(g, w, h, p, x, y, 1, 0);
+      g[y*w+x] = p;
+    }
+  }
+  for (int32_t y = h-1; y >= 0; y--)
+  {
+    for (int32_t x = w-1; x >= 0; x--)
+    {
+      sdfPoint p = g[y*w+x];
+      sdfCompare(g, w, h, p, x, y,  1,  0);
+      sdfCompare(g, w, h, p, x, y,  0,  1);
+      sdfCompare(g, w, h, p, x, y, -1,  1);
+      sdfCompare(g, w, h, p, x, y,  1,  1);
+      g[y*w+x] = p;
+    }
+    for (int32_t x = 0; x < w; x++)
+    {
+      sdfPoint p = g[y*w+x];
+      sdfCompare(g, w, h, p, x, y, -1, 0);
+      g[y*w+x] = p;
+    }
+  }
+}
+
+// Build an 8 bit signed distance field from a FreeType coverage bitmap.
+// dst must hold (w+2*spread)*(h+2*spread) bytes; 128 is the outline,
+// larger values are inside the glyph.
+static void pxGenerateSDF(const uint8_t* src, int32_t w, int32_t h, int32_t pitch,
+                          int32_t spread, uint8_t* dst)
+{
+  int32_t dw = w + 2*spread;
+  int32_t dh = h + 2*spread;
+  vector<sdfPoint> outside(dw*dh, sdfEmpty);
+  vector<sdfPoint> inside(dw*dh, sdfInside);
+
+  for (int32_t y = 0; y < h; y++)
+  {
+    const uint8_t* s = src + y*pitch;
+    for (int32_t x = 0; x < w; x++)
+    {
+      if (s[x] >= 128)
+      {
+        outside[(y+spread)*dw+x+spread] = sdfInside;
+        inside[(y+spread)*dw+x+spread] = sdfEmpty;
+      }
+    }
+  }
+
+  sdfTransform(outside, dw, dh);
+  sdfTransform(inside, dw, dh);
+
+  for (int32_t i = 0; i < dw*dh; i++)
+  {
+    float d = sqrtf(static_cast<float>(inside[i].dist2())) -
+              sqrtf(static_cast<float>(outside[i].dist2()));
+    float v = 128.0f + d * (127.0f / spread);
+    dst[i] = static_cast<uint8_t>(pxClamp<float>(v, 0.0f, 255.0f));
+  }
+}
 #endif
 
 pxFont::pxFont(rtString fontUrl, uint32_t id, rtString proxyUrl):pxResource(),mFace(NULL),mPixelSize(0), mFontData(0), mFontDataSize(0),
@@ -362,6 +467,10 @@ void pxFont::getMetrics(uint32_t size, float& height, float& ascender, float& de
 GlyphTextureEntry pxFont::getGlyphTexture(uint32_t codePoint, float sx, float sy)
 {
   GlyphTextureEntry result;
+#ifdef PXSCENE_FONT_ATLAS
+  if (pxFontManager::isSDFEnabled())
+    return getSDFGlyphTexture(codePoint);
+#endif
   // Select a glyph texture better suited for rendering the glyph
   // taking pixelSize and scale into account
   uint32_t pixelSize=(uint32_t)ceil((sx>sy?sx:sy)*mPixelSize);
@@ -432,6 +541,64 @@ GlyphTextureEntry pxFont::getGlyphTexture(uint32_t codePoint, float sx, float sy
   }
   return result;  
 }
+
+#ifdef PXSCENE_FONT_ATLAS
+GlyphTextureEntry pxFont::getSDFGlyphTexture(uint32_t codePoint)
+{
+  GlyphTextureEntry result;
+
+  GlyphKey key;
+  key.mFontId = mFontId;
+  key.mPixelSize = PXSCENE_FONT_SDF_KEY_SIZE;
+  key.mCodePoint = codePoint;
+  GlyphTextureCache::iterator it = gGlyphTextureCache.find(key);
+  if (it != gGlyphTextureCache.end())
+    return it->second;
+
+  // One rasterisation at a fixed size serves every pixel size and scale
+  FT_Set_Pixel_Sizes(mFace, 0, PXSCENE_FONT_SDF_PIXEL_SIZE);
+  if(!FT_Load_Char(mFace, codePoint, FT_LOAD_RENDER))
+  {
+    rtLogDebug("sdf glyph texture cache miss");
+
+    FT_GlyphSlot g = mFace->glyph;
+    int32_t w = static_cast<int32_t>(g->bitmap.width);
+    int32_t h = static_cast<int32_t>(g->bitmap.rows);
+
+    result.sdf = true;
+    if (w > 0 && h > 0)
+    {
+      const int32_t spread = PXSCENE_FONT_SDF_SPREAD;
+      int32_t dw = w + 2*spread;
+      int32_t dh = h + 2*spread;
+      vector<uint8_t> field(dw*dh);
+      pxGenerateSDF(g->bitmap.buffer, w, h, g->bitmap.pitch, spread, &field[0]);
+
+      if (!gFontAtlas.addGlyph(dw, dh, &field[0], result))
+      {
+        rtLogWarn("SDF glyph not in atlas");
+        result.t = context.createTexture(static_cast<float>(dw), static_cast<float>(dh),
+                                         static_cast<float>(dw), static_cast<float>(dh),
+                                         &field[0]);
+        result.u1 = 0;
+        result.v1 = 1;
+        result.u2 = 1;
+        result.v2 = 0;
+      }
+
+      result.sdfLeft = static_cast<float>(g->bitmap_left - spread);
+      result.sdfTop = static_cast<float>(g->bitmap_top + spread);
+      result.sdfWidth = static_cast<float>(dw);
+      result.sdfHeight = static_cast<float>(dh);
+    }
+
+    gGlyphTextureCache.insert(make_pair(key,result));
+  }
+  // restore current pixelSize
+  FT_Set_Pixel_Sizes(mFace, 0, mPixelSize);
+  return result;
+}
+#endif
   
 const GlyphCacheEntry* pxFont::getGlyph(uint32_t codePoint)
 {
@@ -488,14 +655,14 @@ void pxFont::measureTextInternal(const char* text, uint32_t size,  float sx, flo
   if (!text) 
     return;
     
-  int i = 0;
+  rtUtf8Reader reader(text);
   u_int32_t codePoint;
   
   FT_Size_Metrics* metrics = &mFace->size->metrics;
   
   h = static_cast<float>(metrics->height>>6);
   float lw = 0;
-  while((codePoint = u8_nextchar((char*)text, &i)) != 0) 
+  while((codePoint = reader.next()) != 0) 
   {
     const GlyphCacheEntry* entry = getGlyph(codePoint);
     if (!entry) 
@@ -528,13 +695,13 @@ void pxFont::renderText(const char *text, uint32_t size, float x, float y,
     return;
   }
 
-  int i = 0;
+  rtUtf8Reader reader(text);
   u_int32_t codePoint;
 
   setPixelSize(size);
   FT_Size_Metrics* metrics = &mFace->size->metrics;
   
-  while((codePoint = u8_nextchar((char*)text, &i)) != 0) 
+  while((codePoint = reader.next()) != 0) 
   {
     const GlyphCacheEntry* entry = getGlyph(codePoint);
     if (!entry) 
@@ -608,13 +775,13 @@ void pxFont::renderTextToQuads(const char *text, uint32_t size,
     return;
   }
 
-  int i = 0;
+  rtUtf8Reader reader(text);
   u_int32_t codePoint;
 
   setPixelSize(size);
   FT_Size_Metrics* metrics = &mFace->size->metrics;
   
-  while((codePoint = u8_nextchar((char*)text, &i)) != 0) 
+  while((codePoint = reader.next()) != 0) 
   {
     GlyphCacheEntry* entry = (GlyphCacheEntry*)getGlyph(codePoint);
 
@@ -632,9 +799,19 @@ void pxFont::renderTextToQuads(const char *text, uint32_t size,
       
       GlyphTextureEntry t = getGlyphTexture(codePoint, nsx, nsy);
 
-      pxTextureRef nullImage;
-
-      quads.addQuad(x2,y2,x2+w,y2+h,t.u1,t.v1,t.u2,t.v2,t.t);
+      if (t.sdf)
+      {
+        if (t.sdfWidth > 0)
+        {
+          // scale the padded SDF quad from the SDF size to the text size
+          float k = static_cast<float>(size) / PXSCENE_FONT_SDF_PIXEL_SIZE;
+          float sx1 = x + t.sdfLeft*k;
+          float sy1 = (y - t.sdfTop*k) + (metrics->ascender>>6);
+          quads.addQuad(sx1,sy1,sx1+t.sdfWidth*k,sy1+t.sdfHeight*k,t.u1,t.v1,t.u2,t.v2,t.t,k);
+        }
+      }
+      else
+        quads.addQuad(x2,y2,x2+w,y2+h,t.u1,t.v1,t.u2,t.v2,t.t);
 
       x += (entry->advancedotx >> 6);
       // no change to y because we are not moving to next line yet
@@ -746,6 +923,9 @@ rtError pxFont::measureText(uint32_t pixelSize, rtString stringToMeasure, rtObje
 FontMap pxFontManager::mFontMap;
 FontIdMap pxFontManager::mFontIdMap;
 bool pxFontManager::init = false;
+#ifdef PXSCENE_FONT_ATLAS
+bool pxFontManager::mSDFEnabled = false;
+#endif
 void pxFontManager::initFT() 
 {
   if (init) 
@@ -754,6 +934,15 @@ void pxFontManager::initFT()
     return;
   }
   init = true;
+
+#ifdef PXSCENE_FONT_ATLAS
+  rtValue val;
+  if (RT_OK == rtSettings::instance()->value("enableSDFText", val))
+  {
+    mSDFEnabled = val.toString().compare("true") == 0;
+    rtLogInfo("sdf text %s", mSDFEnabled ? "enabled" : "disabled");
+  }
+#endif
   
   if(FT_Init_FreeType(&ft)) 
   {
@@ -828,6 +1017,23 @@ void pxFontManager::removeFont(uint32_t fontId)
   }
 }
 
+#ifdef PXSCENE_FONT_ATLAS
+bool pxFontManager::isSDFEnabled()
+{
+  return mSDFEnabled;
+}
+
+void pxFontManager::setSDFEnabled(bool enabled)
+{
+  mSDFEnabled = enabled;
+}
+#endif
+
+size_t pxFontManager::glyphTextureCount()
+{
+  return gGlyphTextureCache.size();
+}
+
 void pxFontManager::clearAllFonts()
 {
   for (GlyphCache::iterator it =  gGlyphCache.begin(); it != gGlyphCache.end(); it++)
@@ -954,7 +1160,10 @@ void pxTexturedQuads::draw(float x, float y, float* color)
       }
     }
 
-    context.drawTexturedQuads(q.verts.size()/12, &verts[0], &q.uvs[0], q.t, color);
+    if (q.sdfScale > 0)
+      context.drawSDFTexturedQuads(q.verts.size()/12, &verts[0], &q.uvs[0], q.t, color, q.sdfScale*PXSCENE_FONT_SDF_SPREAD);
+    else
+      context.drawTexturedQuads(q.verts.size()/12, &verts[0], &q.uvs[0], q.t, color);
   }
 }
 #endif
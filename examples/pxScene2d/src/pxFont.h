@@ -41,6 +41,14 @@ class pxFont;
 #define defaultPixelSize 16
 #define defaultFont "FreeSans.ttf"
 
+#ifdef PXSCENE_FONT_ATLAS
+// Signed distance field glyphs are rasterised once at this pixel size and
+// scaled in the shader for every other size/scale.  The spread is the
+// distance (in pixels at the SDF size) encoded on each side of the outline.
+#define PXSCENE_FONT_SDF_PIXEL_SIZE 48
+#define PXSCENE_FONT_SDF_SPREAD 6
+#endif
+
 class rtFileDownloadRequest;
 
 #if defined WIN32
@@ -63,7 +71,11 @@ struct GlyphTextureEntry
 {
   pxTextureRef t;
   float u1, v1, u2, v2;
-  GlyphTextureEntry(): u1(0),v1(0),u2(0),v2(0){}
+  // For SDF glyphs the quad extent (including the spread) is stored
+  // relative to the pen position at PXSCENE_FONT_SDF_PIXEL_SIZE
+  bool sdf;
+  float sdfLeft, sdfTop, sdfWidth, sdfHeight;
+  GlyphTextureEntry(): u1(0),v1(0),u2(0),v2(0),sdf(false),sdfLeft(0),sdfTop(0),sdfWidth(0),sdfHeight(0){}
 };
 
 #ifdef PXSCENE_FONT_ATLAS
@@ -102,19 +114,25 @@ class pxTexturedQuads
 
   struct quads
   {
+    quads(): sdfScale(0) {}
     vector<float> verts;
     vector<float> uvs;
     pxTextureRef t;
+    // 0 for coverage glyphs, otherwise the ratio between the text pixel size
+    // and the size the SDF glyphs were rasterised at
+    float sdfScale;
   };
 
   pxTexturedQuads() {}
 
-  void addQuad(float x1,float y1,float x2,float y2, float u1, float v1, float u2, float v2, pxTextureRef t)
+  void addQuad(float x1,float y1,float x2,float y2, float u1, float v1, float u2, float v2, pxTextureRef t, float sdfScale = 0)
   {
-    if (mQuads.empty() || mQuads[mQuads.size()-1].t != t || mQuads[mQuads.size()-1].verts.size() >= maxVectorSize)
+    if (mQuads.empty() || mQuads[mQuads.size()-1].t != t || mQuads[mQuads.size()-1].sdfScale != sdfScale ||
+        mQuads[mQuads.size()-1].verts.size() >= maxVectorSize)
     {
       quads q;
       q.t = t;
+      q.sdfScale = sdfScale;
       mQuads.push_back(q);
     }
 
@@ -264,6 +282,9 @@ public:
   void setPixelSize(uint32_t s);  
   const GlyphCacheEntry* getGlyph(uint32_t codePoint);
   GlyphTextureEntry getGlyphTexture(uint32_t codePoint, float sx, float sy);  
+#ifdef PXSCENE_FONT_ATLAS
+  GlyphTextureEntry getSDFGlyphTexture(uint32_t codePoint);
+#endif
   void getMetrics(uint32_t size, float& height, float& ascender, float& descender, float& naturalLeading);
   void getHeight(uint32_t size, float& height);
   void measureText(const char* text, uint32_t size, float& w, float& h);
@@ -327,12 +348,21 @@ class pxFontManager
     static rtRef<pxFont> getFont(const char* url, const char* proxy = NULL, const rtCORSRef& cors = NULL, rtObjectRef archive = NULL);
     static void removeFont(uint32_t fontId);
     static void clearAllFonts();
+#ifdef PXSCENE_FONT_ATLAS
+    // Opt-in signed distance field glyphs ("enableSDFText" setting)
+    static bool isSDFEnabled();
+    static void setSDFEnabled(bool enabled);
+#endif
+    static size_t glyphTextureCount();
     
   protected: 
     static void initFT();  
     static FontMap mFontMap;
     static FontIdMap mFontIdMap;
     static bool init;
+#ifdef PXSCENE_FONT_ATLAS
+    static bool mSDFEnabled;
+#endif
     
 };
 #endif
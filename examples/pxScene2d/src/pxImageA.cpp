@@ -77,6 +77,7 @@ rtError pxImageA::setUrl(const char *s)
     {
       mCurFrame = 0;
       mCachedFrame = UINT32_MAX;
+      mFrameCursor = NULL;
       mFrameTime = -1;
       mPlays = 0;
       mImageWidth = 0;
@@ -136,13 +137,32 @@ void pxImageA::update(double t)
       }
     }
 
-    if (mCachedFrame != mCurFrame)
+    if (mCachedFrame != mCurFrame && mFrameCursor.getPtr() != NULL)
     {
-      pxOffscreen &o = imageSequence.getFrameBuffer(mCurFrame);
-      mTexture = context.createTexture(o);
-      mCachedFrame = mCurFrame;
-      pxRect r(0, 0, mImageHeight, mImageWidth);
-      mScene->invalidateRect(&r);
+      // Frames are decoded ahead on a worker; one that isn't ready yet
+      // leaves the previous frame up until a later update
+      pxOffscreen *o = mFrameCursor->frame(mCurFrame);
+      if (o != NULL)
+      {
+        // Patch only what changed since the frame already in the texture
+        int32_t x, y, w, h;
+        bool updated = false;
+        if (mTexture.getPtr() != NULL && mCachedFrame != UINT32_MAX &&
+            imageSequence.dirtyRect(mCachedFrame, mCurFrame, x, y, w, h))
+        {
+          pxOffscreen region;
+          region.init(w, h);
+          o->blit(region, 0, 0, w, h, x, y);
+          updated = (mTexture->updateTexture(x, y, w, h, region.base()) == PX_OK);
+        }
+        if (!updated)
+        {
+          mTexture = context.createTexture(*o);
+        }
+        mCachedFrame = mCurFrame;
+        pxRect r(0, 0, mImageHeight, mImageWidth);
+        mScene->invalidateRect(&r);
+      }
     }
   }
 }
@@ -170,6 +190,7 @@ void pxImageA::dispose(bool pumpJavascript)
     mResource = NULL;
     mListenerAdded = false;
   }
+  mFrameCursor = NULL;
   pxObject::dispose(pumpJavascript);
 }
 
@@ -256,11 +277,13 @@ void pxImageA::loadImageSequence()
   if (getImageAResource() != NULL && getImageAResource()->getLoadStatus("statusCode") == 0)
   {
     pxTimedOffscreenSequence& imageSequence = getImageAResource()->getTimedOffscreenSequence();
+    mFrameCursor = NULL;
+    mCachedFrame = UINT32_MAX;
     if (imageSequence.numFrames() > 0)
     {
-      pxOffscreen &o = imageSequence.getFrameBuffer(0);
-      mImageWidth = o.width();
-      mImageHeight = o.height();
+      mFrameCursor = new pxTimedOffscreenCursor(imageSequence);
+      mImageWidth = imageSequence.width();
+      mImageHeight = imageSequence.height();
       mw = static_cast<float>(mImageWidth);
       mh = static_cast<float>(mImageHeight);
     }
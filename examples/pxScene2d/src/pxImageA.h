@@ -77,6 +77,8 @@ protected:
   uint32_t mImageHeight;
 
   pxTextureRef mTexture;
+  // This image's own position in the (possibly shared) frame sequence
+  rtRef<pxTimedOffscreenCursor> mFrameCursor;
 
   double mFrameTime;
   pxConstantsStretch::constants mStretchX;
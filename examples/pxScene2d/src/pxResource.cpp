@@ -28,6 +28,7 @@
 #include "pxUtil.h"
 #include "rtThreadPool.h"
 #include "rtPathUtils.h"
+#include "rtSettings.h"
 
 
 using namespace std;
@@ -281,7 +282,8 @@ void pxResource::raiseDownloadPriority()
 
 
 rtImageResource::rtImageResource()
-: pxResource(), mTexture(), mDownloadedTexture(), mTextureMutex(), mDownloadComplete(false), init_w(0), init_h(0), init_sx(0.0f), init_sy(0.0f), mData()
+: pxResource(), mTexture(), mDownloadedTexture(), mTextureMutex(), mDownloadComplete(false), init_w(0), init_h(0), init_sx(0.0f), init_sy(0.0f), mData(),
+  mStreamDecoder(NULL), mStreamOffscreen(), mStreamW(0), mStreamH(0), mStreamMutex()
 {
   // empty
 }
@@ -289,13 +291,20 @@ rtImageResource::rtImageResource()
 rtImageResource::rtImageResource(const char* url, const char* proxy, int32_t iw /* = 0 */,  int32_t ih /* = 0 */,
                                                                        float sx /* = 1.0f*/,  float sy /* = 1.0f*/ )
     : pxResource(), mTexture(), mDownloadedTexture(), mTextureMutex(), mDownloadComplete(false),
-      init_w(iw), init_h(ih), init_sx(sx), init_sy(sy), mData()
+      init_w(iw), init_h(ih), init_sx(sx), init_sy(sy), mData(),
+      mStreamDecoder(NULL), mStreamOffscreen(), mStreamW(0), mStreamH(0), mStreamMutex()
 {
   setUrl(url, proxy);
 }
 
 rtImageResource::~rtImageResource()
 {
+  if (mDownloadRequest != NULL)
+  {
+    // waits for a chunk being fed on the download thread and stops any more
+    rtFileDownloader::setDownloadSinkThreadSafe(mDownloadRequest, NULL, this);
+  }
+  releaseStreamDecoder();
   //rtLogDebug("destructor for rtImageResource for %s\n",mUrl.cString());
   //pxImageManager::removeImage( mUrl);
   if (mTexture.getPtr())
@@ -378,8 +387,8 @@ int32_t rtImageResource::w() const
   //rtLogDebug("tImageResource::w()\n");
   if(mTexture.getPtr())
     return mTexture->width();
-  else
-    return 0;
+  rtMutexLockGuard lock(mStreamMutex);
+  return mStreamW;
 }
 rtError rtImageResource::w(int32_t& v) const
 {
@@ -387,7 +396,10 @@ rtError rtImageResource::w(int32_t& v) const
   if(mTexture.getPtr())
     v = mTexture->width();
   else
-    v = 0;
+  {
+    rtMutexLockGuard lock(mStreamMutex);
+    v = mStreamW;
+  }
   return RT_OK;
 }
 int32_t rtImageResource::h() const
@@ -395,8 +407,8 @@ int32_t rtImageResource::h() const
   //rtLogDebug("tImageResource::h()\n");
   if(mTexture.getPtr())
     return mTexture->height();
-  else
-    return 0;
+  rtMutexLockGuard lock(mStreamMutex);
+  return mStreamH;
 }
 rtError rtImageResource::h(int32_t& v) const
 {
@@ -404,7 +416,10 @@ rtError rtImageResource::h(int32_t& v) const
   if(mTexture.getPtr())
     v = mTexture->height();
   else
-    v = 0;
+  {
+    rtMutexLockGuard lock(mStreamMutex);
+    v = mStreamH;
+  }
   return RT_OK;
 }
 
@@ -530,6 +545,7 @@ void pxResource::loadResource(rtObjectRef archive)
       mDownloadRequest = new rtFileDownloadRequest(mUrl, this, pxResource::onDownloadComplete);
       mDownloadRequest->setProxy(mProxy);
       mDownloadRequest->setCallbackFunctionThreadSafe(pxResource::onDownloadComplete);
+      mDownloadRequest->setDownloadSink(downloadSink());
 #ifdef ENABLE_CORS_FOR_RESOURCES
       mDownloadRequest->setCORS(mCORS);
 #endif
@@ -772,15 +788,146 @@ void pxResource::onDownloadComplete(rtFileDownloadRequest* fileDownloadRequest)
   }
 }
 
+static bool isStreamingImageDecodeEnabled()
+{
+  static int enabled = -1;
+  if (enabled < 0)
+  {
+    rtValue val;
+    enabled = (RT_OK == rtSettings::instance()->value("enableStreamingImageDecode", val) &&
+               val.toString().compare("true") == 0) ? 1 : 0;
+  }
+  return enabled == 1;
+}
+
+rtFileDownloadSink* rtImageResource::downloadSink()
+{
+  releaseStreamDecoder();
+  if (!isStreamingImageDecodeEnabled())
+  {
+    return NULL;
+  }
+  rtMutexLockGuard lock(mStreamMutex);
+  mStreamDecoder = new pxImageStreamDecoder(mStreamOffscreen, init_w, init_h);
+  return this;
+}
+
+void rtImageResource::releaseStreamDecoder()
+{
+  rtMutexLockGuard lock(mStreamMutex);
+  delete mStreamDecoder;
+  mStreamDecoder = NULL;
+  mStreamOffscreen.term();
+  mStreamW = 0;
+  mStreamH = 0;
+}
+
+// Called on the download thread as data arrives
+void rtImageResource::onDownloadData(rtFileDownloadRequest* /*downloadRequest*/, const char* data, size_t size)
+{
+  rtMutexLockGuard lock(mStreamMutex);
+  if (mStreamDecoder == NULL || mStreamDecoder->failed())
+  {
+    return;
+  }
+
+  bool hadDimensions = mStreamDecoder->hasDimensions();
+  mStreamDecoder->feed(data, size);
+
+  if (!hadDimensions && mStreamDecoder->hasDimensions())
+  {
+    // Report the size ahead of the pixels so layout doesn't wait for the decode
+    mStreamW = mStreamDecoder->width();
+    mStreamH = mStreamDecoder->height();
+    if (gUIThreadQueue)
+    {
+      AddRef();
+      gUIThreadQueue->addTask(pxResource::onResourceDirtyUI, this, NULL);
+    }
+  }
+}
+
+void rtImageResource::processDownloadedResource(rtFileDownloadRequest* fileDownloadRequest)
+{
+  pxResource::processDownloadedResource(fileDownloadRequest);
+  releaseStreamDecoder();
+}
+
+#ifdef ENABLE_HTTP_CACHE
+static bool isPixelCacheEnabled()
+{
+  static int enabled = -1;
+  if (enabled < 0)
+  {
+    rtValue val;
+    enabled = (RT_OK == rtSettings::instance()->value("enablePixelCache", val) &&
+               val.toString().compare("true") == 0) ? 1 : 0;
+  }
+  return enabled == 1;
+}
+
+// Key for the decoded pixels of a response; empty if the server sent no validator
+static rtString pixelCacheKey(rtFileDownloadRequest* fileDownloadRequest, int32_t w, int32_t h, float sx, float sy)
+{
+  if (!isPixelCacheEnabled() || fileDownloadRequest->headerData() == NULL)
+  {
+    return rtString();
+  }
+
+  rtHttpCacheData cacheData(fileDownloadRequest->fileUrl().cString());
+  cacheData.setAttributes(fileDownloadRequest->headerData());
+
+  rtString validator;
+  if (cacheData.etag(validator) != RT_OK)
+  {
+    map<rtString, rtString> attributes;
+    cacheData.attributes(attributes);
+    map<rtString, rtString>::iterator it = attributes.find("Last-Modified");
+    if (it != attributes.end())
+    {
+      validator = it->second;
+    }
+  }
+  return rtPixelCache::cacheKey(fileDownloadRequest->fileUrl().cString(), validator.cString(), w, h, sx, sy);
+}
+#endif //ENABLE_HTTP_CACHE
+
 uint32_t rtImageResource::loadResourceData(rtFileDownloadRequest* fileDownloadRequest)
 {
       pxOffscreen imageOffscreen;
-      if (pxLoadImage(fileDownloadRequest->downloadedData(),
-                      fileDownloadRequest->downloadedDataSize(),
-                      imageOffscreen, init_w, init_h, init_sx, init_sy) == RT_OK)
+      // Streams that couldn't be decoded incrementally fall back to the full buffer
+      mStreamMutex.lock();
+      bool streamDecoded = (mStreamDecoder != NULL && mStreamDecoder->isComplete());
+      if (streamDecoded)
+      {
+        imageOffscreen = mStreamOffscreen;
+        imageOffscreen.setPremultiplied(mStreamOffscreen.premultiplied());
+      }
+      mStreamMutex.unlock();
+      bool decoded = streamDecoded;
+#ifdef ENABLE_HTTP_CACHE
+      rtString pixelKey = pixelCacheKey(fileDownloadRequest, init_w, init_h, init_sx, init_sy);
+      bool cachedPixels = !decoded && !pixelKey.isEmpty() &&
+                          rtPixelCache::instance()->pixels(pixelKey, imageOffscreen) == RT_OK;
+      decoded = decoded || cachedPixels;
+#endif //ENABLE_HTTP_CACHE
+      if (!decoded)
       {
-        setTextureData(imageOffscreen, fileDownloadRequest->downloadedData(),
-                                         fileDownloadRequest->downloadedDataSize());
+        decoded = pxLoadImage(fileDownloadRequest->downloadedData(),
+                              fileDownloadRequest->downloadedDataSize(),
+                              imageOffscreen, init_w, init_h, init_sx, init_sy) == RT_OK;
+      }
+      if (decoded)
+      {
+#ifdef ENABLE_HTTP_CACHE
+        if (!cachedPixels && !pixelKey.isEmpty())
+        {
+          rtPixelCache::instance()->addToCache(pixelKey, imageOffscreen);
+        }
+#endif //ENABLE_HTTP_CACHE
+        setTextureData(imageOffscreen,
+                       fileDownloadRequest->downloadedData(),
+                       fileDownloadRequest->downloadedDataSize());
 #ifdef ENABLE_BACKGROUND_TEXTURE_CREATION
         return PX_RESOURCE_LOAD_WAIT;
 #else
@@ -1001,7 +1148,7 @@ rtRef<rtImageResource> pxImageManager::getImage(const char* url, const char* pro
     svgUrl += "sx" + xx.toString() + "sy" + yy.toString();
   }
 
-  // For SVG  (and scaled PNG/JPG in the future) at a given WxH DIMENSIONS ... append to key
+  // For SVG (and PNG/JPG reduced at decode time) at a given WxH DIMENSIONS ... append to key
   if(iw > 0 || ih > 0)
   {
     rtValue ww = iw;
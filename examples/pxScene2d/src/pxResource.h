@@ -36,8 +36,8 @@
 #include "rtFileCache.h"
 #endif
 #include "rtCORS.h"
+#include "rtFileDownloader.h"
 #include <map>
-class rtFileDownloadRequest;
 
 #define PX_RESOURCE_STATUS_OK             0
 #define PX_RESOURCE_STATUS_DOWNLOADING    1
@@ -120,6 +120,7 @@ protected:
   static void onResourceDirtyUI(void* context, void* data);
   virtual void processDownloadedResource(rtFileDownloadRequest* fileDownloadRequest);
   virtual uint32_t loadResourceData(rtFileDownloadRequest* fileDownloadRequest) = 0;
+  virtual rtFileDownloadSink* downloadSink() { return NULL; }
   
   void notifyListeners(rtString readyResolution);
   void notifyListenersResourceDirty();
@@ -144,7 +145,7 @@ protected:
   rtString mName;
 };
 
-class rtImageResource : public pxResource, public pxTextureListener
+class rtImageResource : public pxResource, public pxTextureListener, public rtFileDownloadSink
 {
 public:
   rtImageResource();
@@ -187,14 +188,18 @@ public:
   virtual void reloadData();
   virtual uint64_t textureMemoryUsage();
   virtual void textureReady();
+  virtual void onDownloadData(rtFileDownloadRequest* downloadRequest, const char* data, size_t size);
   
 protected:
+  virtual void processDownloadedResource(rtFileDownloadRequest* fileDownloadRequest);
   virtual uint32_t loadResourceData(rtFileDownloadRequest* fileDownloadRequest);
+  virtual rtFileDownloadSink* downloadSink();
 
 private:
 
   void loadResourceFromFile();
   void loadResourceFromArchive(rtObjectRef archiveRef);
+  void releaseStreamDecoder();
 
   pxTextureRef mTexture;
   pxTextureRef mDownloadedTexture;
@@ -206,6 +211,13 @@ private:
   float     init_sx, init_sy;
 
   rtData    mData;
+
+  // Decodes http downloads as they arrive (enableStreamingImageDecode).
+  // Fed on the download thread; all of it is guarded by mStreamMutex.
+  pxImageStreamDecoder* mStreamDecoder;
+  pxOffscreen           mStreamOffscreen;
+  int32_t               mStreamW, mStreamH;
+  mutable rtMutex       mStreamMutex;
 };
 
 class rtImageAResource : public pxResource
@@ -60,6 +60,8 @@
 #include "pxContext.h"
 #include "rtFileDownloader.h"
 #include "rtMutex.h"
+#include "rtPool.h"
+#include "rtThreadPool.h"
 
 #include "pxIView.h"
 
@@ -69,6 +71,9 @@
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
+#include <string>
+#include <unordered_map>
+
 #ifdef ENABLE_RT_NODE
 #include "rtScript.h"
 #endif //ENABLE_RT_NODE
@@ -442,20 +447,34 @@ pxObject::pxObject(pxScene2d* scene): rtObject(), mParent(NULL), mpx(0), mpy(0),
     mrx(0), mry(0), mrz(1.0),
 #endif //ANIMATION_ROTATE_XYZ
     msx(1), msy(1), mw(0), mh(0),
-    mInteractive(true),
-    mSnapshotRef(), mPainting(true), mClip(false), mMask(false), mDraw(true), mHitTest(true), mReady(),
-    mFocus(false),mClipSnapshotRef(),mCancelInSet(true),mUseMatrix(false), mRepaint(true)
+    mMatrix(), mInteractive(true), mPainting(true), mClip(false), mMask(false), mDraw(true), mHitTest(true),
+    mFocus(false), mCancelInSet(true), mUseMatrix(false), mRepaint(true), mIsDisposed(false), mSceneSuspended(false)
 #ifdef PX_DIRTY_RECTANGLES
     , mIsDirty(true), mRenderMatrix(), mScreenCoordinates(), mDirtyRect()
 #endif //PX_DIRTY_RECTANGLES
-    ,mDrawableSnapshotForMask(), mMaskSnapshot(), mIsDisposed(false), mSceneSuspended(false)
+    , mScene(scene), mSceneIndex(-1), mReady(), mExtra(NULL)
   {
     pxObjectCount++;
-    mScene = scene;
     mReady = new rtPromise;
     mEmit = new rtEmit;
   }
 
+static rtSizedPool* pxObjectPool()
+{
+  static rtSizedPool* pool = new rtSizedPool("pxObject", 2048);
+  return pool;
+}
+
+void* pxObject::operator new(size_t size)
+{
+  return pxObjectPool()->alloc(size);
+}
+
+void pxObject::operator delete(void* p, size_t size)
+{
+  pxObjectPool()->free(p, size);
+}
+
 pxObject::~pxObject()
 {
 //    rtString d;
@@ -468,14 +487,8 @@ pxObject::~pxObject()
     }
     mChildren.clear();
     pxObjectCount--;
-    clearSnapshot(mSnapshotRef);
-    clearSnapshot(mClipSnapshotRef);
-    clearSnapshot(mDrawableSnapshotForMask);
-    clearSnapshot(mMaskSnapshot);
-    mSnapshotRef = NULL;
-    mClipSnapshotRef = NULL;
-    mDrawableSnapshotForMask = NULL;
-    mMaskSnapshot = NULL;
+    clearSnapshots();
+    delete mExtra;
 }
 
 void pxObject::sendPromise()
@@ -504,18 +517,22 @@ void pxObject::dispose(bool pumpJavascript)
     //rtLogInfo(__FUNCTION__);
     mIsDisposed = true;
     rtValue nullValue;
-    vector<animation>::iterator it = mAnimations.begin();
-    for(;it != mAnimations.end();it++)
+    if (mExtra)
     {
-      if ((*it).promise)
+      vector<animation>::iterator it = mExtra->mAnimations.begin();
+      for(;it != mExtra->mAnimations.end();it++)
       {
-	  (*it).promise.send("reject",nullValue);
+        if ((*it).promise)
+        {
+	    (*it).promise.send("reject",nullValue);
+        }
       }
     }
 
     mReady.send("reject",nullValue);
 
-    mAnimations.clear();
+    if (mExtra)
+      mExtra->mAnimations.clear();
     mEmit->clearListeners();
     for(vector<rtRef<pxObject> >::iterator it = mChildren.begin(); it != mChildren.end(); ++it)
     {
@@ -523,14 +540,7 @@ void pxObject::dispose(bool pumpJavascript)
       (*it)->dispose(false);
     }
     mChildren.clear();
-    clearSnapshot(mSnapshotRef);
-    clearSnapshot(mClipSnapshotRef);
-    clearSnapshot(mDrawableSnapshotForMask);
-    clearSnapshot(mMaskSnapshot);
-    mSnapshotRef = NULL;
-    mClipSnapshotRef = NULL;
-    mDrawableSnapshotForMask = NULL;
-    mMaskSnapshot = NULL;
+    clearSnapshots();
     if (mScene)
     {
       mScene->innerpxObjectDisposed(this);
@@ -722,6 +732,14 @@ rtError pxObject::removeAll()
   return RT_OK;
 }
 
+rtError pxObject::setProps(rtObjectRef props)
+{
+  if (!props)
+    return RT_ERROR_INVALID_ARG;
+  set(props);
+  return RT_OK;
+}
+
 rtError pxObject::moveToFront()
 {
   pxObject* parent = this->parent();
@@ -855,15 +873,16 @@ rtError pxObject::animateTo(const char* prop, double to, double duration,
 // the set* method anyway.
 void pxObject::cancelAnimation(const char* prop, bool fastforward, bool rewind)
 {
-  if (!mCancelInSet)
+  if (!mCancelInSet || !mExtra)
     return;
   bool f = mCancelInSet;
   // Do not reenter
   mCancelInSet = false;
 
   // If an animation for this property is in progress we cancel it here
-  vector<animation>::iterator it = mAnimations.begin();
-  while (it != mAnimations.end())
+  vector<animation>& animations = mExtra->mAnimations;
+  vector<animation>::iterator it = animations.begin();
+  while (it != animations.end())
   {
     animation& a = (*it);
     if (!a.cancelled && a.prop == prop)
@@ -938,7 +957,7 @@ void pxObject::animateToInternal(const char* prop, double to, double duration,
   a.promise = promise;
   a.animateObj = animateObj;
 
-  mAnimations.push_back(a);
+  extra().mAnimations.push_back(a);
 
   pxAnimate *animObj = (pxAnimate *)a.animateObj.getPtr();
 
@@ -965,146 +984,150 @@ void pxObject::update(double t)
 #endif
 
   // Update animations
-  vector<animation>::iterator it = mAnimations.begin();
-
-  while (it != mAnimations.end())
+  if (mExtra)
   {
-    animation& a = (*it);
+    vector<animation>& animations = mExtra->mAnimations;
+    vector<animation>::iterator it = animations.begin();
 
-    pxAnimate *animObj = (pxAnimate *)a.animateObj.getPtr();
+    while (it != animations.end())
+    {
+      animation& a = (*it);
 
-    if (a.start < 0) a.start = t;
-    double end = a.start + a.duration;
+      pxAnimate *animObj = (pxAnimate *)a.animateObj.getPtr();
 
-    // if duration has elapsed, increment the count for this animation
-    if( t >=end && a.count != pxConstantsAnimation::COUNT_FOREVER
-        && !(a.options & pxConstantsAnimation::OPTION_OSCILLATE))
-    {
-        a.actualCount++;
-        a.start  = -1;
-    }
-    // if duration has elapsed and count is met, end the animation
-    if (t >= end && a.count != pxConstantsAnimation::COUNT_FOREVER && a.actualCount >= a.count)
-    {
-      // TODO this sort of blows since this triggers another
-      // animation traversal to cancel animations
+      if (a.start < 0) a.start = t;
+      double end = a.start + a.duration;
+
+      // if duration has elapsed, increment the count for this animation
+      if( t >=end && a.count != pxConstantsAnimation::COUNT_FOREVER
+          && !(a.options & pxConstantsAnimation::OPTION_OSCILLATE))
+      {
+          a.actualCount++;
+          a.start  = -1;
+      }
+      // if duration has elapsed and count is met, end the animation
+      if (t >= end && a.count != pxConstantsAnimation::COUNT_FOREVER && a.actualCount >= a.count)
+      {
+        // TODO this sort of blows since this triggers another
+        // animation traversal to cancel animations
 #if 0
-      cancelAnimation(a.prop, true, false);
+        cancelAnimation(a.prop, true, false);
 #else
-      assert(mCancelInSet);
-      mCancelInSet = false;
-      set(a.prop, a.to);
-      mCancelInSet = true;
+        assert(mCancelInSet);
+        mCancelInSet = false;
+        set(a.prop, a.to);
+        mCancelInSet = true;
 
-      if (a.count != pxConstantsAnimation::COUNT_FOREVER && a.actualCount >= a.count )
-      {
-        if (a.ended)
-          a.ended.send(this);
-        if (a.promise)
+        if (a.count != pxConstantsAnimation::COUNT_FOREVER && a.actualCount >= a.count )
         {
-          a.promise.send("resolve",this);
+          if (a.ended)
+            a.ended.send(this);
+          if (a.promise)
+          {
+            a.promise.send("resolve",this);
+            if (NULL != animObj)
+            {
+              animObj->setStatus(pxConstantsAnimation::STATUS_ENDED);
+            }
+          }
+          // Erase making sure to push the iterator forward before
+          a.cancelled = true;
           if (NULL != animObj)
           {
-            animObj->setStatus(pxConstantsAnimation::STATUS_ENDED);
+            animObj->update(a.prop, &a, pxConstantsAnimation::STATUS_ENDED);
           }
+          it = animations.erase(it);
+          continue;
         }
-        // Erase making sure to push the iterator forward before
-        a.cancelled = true;
-        if (NULL != animObj)
-        {
-          animObj->update(a.prop, &a, pxConstantsAnimation::STATUS_ENDED);
-        }
-        it = mAnimations.erase(it);
-        continue;
-      }
 #endif
 
-    }
+      }
 
-    if (a.cancelled)
-    {
-      if (NULL != animObj)
+      if (a.cancelled)
       {
-        animObj->update(a.prop, &a, pxConstantsAnimation::STATUS_CANCELLED);
-      }
+        if (NULL != animObj)
+        {
+          animObj->update(a.prop, &a, pxConstantsAnimation::STATUS_CANCELLED);
+        }
 
-      it = mAnimations.erase(it);  // returns next element
-      continue;
-    }
+        it = animations.erase(it);  // returns next element
+        continue;
+      }
 
-    double t1 = (t-a.start)/a.duration; // Some of this could be pushed into the end handling
-    double t2 = floor(t1);
-    t1 = t1-t2; // 0-1
+      double t1 = (t-a.start)/a.duration; // Some of this could be pushed into the end handling
+      double t2 = floor(t1);
+      t1 = t1-t2; // 0-1
 
-    double d = a.interpFunc(t1);
-    float from = a.from;
-    float   to = a.to;
+      double d = a.interpFunc(t1);
+      float from = a.from;
+      float   to = a.to;
 
-    if (a.options & pxConstantsAnimation::OPTION_OSCILLATE)
-    {
-      bool justReverseChange = false;
-      double toVal = a.to;
-      if( (fmod(t2,2) != 0))  // TODO perf chk ?
+      if (a.options & pxConstantsAnimation::OPTION_OSCILLATE)
       {
-        if(!a.reversing)
+        bool justReverseChange = false;
+        double toVal = a.to;
+        if( (fmod(t2,2) != 0))  // TODO perf chk ?
         {
-          a.reversing = true;
+          if(!a.reversing)
+          {
+            a.reversing = true;
+            justReverseChange = true;
+            a.actualCount++;
+          }
+          from = a.to;
+          to   = a.from;
+        }
+        else if( a.reversing && (fmod(t2,2) == 0))
+        {
+          toVal = a.from;
           justReverseChange = true;
+          a.reversing = false;
           a.actualCount++;
+          a.start = -1;
         }
-        from = a.to;
-        to   = a.from;
-      }
-      else if( a.reversing && (fmod(t2,2) == 0))
-      {
-        toVal = a.from;
-        justReverseChange = true;
-        a.reversing = false;
-        a.actualCount++;
-        a.start = -1;
-      }
-      // Prevent one more loop through oscillate
-      if(a.count != pxConstantsAnimation::COUNT_FOREVER && a.actualCount >= a.count )
-      {
-          // if(a.actualCount == a.count)
-          // {
-          //   justReverseChange = false;
-          // }
+        // Prevent one more loop through oscillate
+        if(a.count != pxConstantsAnimation::COUNT_FOREVER && a.actualCount >= a.count )
+        {
+            // if(a.actualCount == a.count)
+            // {
+            //   justReverseChange = false;
+            // }
+
+            if (true == justReverseChange)
+            {
+              mCancelInSet = false;
+              set(a.prop, toVal);
+              mCancelInSet = true;
+            }
 
-          if (true == justReverseChange)
+          if (NULL != animObj)
           {
-            mCancelInSet = false;
-            set(a.prop, toVal);
-            mCancelInSet = true;
+            animObj->setStatus(pxConstantsAnimation::STATUS_ENDED);
           }
+          cancelAnimation(a.prop, false, false);
 
-        if (NULL != animObj)
-        {
-          animObj->setStatus(pxConstantsAnimation::STATUS_ENDED);
-        }
-        cancelAnimation(a.prop, false, false);
+          if (NULL != animObj)
+          {
+            animObj->update(a.prop, &a, pxConstantsAnimation::STATUS_ENDED);
+          }
 
-        if (NULL != animObj)
-        {
-          animObj->update(a.prop, &a, pxConstantsAnimation::STATUS_ENDED);
+          it = animations.erase(it);
+          continue;
         }
 
-        it = mAnimations.erase(it);
-        continue;
       }
 
+      float v = static_cast<float> (from + (to - from) * d);
+      assert(mCancelInSet);
+      mCancelInSet = false;
+      set(a.prop, v);
+      mCancelInSet = true;
+      if (NULL != animObj)
+      {
+        animObj->update(a.prop, &a, pxConstantsAnimation::STATUS_INPROGRESS);
+      }
+      ++it;
     }
-
-    float v = static_cast<float> (from + (to - from) * d);
-    assert(mCancelInSet);
-    mCancelInSet = false;
-    set(a.prop, v);
-    mCancelInSet = true;
-    if (NULL != animObj)
-    {
-      animObj->update(a.prop, &a, pxConstantsAnimation::STATUS_INPROGRESS);
-    }
-    ++it;
   }
 
 #ifdef PX_DIRTY_RECTANGLES
@@ -1152,10 +1175,8 @@ void pxObject::update(double t)
       }
       context.pushState();
 #endif //PX_DIRTY_RECTANGLES
-// JR TODO  this lock looks suspicious... why do we need it?
-ENTERSCENELOCK()
+    // the frame already holds the scene lock (see pxScene2d::onUpdate)
     (*it)->update(t);
-EXITSCENELOCK()
 #ifdef PX_DIRTY_RECTANGLES
       context.popState();
 #endif //PX_DIRTY_RECTANGLES
@@ -1172,9 +1193,12 @@ EXITSCENELOCK()
 
 void pxObject::releaseData(bool sceneSuspended)
 {
-  clearSnapshot(mClipSnapshotRef);
-  clearSnapshot(mDrawableSnapshotForMask);
-  clearSnapshot(mMaskSnapshot);
+  if (mExtra)
+  {
+    clearSnapshot(mExtra->mClipSnapshotRef);
+    clearSnapshot(mExtra->mDrawableSnapshotForMask);
+    clearSnapshot(mExtra->mMaskSnapshot);
+  }
   mSceneSuspended = sceneSuspended;
   // Recursively suspend the children
   for(vector<rtRef<pxObject> >::iterator it = mChildren.begin(); it != mChildren.end(); ++it)
@@ -1197,21 +1221,17 @@ void pxObject::reloadData(bool sceneSuspended)
 uint64_t pxObject::textureMemoryUsage()
 {
   uint64_t textureMemory = 0;
-  if (mClipSnapshotRef.getPtr() != NULL)
-  {
-    textureMemory += (mClipSnapshotRef->width() * mClipSnapshotRef->height() * 4);
-  }
-  if (mDrawableSnapshotForMask.getPtr() != NULL)
+  if (mExtra)
   {
-    textureMemory += (mDrawableSnapshotForMask->width() * mDrawableSnapshotForMask->height() * 4);
-  }
-  if (mSnapshotRef.getPtr() != NULL)
-  {
-    textureMemory += (mSnapshotRef->width() * mSnapshotRef->height() * 4);
-  }
-  if (mMaskSnapshot.getPtr() != NULL)
-  {
-    textureMemory += (mMaskSnapshot->width() * mMaskSnapshot->height() * 4);
+    pxContextFramebufferRef snapshots[] = { mExtra->mClipSnapshotRef, mExtra->mDrawableSnapshotForMask,
+                                            mExtra->mSnapshotRef, mExtra->mMaskSnapshot };
+    for (size_t i = 0; i < sizeof(snapshots)/sizeof(snapshots[0]); i++)
+    {
+      if (snapshots[i].getPtr() != NULL)
+      {
+        textureMemory += (snapshots[i]->width() * snapshots[i]->height() * 4);
+      }
+    }
   }
 
   for(vector<rtRef<pxObject> >::iterator it = mChildren.begin(); it != mChildren.end(); ++it)
@@ -1382,7 +1402,7 @@ void pxObject::drawInternal(bool maskPass)
 
 #if 0
 
-  rtLogDebug("drawInternal: %s\n", mId.cString());
+  rtLogDebug("drawInternal: %s\n", id().cString());
   m.dump();
 
   pxVector4f v1(mx+w, my, 0, 1);
@@ -1458,7 +1478,7 @@ void pxObject::drawInternal(bool maskPass)
       context.setMatrix(m);
       //rtLogInfo("context.drawImage\n");
 
-      context.drawImageMasked(0, 0, w, h, maskOp, mDrawableSnapshotForMask->getTexture(), mMaskSnapshot->getTexture());
+      context.drawImageMasked(0, 0, w, h, maskOp, mExtra->mDrawableSnapshotForMask->getTexture(), mExtra->mMaskSnapshot->getTexture());
     }
     // CLIPPING ? ---------------------------------------------------------------------------------------------------
     else if (mClip)
@@ -1466,16 +1486,16 @@ void pxObject::drawInternal(bool maskPass)
       //rtLogInfo("calling createSnapshot for mw=%f mh=%f\n", mw, mh);
       if (mRepaint)
       {
-        createSnapshot(mClipSnapshotRef);
+        createSnapshot(extra().mClipSnapshotRef);
         context.setMatrix(m);
         context.setAlpha(ma);
       }
 
-      if (mClipSnapshotRef.getPtr() != NULL)
+      if (mExtra && mExtra->mClipSnapshotRef.getPtr() != NULL)
       {
         //rtLogInfo("context.drawImage\n");
         static pxTextureRef nullMaskRef;
-        context.drawImage(0, 0, w, h, mClipSnapshotRef->getTexture(), nullMaskRef);
+        context.drawImage(0, 0, w, h, mExtra->mClipSnapshotRef->getTexture(), nullMaskRef);
       }
     }
     // DRAWING ---------------------------------------------------------------------------------------------------
@@ -1529,7 +1549,7 @@ void pxObject::drawInternal(bool maskPass)
   {
     //rtLogInfo("context.drawImage mw=%f mh=%f\n", mw, mh);
     static pxTextureRef nullMaskRef;
-    context.drawImage(0,0,w,h, mSnapshotRef->getTexture(), nullMaskRef);
+    context.drawImage(0,0,w,h, extra().mSnapshotRef->getTexture(), nullMaskRef);
   }
 
   // ---------------------------------------------------------------------------------------------------
@@ -1608,14 +1628,14 @@ rtError pxObject::setPainting(bool v)
   {
     //rtLogInfo("in setPainting and calling createSnapshot mw=%f mh=%f\n", mw, mh);
 #ifdef RUNINMAIN
-    createSnapshot(mSnapshotRef, false, true);
+    createSnapshot(extra().mSnapshotRef, false, true);
 #else
-    createSnapshot(mSnapshotRef, true, true);
+    createSnapshot(extra().mSnapshotRef, true, true);
 #endif //RUNINMAIN
   }
-  else
+  else if (mExtra)
   {
-    clearSnapshot(mSnapshotRef);
+    clearSnapshot(mExtra->mSnapshotRef);
   }
   return RT_OK;
 }
@@ -1714,26 +1734,28 @@ void pxObject::createSnapshotOfChildren()
 
   //rtLogInfo("createSnapshotOfChildren  w=%f h=%f\n", w, h);
 
-  if (mDrawableSnapshotForMask.getPtr() == NULL || mDrawableSnapshotForMask->width() != floor(w) || mDrawableSnapshotForMask->height() != floor(h))
+  pxObjectExtra& x = extra();
+
+  if (x.mDrawableSnapshotForMask.getPtr() == NULL || x.mDrawableSnapshotForMask->width() != floor(w) || x.mDrawableSnapshotForMask->height() != floor(h))
   {
-    mDrawableSnapshotForMask = context.createFramebuffer(static_cast<int>(floor(w)), static_cast<int>(floor(h)));
+    x.mDrawableSnapshotForMask = context.createFramebuffer(static_cast<int>(floor(w)), static_cast<int>(floor(h)));
   }
   else
   {
-    context.updateFramebuffer(mDrawableSnapshotForMask, static_cast<int>(floor(w)), static_cast<int>(floor(h)));
+    context.updateFramebuffer(x.mDrawableSnapshotForMask, static_cast<int>(floor(w)), static_cast<int>(floor(h)));
   }
 
-  if (mMaskSnapshot.getPtr() == NULL || mMaskSnapshot->width() != floor(w) || mMaskSnapshot->height() != floor(h))
+  if (x.mMaskSnapshot.getPtr() == NULL || x.mMaskSnapshot->width() != floor(w) || x.mMaskSnapshot->height() != floor(h))
   {
-    mMaskSnapshot = context.createFramebuffer(static_cast<int>(floor(w)), static_cast<int>(floor(h)), false, true);
+    x.mMaskSnapshot = context.createFramebuffer(static_cast<int>(floor(w)), static_cast<int>(floor(h)), false, true);
   }
   else
   {
-    context.updateFramebuffer(mMaskSnapshot, static_cast<int>(floor(w)), static_cast<int>(floor(h)));
+    context.updateFramebuffer(x.mMaskSnapshot, static_cast<int>(floor(w)), static_cast<int>(floor(h)));
   }
 
   pxContextFramebufferRef previousRenderSurface = context.getCurrentFramebuffer();
-  if (context.setFramebuffer(mMaskSnapshot) == PX_OK)
+  if (context.setFramebuffer(x.mMaskSnapshot) == PX_OK)
   {
     context.clear(static_cast<int>(w), static_cast<int>(h));
 
@@ -1748,7 +1770,7 @@ void pxObject::createSnapshotOfChildren()
     }
   }
 
-  if (context.setFramebuffer(mDrawableSnapshotForMask) == PX_OK)
+  if (context.setFramebuffer(x.mDrawableSnapshotForMask) == PX_OK)
   {
     context.clear(static_cast<int>(w), static_cast<int>(h));
 
@@ -1774,6 +1796,21 @@ void pxObject::clearSnapshot(pxContextFramebufferRef fbo)
   }
 }
 
+void pxObject::clearSnapshots()
+{
+  if (mExtra)
+  {
+    clearSnapshot(mExtra->mSnapshotRef);
+    clearSnapshot(mExtra->mClipSnapshotRef);
+    clearSnapshot(mExtra->mDrawableSnapshotForMask);
+    clearSnapshot(mExtra->mMaskSnapshot);
+    mExtra->mSnapshotRef = NULL;
+    mExtra->mClipSnapshotRef = NULL;
+    mExtra->mDrawableSnapshotForMask = NULL;
+    mExtra->mMaskSnapshot = NULL;
+  }
+}
+
 
 
 bool pxObject::onTextureReady()
@@ -1846,6 +1883,7 @@ rtDefineMethod(pxObject, moveToBack);
 rtDefineMethod(pxObject, moveForward);
 rtDefineMethod(pxObject, moveBackward);
 rtDefineMethod(pxObject, releaseResources);
+rtDefineMethod(pxObject, setProps);
 //rtDefineMethod(pxObject, animateTo);
 #if 0
 //TODO - remove
@@ -2027,8 +2065,9 @@ rtError pxScene2d::dispose()
     mEmit.send("onClose", e);
     for (unsigned int i=0; i<mInnerpxObjects.size(); i++)
     {
-      pxObject* temp = (pxObject *) (mInnerpxObjects[i].getPtr());
-      if ((NULL != temp) && (NULL == temp->parent()))
+      pxObject* temp = mInnerpxObjects[i].getPtr();
+      temp->mSceneIndex = -1;
+      if (NULL == temp->parent())
       {
         temp->dispose(false);
       }
@@ -2072,6 +2111,66 @@ void pxScene2d::init()
 }
 #endif
 
+// scene.create types, looked up by the "t" property
+struct pxSceneType
+{
+  pxScene2d::createFunction create;
+  bool tracked;
+};
+typedef std::unordered_map<std::string, pxSceneType> pxSceneTypeMap;
+
+template <rtError (pxScene2d::*F)(rtObjectRef, rtObjectRef&)>
+static rtError createBuiltin(pxScene2d* scene, rtObjectRef p, rtObjectRef& o)
+{
+  return (scene->*F)(p, o);
+}
+
+static pxSceneTypeMap* builtinSceneTypes()
+{
+  pxSceneTypeMap* types = new pxSceneTypeMap;
+  pxSceneTypeMap& m = *types;
+  m["rect"] = { &createBuiltin<&pxScene2d::createRectangle>, true };
+  m["text"] = { &createBuiltin<&pxScene2d::createText>, true };
+  m["textBox"] = { &createBuiltin<&pxScene2d::createTextBox>, true };
+  m["image"] = { &createBuiltin<&pxScene2d::createImage>, true };
+#ifdef BUILD_WITH_PXPATH
+  m["path"] = { &createBuiltin<&pxScene2d::createPath>, true };
+#endif // BUILD_WITH_PXPATH
+  m["image9"] = { &createBuiltin<&pxScene2d::createImage9>, true };
+  m["imageA"] = { &createBuiltin<&pxScene2d::createImageA>, true };
+  m["image9Border"] = { &createBuiltin<&pxScene2d::createImage9Border>, true };
+  m["imageResource"] = { &createBuiltin<&pxScene2d::createImageResource>, false };
+  m["imageAResource"] = { &createBuiltin<&pxScene2d::createImageAResource>, false };
+  m["fontResource"] = { &createBuiltin<&pxScene2d::createFontResource>, false };
+  m["scene"] = { &createBuiltin<&pxScene2d::createScene>, true };
+  m["external"] = { &createBuiltin<&pxScene2d::createExternal>, true };
+  m["wayland"] = { &createBuiltin<&pxScene2d::createWayland>, true };
+  m["object"] = { &createBuiltin<&pxScene2d::createObject>, true };
+  return types;
+}
+
+static pxSceneTypeMap& sceneTypes()
+{
+  static pxSceneTypeMap* types = builtinSceneTypes();
+  return *types;
+}
+
+void pxScene2d::registerType(const char* t, createFunction f, bool tracked)
+{
+  if (!t || !f)
+    return;
+  pxSceneType& type = sceneTypes()[t];
+  type.create = f;
+  type.tracked = tracked;
+}
+
+void pxScene2d::unregisterType(const char* t)
+{
+  if (!t)
+    return;
+  sceneTypes().erase(t);
+}
+
 rtError pxScene2d::create(rtObjectRef p, rtObjectRef& o)
 {
   if (mDisposed)
@@ -2082,54 +2181,16 @@ rtError pxScene2d::create(rtObjectRef p, rtObjectRef& o)
 
   rtError e = RT_OK;
   rtString t = p.get<rtString>("t");
-  bool needpxObjectTracking = true;
-
-  if (!strcmp("rect",t.cString()))
-    e = createRectangle(p,o);
-  else if (!strcmp("text",t.cString()))
-    e = createText(p,o);
-  else if (!strcmp("textBox",t.cString()))
-    e = createTextBox(p,o);
-  else if (!strcmp("image",t.cString()))
-    e = createImage(p,o);
-#ifdef BUILD_WITH_PXPATH
-  else if (!strcmp("path",t.cString()))
-    e = createPath(p,o);
-#endif // BUILD_WITH_PXPATH
-  else if (!strcmp("image9",t.cString()))
-    e = createImage9(p,o);
-  else if (!strcmp("imageA",t.cString()))
-    e = createImageA(p,o);
-  else if (!strcmp("image9Border",t.cString()))
-    e = createImage9Border(p,o);
-  else if (!strcmp("imageResource",t.cString()))
-  {
-    e = createImageResource(p,o);
-    needpxObjectTracking = false;
-  }
-  else if (!strcmp("imageAResource",t.cString()))
-  {
-    e = createImageAResource(p,o);
-    needpxObjectTracking = false;
-  }
-  else if (!strcmp("fontResource",t.cString()))
-  {
-    e = createFontResource(p,o);
-    needpxObjectTracking = false;
-  }
-  else if (!strcmp("scene",t.cString()))
-    e = createScene(p,o);
-  else if (!strcmp("external",t.cString()))
-    e = createExternal(p,o);
-  else if (!strcmp("wayland",t.cString()))
-    e = createWayland(p,o);
-  else if (!strcmp("object",t.cString()))
-    e = createObject(p,o);
-  else
+
+  pxSceneTypeMap& types = sceneTypes();
+  pxSceneTypeMap::const_iterator it = types.find(t.cString());
+  if (it == types.end())
   {
     rtLogError("Unknown object type, %s in scene.create.", t.cString());
     return RT_FAIL;
   }
+  e = it->second.create(this, p, o);
+  bool needpxObjectTracking = it->second.tracked;
 
   // Handle psuedo property here for children.  Probably should make this
   rtObjectRef c = p.get<rtObjectRef>("c");
@@ -2147,10 +2208,73 @@ rtError pxScene2d::create(rtObjectRef p, rtObjectRef& o)
   }
 
   if (needpxObjectTracking)
-    mInnerpxObjects.push_back((pxObject*)o.getPtr());
+  {
+    pxObject* obj = dynamic_cast<pxObject*>(o.getPtr());
+    if (obj && obj->mSceneIndex < 0)
+    {
+      obj->mSceneIndex = (int32_t)mInnerpxObjects.size();
+      mInnerpxObjects.push_back(obj);
+    }
+  }
   return e;
 }
 
+rtError pxScene2d::createAll(rtObjectRef descriptors, rtObjectRef& objects)
+{
+  if (!descriptors)
+    return RT_ERROR_INVALID_ARG;
+
+  uint32_t l = descriptors.get<uint32_t>("length");
+  std::vector<rtObjectRef> created;
+  created.reserve(l);
+  for (uint32_t i = 0; i < l; i++)
+  {
+    rtObjectRef o;
+    rtError e = create(descriptors.get<rtObjectRef>(i), o);
+    if (o)
+      created.push_back(o);
+    if (e != RT_OK)
+    {
+      // All or nothing; detach what this batch already attached
+      for (std::vector<rtObjectRef>::iterator it = created.begin(); it != created.end(); ++it)
+      {
+        pxObject* obj = dynamic_cast<pxObject*>(it->getPtr());
+        if (obj)
+          obj->remove();
+      }
+      return e;
+    }
+  }
+
+  rtRefT<rtArrayObject> result = new rtArrayObject;
+  result->reserve(l);
+  for (std::vector<rtObjectRef>::iterator it = created.begin(); it != created.end(); ++it)
+    result->pushBack(*it);
+  objects = result;
+  return RT_OK;
+}
+
+rtError pxScene2d::applyBatch(rtObjectRef updates)
+{
+  if (!updates)
+    return RT_ERROR_INVALID_ARG;
+
+  uint32_t l = updates.get<uint32_t>("length");
+  if (l % 2)
+  {
+    rtLogError("applyBatch expects object, props pairs");
+    return RT_ERROR_INVALID_ARG;
+  }
+  for (uint32_t i = 0; i < l; i += 2)
+  {
+    rtObjectRef o = updates.get<rtObjectRef>(i);
+    if (!o)
+      return RT_ERROR_INVALID_ARG;
+    o.set(updates.get<rtObjectRef>(i + 1));
+  }
+  return RT_OK;
+}
+
 rtError pxScene2d::createObject(rtObjectRef p, rtObjectRef& o)
 {
   o = new pxObject(this);
@@ -2316,6 +2440,27 @@ rtError pxScene2d::logDebugMetrics()
 #ifdef ENABLE_DEBUG_METRICS
     script.collectGarbage();
     rtLogInfo("pxobjectcount is [%d]",pxObjectCount);
+    rtPool::dumpStats();
+#ifdef ENABLE_RT_NODE
+    rtSceneLockStats lockStats;
+    rtWrapperSceneLockStats(lockStats);
+    rtLogInfo("scene lock: %llu acquisitions, %llu contended, wait %.3fms (max %.3fms), hold %.3fms (max %.3fms)",
+              (unsigned long long)lockStats.acquisitions, (unsigned long long)lockStats.contended,
+              lockStats.waitSeconds*1000, lockStats.maxWaitSeconds*1000,
+              lockStats.holdSeconds*1000, lockStats.maxHoldSeconds*1000);
+#endif //ENABLE_RT_NODE
+    rtThreadPool* pools[] = { rtThreadPool::globalInstance(), rtThreadPool::ioInstance() };
+    const char* poolNames[] = { "cpu", "io" };
+    for (int i = 0; i < 2; i++)
+    {
+      rtThreadPoolStats poolStats;
+      pools[i]->stats(poolStats);
+      rtLogInfo("%s thread pool: %d threads, %u queued, %llu run, %llu stolen, wait avg %.3fms (max %.3fms)",
+                poolNames[i], poolStats.threads, poolStats.queued,
+                (unsigned long long)poolStats.executed, (unsigned long long)poolStats.stolen,
+                poolStats.executed ? poolStats.waitSeconds*1000/poolStats.executed : 0,
+                poolStats.maxWaitSeconds*1000);
+    }
 #ifdef PX_PLATFORM_MAC
       rtLogInfo("texture memory usage is [%lld]",context.currentTextureMemoryUsageInBytes());
 #else
@@ -2590,6 +2735,16 @@ void pxScene2d::onUpdate(double t)
 
   sigma_update += (pxSeconds() - start_frame); //##
 
+#if defined(ENABLE_RT_NODE) && defined(RUNINMAIN)
+  // Frames with nothing to redraw are spare time for warming up a script
+  // context for the next app; wait for a settled half second first
+  static int idleFrames = 0;
+  if (mTop)
+  {
+    idleFrames = mDirty ? 0 : idleFrames + 1;
+  }
+#endif
+
   if (mDirty)
   {
     mDirty = false;
@@ -2683,6 +2838,14 @@ void pxScene2d::onUpdate(double t)
     rtWrapperSceneUpdateExit();
   }
   #endif //ENABLE_RT_NODE
+
+#if defined(ENABLE_RT_NODE) && defined(RUNINMAIN)
+  if (mTop && idleFrames >= 30)
+  {
+    pxScriptView::fillContextPool();
+    idleFrames = 0;
+  }
+#endif
 }
 
 void pxScene2d::onDraw()
@@ -2999,13 +3162,30 @@ rtError stopPropagation2(int /*numArgs*/, const rtValue* /*args*/, rtValue* /*re
   return RT_OK;
 }
 
+// Sent on every pointer move; interned so rtEmit finds their listeners by
+// pointer
+static const rtString gOnMouseMove = rtString::intern("onMouseMove");
+static const rtString gOnPreMouseMove = rtString::intern("onPreMouseMove");
+static const rtString gOnMouseDrag = rtString::intern("onMouseDrag");
+static const rtString gOnPreMouseDrag = rtString::intern("onPreMouseDrag");
+
+bool pxScene2d::hasBubbleListeners(rtRef<pxObject> t, const rtString& preEvent, const rtString& event)
+{
+  for (pxObject* o = t.getPtr(); o; o = o->parent())
+  {
+    if (o->mEmit->hasListeners(preEvent) || o->mEmit->hasListeners(event))
+      return true;
+  }
+  return false;
+}
+
 bool pxScene2d::bubbleEvent(rtObjectRef e, rtRef<pxObject> t,
-                            const char* preEvent, const char* event)
+                            const rtString& preEvent, const rtString& event)
 {
   bool consumed = false;
   mStopPropagation = false;
   rtValue stop;
-  if (e && t)
+  if (e && t && hasBubbleListeners(t, preEvent, event))
   {
     AddRef();  // TODO refactor? make sure scene stays alive while we bubble since we're using the address of mStopPropagation
 //    e.set("stopPropagation", get<rtFunctionRef>("stopPropagation"));
@@ -3024,6 +3204,8 @@ bool pxScene2d::bubbleEvent(rtObjectRef e, rtRef<pxObject> t,
     for (vector<rtRef<pxObject> >::reverse_iterator it = l.rbegin();!mStopPropagation && it != itReverseEnd;++it)
     {
       // TODO a bit messy
+      if (!(*it)->mEmit->hasListeners(preEvent))
+        continue;
       rtFunctionRef emit = (*it)->mEmit.getPtr();
       if (emit)
         emit.sendReturns(preEvent,e,stop);
@@ -3038,6 +3220,8 @@ bool pxScene2d::bubbleEvent(rtObjectRef e, rtRef<pxObject> t,
     for (vector<rtRef<pxObject> >::iterator it = l.begin();!mStopPropagation && it != itEnd;++it)
     {
       // TODO a bit messy
+      if (!(*it)->mEmit->hasListeners(event))
+        continue;
       rtFunctionRef emit = (*it)->mEmit.getPtr();
       // TODO: As we bubble onMouseMove we need to keep adjusting the coordinates into the
       // coordinate space of the successive parents object ??
@@ -3147,13 +3331,15 @@ bool pxScene2d::onMouseMove(int32_t x, int32_t y)
   mDirty= true;
   #endif
 #if 1
+  // Send to root scene in global window coordinates
+  if (mEmit->hasListeners(gOnMouseMove))
   {
-    // Send to root scene in global window coordinates
-    rtObjectRef e = new rtMapObject;
-    e.set("name", "onMouseMove");
+    rtObjectRef e = mEventCache.get();
+    e.set("name", gOnMouseMove);
     e.set("x", x);
     e.set("y", y);
-    mEmit.send("onMouseMove", e);
+    mEmit.send(gOnMouseMove, e);
+    mEventCache.recycle(e);
   }
 #endif
 
@@ -3202,16 +3388,21 @@ bool pxScene2d::onMouseMove(int32_t x, int32_t y)
     e.set("y", to.mY);
     mMouseDown->mEmit.send("onMouseMove", e);
 #else
-    rtObjectRef e = new rtMapObject;
-    e.set("target", mMouseDown.getPtr());
-    e.set("x", to.x());
-    e.set("y", to.y());
-    bubbleEvent(e, mMouseDown, "onPreMouseMove", "onMouseMove");
+    if (hasBubbleListeners(mMouseDown, gOnPreMouseMove, gOnMouseMove))
+    {
+      rtObjectRef e = mEventCache.get();
+      e.set("target", mMouseDown.getPtr());
+      e.set("x", to.x());
+      e.set("y", to.y());
+      bubbleEvent(e, mMouseDown, gOnPreMouseMove, gOnMouseMove);
+      mEventCache.recycle(e);
+    }
 #endif
     }
+    if (hasBubbleListeners(mMouseDown, gOnPreMouseDrag, gOnMouseDrag))
     {
-    rtObjectRef e = new rtMapObject;
-    e.set("name", "onMouseDrag");
+    rtObjectRef e = mEventCache.get();
+    e.set("name", gOnMouseDrag);
     e.set("target", mMouseDown.getPtr());
     e.set("x", x);
     e.set("y", y);
@@ -3220,8 +3411,9 @@ bool pxScene2d::onMouseMove(int32_t x, int32_t y)
 #if 0
     mMouseDown->mEmit.send("onMouseDrag", e);
 #else
-    bubbleEvent(e,mMouseDown,"onPreMouseDrag","onMouseDrag");
+    bubbleEvent(e,mMouseDown,gOnPreMouseDrag,gOnMouseDrag);
 #endif
+    mEventCache.recycle(e);
     }
   }
   else // Only send mouse leave/enter events if we're not dragging
@@ -3232,15 +3424,19 @@ bool pxScene2d::onMouseMove(int32_t x, int32_t y)
       // rather than the object... we can send objects enter/leave events
       // and we can send drag events to objects that are being drug...
 #if 1
-      rtObjectRef e = new rtMapObject;
-//      e.set("name", "onMouseMove");
-      e.set("x", hitPt.x);
-      e.set("y", hitPt.y);
+      if (hasBubbleListeners(hit, gOnPreMouseMove, gOnMouseMove))
+      {
+        rtObjectRef e = mEventCache.get();
+//        e.set("name", "onMouseMove");
+        e.set("x", hitPt.x);
+        e.set("y", hitPt.y);
 #if 0
-      hit->mEmit.send("onMouseMove",e);
+        hit->mEmit.send("onMouseMove",e);
 #else
-      bubbleEvent(e, hit, "onPreMouseMove", "onMouseMove");
+        bubbleEvent(e, hit, gOnPreMouseMove, gOnMouseMove);
 #endif
+        mEventCache.recycle(e);
+      }
 #endif
 
       setMouseEntered(hit);
@@ -3693,6 +3889,8 @@ rtDefineProperty(pxScene2d, showDirtyRect);
 rtDefineProperty(pxScene2d, enableDirtyRect);
 rtDefineProperty(pxScene2d, customAnimator);
 rtDefineMethod(pxScene2d, create);
+rtDefineMethod(pxScene2d, createAll);
+rtDefineMethod(pxScene2d, applyBatch);
 rtDefineMethod(pxScene2d, clock);
 rtDefineMethod(pxScene2d, logDebugMetrics);
 rtDefineMethod(pxScene2d, collectGarbage);
@@ -3818,21 +4016,22 @@ void pxScene2d::invalidateRect(pxRect* r)
   }
 }
 
-void pxScene2d::innerpxObjectDisposed(rtObjectRef ref)
+void pxScene2d::innerpxObjectDisposed(pxObject* o)
 {
   // this is to make sure, we are not clearing the rtobject references, while it is under process from scene dispose
   if (!mDisposed)
   {
-    unsigned int pos = 0;
-    for (; pos<mInnerpxObjects.size(); pos++)
-    {
-      if (mInnerpxObjects[pos] == ref)
-        break;
-    }
-    if (pos != mInnerpxObjects.size())
+    int32_t pos = o->mSceneIndex;
+    if (pos < 0 || pos >= (int32_t)mInnerpxObjects.size() || mInnerpxObjects[pos].getPtr() != o)
+      return;
+    // move the last object into the freed slot
+    o->mSceneIndex = -1;
+    if (pos != (int32_t)mInnerpxObjects.size() - 1)
     {
-      mInnerpxObjects.erase(mInnerpxObjects.begin()+pos);
+      mInnerpxObjects[pos] = mInnerpxObjects.back();
+      mInnerpxObjects[pos]->mSceneIndex = pos;
     }
+    mInnerpxObjects.pop_back();
   }
 }
 
@@ -4101,9 +4300,22 @@ void pxScriptView::runScript()
 // escape url end
 
   #ifdef ENABLE_RT_NODE
-  rtLogDebug("pxScriptView::pxScriptView is just now creating a context for mUrl=%s\n",mUrl.cString());
-  //mCtx = script.createContext("javascript");
-  script.createContext("javascript", mCtx);
+  bool pooled = false;
+#ifdef RUNINMAIN
+  if (!mContextPool.empty())
+  {
+    rtLogDebug("pxScriptView::pxScriptView is using a pooled context for mUrl=%s\n",mUrl.cString());
+    mCtx = mContextPool.back();
+    mContextPool.pop_back();
+    pooled = true;
+  }
+#endif
+  if (!pooled)
+  {
+    rtLogDebug("pxScriptView::pxScriptView is just now creating a context for mUrl=%s\n",mUrl.cString());
+    //mCtx = script.createContext("javascript");
+    script.createContext("javascript", mCtx);
+  }
 
   if (mCtx)
   {
@@ -4121,7 +4333,8 @@ void pxScriptView::runScript()
     mReady = new rtPromise();
 #endif
 
-    mCtx->runFile("init.js");
+    if (!pooled)
+      mCtx->runFile("init.js");
 
     char buffer[MAX_URL_SIZE + 50];
     memset(buffer, 0, sizeof(buffer));
@@ -4153,6 +4366,42 @@ void pxScriptView::runScript()
   #endif //ENABLE_RT_NODE
 }
 
+#if defined(ENABLE_RT_NODE) && defined(RUNINMAIN)
+std::vector<rtScriptContextRef> pxScriptView::mContextPool;
+
+void pxScriptView::fillContextPool()
+{
+  static int32_t poolSize = -1;
+  if (poolSize < 0)
+  {
+    poolSize = 1;
+    rtValue val;
+    if (RT_OK == rtSettings::instance()->value("scriptContextPoolSize", val))
+      poolSize = val.toInt32();
+  }
+
+  if ((int32_t)mContextPool.size() >= poolSize)
+    return;
+
+  // init.js only uses the view callbacks from loadUrl, so they can be
+  // added when the context is claimed
+  rtScriptContextRef ctx;
+  if (RT_OK == script.createContext("javascript", ctx) && ctx)
+  {
+    double start = pxSeconds();
+    ctx->runFile("init.js");
+    mContextPool.push_back(ctx);
+    rtLogInfo("pooled script context %d of %d took %.1fms", (int)mContextPool.size(), poolSize,
+              (pxSeconds() - start) * 1000);
+  }
+}
+
+void pxScriptView::clearContextPool()
+{
+  mContextPool.clear();
+}
+#endif
+
 rtError pxScriptView::printFunc(int numArgs, const rtValue* args, rtValue* result, void* ctx)
 {
   UNUSED_PARAM(result);
@@ -153,6 +153,18 @@ class rtFileDownloadRequest;
 class pxScene2d;
 class pxScriptView;
 class pxFontManager;
+
+// pxObject state that most nodes never use, allocated on first write
+struct pxObjectExtra
+{
+  pxContextFramebufferRef mSnapshotRef;
+  pxContextFramebufferRef mClipSnapshotRef;
+  pxContextFramebufferRef mDrawableSnapshotForMask;
+  pxContextFramebufferRef mMaskSnapshot;
+  std::vector<animation> mAnimations;
+  rtString mId;
+};
+
 class pxObject: public rtObject
 {
 public:
@@ -205,6 +217,7 @@ public:
   rtMethod2ArgAndNoReturn("on", addListener, rtString, rtFunctionRef);
   rtMethod2ArgAndNoReturn("delListener", delListener, rtString, rtFunctionRef);
   rtMethodNoArgAndNoReturn("dispose",releaseResources);
+  rtMethod1ArgAndNoReturn("setProps", setProps, rtObjectRef);
  // rtProperty(onReady, onReady, setOnReady, rtFunctionRef);
 
 //  rtReadOnlyProperty(emit, emit, rtFunctionRef);
@@ -245,6 +258,10 @@ public:
 
   virtual ~pxObject() ;
 
+  // pxObjects of every type come from size classed pools
+  static void* operator new(size_t size);
+  static void operator delete(void* p, size_t size);
+
   
 
   // TODO missing conversions in rtValue between uint32_t and int32_t
@@ -299,9 +316,9 @@ public:
   rtError remove();
   rtError removeAll();
   
-  rtString id() { return mId; }
-  rtError id(rtString& v) const { v = mId; return RT_OK; }
-  rtError setId(const rtString& v) { mId = v; return RT_OK; }
+  rtString id() { return mExtra ? mExtra->mId : rtString(); }
+  rtError id(rtString& v) const { v = mExtra ? mExtra->mId : rtString(); return RT_OK; }
+  rtError setId(const rtString& v) { extra().mId = v; return RT_OK; }
 
   rtError interactive(bool& v) const { v = mInteractive; return RT_OK; }
   rtError setInteractive(bool v) { mInteractive = v; return RT_OK; }
@@ -388,6 +405,9 @@ public:
   rtError moveToFront();
   rtError moveToBack();
 
+  // Sets every property in props with a single call from script
+  rtError setProps(rtObjectRef props);
+
   virtual void dispose(bool pumpJavascript);
 
   void drawInternal(bool maskPass=false);
@@ -648,7 +668,7 @@ public:
     }
     
     // TODO fix rtString empty check
-    if (from->mId.cString() && !strcmp(id, from->mId.cString()))
+    if (from->mExtra && from->mExtra->mId.cString() && !strcmp(id, from->mExtra->mId.cString()))
       return from;
     
     for(std::vector<rtRef<pxObject> >::iterator it = from->mChildren.begin(); it != from->mChildren.end(); ++it)
@@ -727,54 +747,57 @@ public:
   rtEmitRef mEmit;
 
 protected:
-  // TODO getting freaking huge... 
+  // Hot per frame state is kept together up front; rarely used state lives
+  // in mExtra
 //  rtRef<pxObject> mParent;
   pxObject* mParent;
   std::vector<rtRef<pxObject> > mChildren;
-//  vector<animation> mAnimations;
   float mpx, mpy, mcx, mcy, mx, my, ma, mr;
 #ifdef ANIMATION_ROTATE_XYZ
   float mrx, mry, mrz;
 #endif // ANIMATION_ROTATE_XYZ
   float msx, msy, mw, mh;
+  pxMatrix4f mMatrix;
   bool mInteractive;
-  pxContextFramebufferRef mSnapshotRef;
   bool mPainting;
   bool mClip;
   bool mMask;
   bool mDraw;
   bool mHitTest;
-  rtObjectRef mReady;
   bool mFocus;
-  pxContextFramebufferRef mClipSnapshotRef;
   bool mCancelInSet;
-  rtString mId;
-  pxMatrix4f mMatrix;
   bool mUseMatrix;
   bool mRepaint;
+  bool mIsDisposed;
+  bool mSceneSuspended;
   #ifdef PX_DIRTY_RECTANGLES
   bool mIsDirty;
   pxMatrix4f mRenderMatrix;
   pxRect mScreenCoordinates;
   pxRect mDirtyRect;
   #endif //PX_DIRTY_RECTANGLES
+  pxScene2d* mScene;
+  friend class pxScene2d;
+  int32_t mSceneIndex;  // slot in the scene's object list, -1 if untracked
+  rtObjectRef mReady;
+  pxObjectExtra* mExtra;
+
+  pxObjectExtra& extra()
+  {
+    if (!mExtra)
+      mExtra = new pxObjectExtra;
+    return *mExtra;
+  }
 
   void createSnapshotOfChildren();
   void clearSnapshot(pxContextFramebufferRef fbo);
+  void clearSnapshots();
   #ifdef PX_DIRTY_RECTANGLES
   void setDirtyRect(pxRect* r);
   pxRect getBoundingRectInScreenCoordinates();
   pxRect convertToScreenCoordinates(pxRect* r);
   #endif //PX_DIRTY_RECTANGLES
 
-  pxScene2d* mScene;
-
-  std::vector<animation> mAnimations;  
-  pxContextFramebufferRef mDrawableSnapshotForMask;
-  pxContextFramebufferRef mMaskSnapshot;
-  bool mIsDisposed;
-  bool mSceneSuspended;
-
  private:
   rtError _pxObject(voidPtr& v) const {
     v = (void*)this;
@@ -1201,7 +1224,15 @@ public:
   rtError suspend(const rtValue& v, bool& b);
   rtError resume(const rtValue& v, bool& b);
   rtError textureMemoryUsage(rtValue& v);
-  
+
+#if defined(ENABLE_RT_NODE) && defined(RUNINMAIN)
+  // Contexts that have already run init.js, so a new view can go straight
+  // to loading its url.  Topped up by one context per call, up to the
+  // scriptContextPoolSize setting (default 1, 0 turns the pool off).
+  static void fillContextPool();
+  static void clearContextPool();
+#endif
+
 protected:
 
   static rtError printFunc(int /*numArgs*/, const rtValue* /*args*/, rtValue* result, void* ctx);
@@ -1344,6 +1375,9 @@ protected:
   rtString mLang;
 #endif
   static rtEmitRef mEmit;
+#if defined(ENABLE_RT_NODE) && defined(RUNINMAIN)
+  static std::vector<rtScriptContextRef> mContextPool;
+#endif
 };
 
 class pxScene2d: public rtObject, public pxIView, public rtIServiceProvider
@@ -1359,6 +1393,8 @@ public:
   rtProperty(customAnimator, customAnimator, setCustomAnimator, rtFunctionRef);
   rtMethod1ArgAndReturn("loadArchive",loadArchive,rtString,rtObjectRef); 
   rtMethod1ArgAndReturn("create", create, rtObjectRef, rtObjectRef);
+  rtMethod1ArgAndReturn("createAll", createAll, rtObjectRef, rtObjectRef);
+  rtMethod1ArgAndNoReturn("applyBatch", applyBatch, rtObjectRef);
   rtMethodNoArgAndReturn("clock", clock, double);
   rtMethodNoArgAndNoReturn("logDebugMetrics", logDebugMetrics);
   rtMethodNoArgAndNoReturn("collectGarbage", collectGarbage);
@@ -1493,6 +1529,23 @@ public:
 
   rtError create(rtObjectRef p, rtObjectRef& o);
 
+  // Adds or replaces a type for scene.create, for embedders with their own
+  // object types.  Tracked objects must be pxObjects; they are disposed with
+  // the scene.  Register types before any scene is created.
+  typedef rtError (*createFunction)(pxScene2d* scene, rtObjectRef p, rtObjectRef& o);
+  static void registerType(const char* t, createFunction f, bool tracked = true);
+  // Removes a type added with registerType; like registration this is not
+  // safe while scenes are being created
+  static void unregisterType(const char* t);
+
+  // Batched forms of create and property sets, one script call for a whole
+  // list or grid.  createAll takes an array of create descriptors and returns
+  // the array of objects; if any create fails the objects already created are
+  // removed from their parents.  applyBatch takes [object, props, object,
+  // props, ...]; updates before a bad pair are kept
+  rtError createAll(rtObjectRef descriptors, rtObjectRef& objects);
+  rtError applyBatch(rtObjectRef updates);
+
   rtError createObject(rtObjectRef p, rtObjectRef& o);
   rtError createRectangle(rtObjectRef p, rtObjectRef& o);
   rtError createText(rtObjectRef p, rtObjectRef& o);
@@ -1683,7 +1736,7 @@ public:
     return e;
   }
 
-  void innerpxObjectDisposed(rtObjectRef ref);
+  void innerpxObjectDisposed(pxObject* o);
 
   // Note: Only type currently supported is "image/png;base64"
   rtError screenshot(rtString type, rtString& pngData);
@@ -1699,9 +1752,11 @@ public:
 
 private:
   bool bubbleEvent(rtObjectRef e, rtRef<pxObject> t, 
-                   const char* preEvent, const char* event) ;
+                   const rtString& preEvent, const rtString& event) ;
   
   bool bubbleEventOnBlur(rtObjectRef e, rtRef<pxObject> t, rtRef<pxObject> o);
+  // True if t or one of its ancestors listens for either event
+  bool hasBubbleListeners(rtRef<pxObject> t, const rtString& preEvent, const rtString& event);
 
   void draw();
   // Does not draw updates scene to time t
@@ -1729,6 +1784,7 @@ private:
   rtValue mAPI;
   bool mTop;
   bool mStopPropagation;
+  rtMapObjectCache mEventCache;
   int mTag;
   pxIViewContainer *mContainer;
   pxScriptView *mScriptView;
@@ -1748,7 +1804,8 @@ private:
   int32_t mPointerHotSpotY;
   #endif
   bool mPointerHidden;
-  std::vector<rtObjectRef> mInnerpxObjects;
+  // Objects created by this scene; each knows its slot so removal is O(1)
+  std::vector<rtRef<pxObject> > mInnerpxObjects;
   rtFunctionRef mCustomAnimator;
 #ifdef ENABLE_PERMISSIONS_CHECK
   rtPermissionsRef mPermissions;
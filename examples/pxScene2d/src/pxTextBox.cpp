@@ -397,11 +397,13 @@ void pxTextBox::measureTextWithWrapOrNewLine(const char *text, float sx, float s
     }
     
     // Read char by char to determine full line of text before rendering
+    rtUtf8Reader reader(text, true);
     int i = 0;
     int lasti = 0;
     int numbytes = 1;
-    while((charToMeasure = u8_nextchar((char*)text, &i)) != 0)
+    while((charToMeasure = reader.next()) != 0)
     {
+      i = reader.offset();
       // Determine if the character is multibyte
       numbytes = i-lasti;
         
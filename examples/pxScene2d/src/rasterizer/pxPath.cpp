@@ -24,6 +24,27 @@
 
 extern pxContext context;
 
+// Rasterized paths, shared by every pxPath with the same d at the same size
+struct pxPathRaster
+{
+  pxTextureRef mTexture;
+  int32_t      mWidth;
+  int32_t      mHeight;
+  uint32_t     mUsers;
+};
+
+typedef std::map<rtString, pxPathRaster> pxPathRasterMap;
+static pxPathRasterMap gPathRasters;
+
+static void releasePathRaster(const rtString& key)
+{
+  pxPathRasterMap::iterator it = gPathRasters.find(key);
+  if (it != gPathRasters.end() && --it->second.mUsers == 0)
+  {
+    gPathRasters.erase(it);
+  }
+}
+
 
 void pxPath::onInit()
 {
@@ -45,37 +66,49 @@ void pxPath::onInit()
 
   // If pxObject dimensions ARE set ... relate to SVG
   //
-  float iw = ( w() <= 0 ) ? mImage.width()  : w();
-  float ih = ( h() <= 0 ) ? mImage.height() : h();
-  
-  rtError ret = pxLoadSVGImage(s, len, mImage, static_cast<int>(iw), static_cast<int>(ih));
-  
-  // If pxObject dimensions NOT set yet ... infer from SVG
-  //
-  if(iw <=0) iw = static_cast<float>(mImage.width());
-  if(ih <=0) ih = static_cast<float>(mImage.height());
-  
-  if(ret == RT_OK)
+  float iw = ( w() <= 0 ) ? 0 : w();
+  float ih = ( h() <= 0 ) ? 0 : h();
+
+  char size[32];
+  snprintf(size, sizeof(size), "%dx%d:", static_cast<int>(iw), static_cast<int>(ih));
+  rtString key(size);
+  key.append(s);
+
+  releasePathRaster(mRasterKey);
+  mRasterKey = "";
+  mTexture = NULL;
+
+  pxPathRasterMap::iterator it = gPathRasters.find(key);
+  if (it == gPathRasters.end())
   {
-    setW( iw ); // Use SVG size - of not set
-    setH( ih ); // Use SVG size - of not set
-  
-    // premultiply
-    for (int y = 0; y < mImage.height(); y++)
+    pxOffscreen image;
+
+    // nanosvg hands back premultiplied pixels, ready for the texture as is
+    if (pxLoadSVGImage(s, len, image, static_cast<int>(iw), static_cast<int>(ih), 1.0f, 1.0f, true) == RT_OK)
     {
-      pxPixel* d = mImage.scanline(y);
-      pxPixel* de = d + mImage.width();
-      while (d < de)
-      {
-        d->r = (d->r * d->a)/255;
-        d->g = (d->g * d->a)/255;
-        d->b = (d->b * d->a)/255;
-        d++;
-      }
+      pxPathRaster raster;
+      raster.mTexture = context.createTexture(image);
+      raster.mWidth   = image.width();
+      raster.mHeight  = image.height();
+      raster.mUsers   = 0;
+      it = gPathRasters.insert(std::make_pair(key, raster)).first;
     }
-    
-    mTexture = context.createTexture(mImage);
-    
+  }
+
+  if(it != gPathRasters.end())
+  {
+    it->second.mUsers++;
+    mRasterKey = key;
+    mTexture = it->second.mTexture;
+
+    // If pxObject dimensions NOT set yet ... infer from SVG
+    //
+    if(iw <=0) iw = static_cast<float>(it->second.mWidth);
+    if(ih <=0) ih = static_cast<float>(it->second.mHeight);
+
+    setW( iw ); // Use SVG size - of not set
+    setH( ih ); // Use SVG size - of not set
+
     mInitialized = true;
   }
   
@@ -84,7 +117,8 @@ void pxPath::onInit()
 
 pxPath::~pxPath()
 {
-
+  mTexture = NULL;
+  releasePathRaster(mRasterKey);
 }
 
 void pxPath::sendPromise()
@@ -57,8 +57,8 @@ public:
   virtual rtError path(rtString& v) const { v = mPath; return RT_OK; };
 
   rtString     mPath;
-  pxOffscreen  mImage;
-  
+  rtString     mRasterKey;  // entry shared with other pxPaths, see pxPath.cpp
+
   pxTextureRef mTexture;
 
 }; // CLASS - pxPath
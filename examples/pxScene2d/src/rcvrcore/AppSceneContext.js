@@ -33,6 +33,8 @@ var JarFileMap = require('rcvrcore/utils/JarFileMap');
 var AsyncFileAcquisition = require('rcvrcore/utils/AsyncFileAcquisition');
 var WrapObj = require('rcvrcore/utils/WrapObj');
 var http_wrap = require('rcvrcore/http_wrap');
+var CodeCache = (isDuk || isV8) ? null : require('rcvrcore/utils/CodeCache');
+var DependencyCache = require('rcvrcore/utils/DependencyCache');
 
 var log = new Logger('AppSceneContext');
 //overriding original timeout and interval functions
@@ -218,6 +220,13 @@ AppSceneContext.prototype.loadPackage = function(packageUri) {
   // Fixed scene loading promise rejection
   var thisMakeReady = this.makeReady;
 
+  // Fetch what the app imported last time alongside the package itself
+  var dependencies = DependencyCache.dependencies(this.packageUrl);
+  DependencyCache.begin(this.packageUrl);
+  for (var k = 0; k < dependencies.length; ++k) {
+    this.asyncFileAcquisition.prefetch(dependencies[k]);
+  }
+
   moduleLoader.loadScenePackage(this.innerscene, {fileUri:packageUri})
     .then(function processScenePackage() {
       if( moduleLoader.isDefaultManifest() ) {
@@ -483,10 +492,8 @@ AppSceneContext.prototype.runScriptInNewVMContext = function (packageUri, module
         moduleFunc(px, xModule, fname, this.basePackageUri);
 
       } else {
-        var moduleFunc = vm.runInNewContext(sourceCode, newSandbox, {
-          filename: path.normalize(fname),
-          displayErrors: true
-        });
+        var script = CodeCache.compile(sourceCode, path.normalize(fname));
+        var moduleFunc = script.runInNewContext(newSandbox, { displayErrors: true });
         if (process._debugWaitConnect) {
           // Set breakpoint on module start
           if (process.env.BREAK_ON_SCRIPTSTART != 1)
@@ -518,16 +525,19 @@ if (false) {
       if( !xModule.hasOwnProperty('moduleReadyPromise') || xModule.moduleReadyPromise === null ) {
         console.log("Main module[" + self.packageUrl + "] about to notify. xModule.exports:"+(typeof xModule.exports));
         self.innerscene.api = xModule.exports;
+        self.asyncFileAcquisition.releasePrefetched();
         this.makeReady(true, xModule.exports);
         console.log("Main module[" + self.packageUrl + "] about to notify done");
       } else {
         xModule.moduleReadyPromise.then( function() {
           console.log("Main module[" + self.packageUrl + "] about to notify. xModule.exports:"+(typeof xModule.exports));
           self.innerscene.api = xModule.exports;
+          self.asyncFileAcquisition.releasePrefetched();
           self.makeReady(true, xModule.exports);
           console.log("Main module[" + self.packageUrl + "] about to notify done");
         }).catch( function(err) {
           console.error("Main module[" + self.packageUrl + "]" + " load has failed - on failed imports: " + ", err=" + err);
+          self.asyncFileAcquisition.releasePrefetched();
           self.makeReady(false, {});
         });
       }
@@ -726,6 +736,7 @@ AppSceneContext.prototype.include = function(filePath, currentXModule) {
       return;
     }
 
+    DependencyCache.record(_this.packageUrl, filePath);
     _this.asyncFileAcquisition.acquire(filePath)
       .then(function(moduleLoader){
         log.message(4, "PROCESS RCVD MODULE: " + filePath);
@@ -797,7 +808,8 @@ AppSceneContext.prototype.processCodeBuffer = function(origFilePath, filePath, c
 
     moduleFunc(px, xModule, filePath, filePath);
   } else {
-    var moduleFunc = vm.runInContext(sourceCode, _this.sandbox, {filename:filePath, displayErrors:true});
+    var script = CodeCache.compile(sourceCode, filePath);
+    var moduleFunc = script.runInContext(_this.sandbox, {displayErrors:true});
     moduleFunc(px, xModule, filePath, filePath);
   }
   log.message(4, "RUN DONE: " + filePath);
@@ -27,10 +27,48 @@ var log = new Logger('AsyncFileAcquisition');
 function AsyncFileAcquisition(scene) {
   this.scene = scene;
   this.requestMap = {};
+  this.prefetchMap = {};
 }
 
+/**
+ * Starts loading uri ahead of the import that is expected to need it.  The
+ * result is handed to the first acquire() of uri.
+ */
+AsyncFileAcquisition.prototype.prefetch = function(uri) {
+  if( this.requestMap.hasOwnProperty(uri) || this.prefetchMap.hasOwnProperty(uri) ) {
+    return;
+  }
+  log.message(4, "ACQUISITION: prefetching: " + uri);
+  var moduleLoader = new SceneModuleLoader();
+  var promise = moduleLoader.loadScenePackage(this.scene, {fileUri:uri})
+    .then(function() {
+      return moduleLoader;
+    });
+  // failures are reported if and when the file is acquired
+  promise.catch(function() {});
+  this.prefetchMap[uri] = promise;
+};
+
+/**
+ * Drops prefetched files nothing acquired, once the app has finished loading
+ * and no import is still expected to take them.
+ */
+AsyncFileAcquisition.prototype.releasePrefetched = function() {
+  var unused = Object.keys(this.prefetchMap);
+  if( unused.length !== 0 ) {
+    log.message(4, "ACQUISITION: dropping " + unused.length + " unused prefetched files");
+  }
+  this.prefetchMap = {};
+};
+
 AsyncFileAcquisition.prototype.acquire = function(uri) {
   var _this = this;
+  if( this.prefetchMap.hasOwnProperty(uri) ) {
+    log.message(4, "ACQUISITION: using prefetched: " + uri);
+    var prefetched = this.prefetchMap[uri];
+    delete this.prefetchMap[uri];
+    return prefetched;
+  }
   return new Promise(function (resolve, reject) {
     if( _this.requestMap.hasOwnProperty(uri) ) {
       // already waiting on file
@@ -0,0 +1,203 @@
+/*
+
+pxCore Copyright 2005-2018 John Robinson
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+"use strict";
+
+var fs = require('fs');
+var os = require('os');
+var path = require('path');
+var vm = require('vm');
+var crypto = require('crypto');
+var Logger = require('rcvrcore/Logger').Logger;
+var log = new Logger('CodeCache');
+
+// Short sources compile faster than a cache file can be read back
+var MIN_SOURCE_LENGTH = 1024;
+var CACHE_FILE_EXTENSION = '.njc';
+
+// Scripts compiled here get their own directory and size budget; the native
+// rtCodeCache (codeCacheDirectory setting) only holds scripts compiled in C++.
+// The directory is per user; Windows has no euid but its temp dir is per user.
+var euid = process.geteuid ? process.geteuid() : null;
+var cacheDirectory = process.env.PXSCENE_CODE_CACHE_DIR ||
+  (euid === null ? path.join(os.tmpdir(), 'nodecodecache') : '/tmp/nodecodecache-' + euid);
+var maxCacheSize = parseInt(process.env.PXSCENE_CODE_CACHE_MAX_SIZE, 10) || 16777216;
+var enabled = process.env.PXSCENE_CODE_CACHE !== '0';
+
+// file name -> { size, time } of the entries in cacheDirectory
+var entries = {};
+var cacheSize = 0;
+
+// V8 loads cached code as is, so only use a directory nobody else can write
+// to: a real directory owned by this user with no group/other access
+function isPrivateDirectory(dir) {
+  if (euid === null) {
+    return true;
+  }
+  try {
+    var stats = fs.lstatSync(dir);
+    return stats.isDirectory() && stats.uid === euid && (stats.mode & 0o077) === 0;
+  } catch (e) {
+    return false;
+  }
+}
+
+if (enabled) {
+  try {
+    fs.mkdirSync(cacheDirectory, 0o700);
+  } catch (e) {
+    if (e.code !== 'EEXIST') {
+      log.warn("code cache disabled, cannot create " + cacheDirectory + ": " + e);
+      enabled = false;
+    }
+  }
+}
+
+if (enabled && !isPrivateDirectory(cacheDirectory)) {
+  log.warn("code cache disabled, " + cacheDirectory + " is not a private directory of this user");
+  enabled = false;
+}
+
+function forget(name) {
+  var entry = entries[name];
+  if (entry) {
+    cacheSize -= entry.size;
+    delete entries[name];
+  }
+}
+
+function touch(name, size, time) {
+  forget(name);
+  entries[name] = { size: size, time: time };
+  cacheSize += size;
+}
+
+function loadEntries() {
+  var names = [];
+  try {
+    names = fs.readdirSync(cacheDirectory);
+  } catch (e) {
+    return;
+  }
+  names.forEach(function(name) {
+    var fileName = path.join(cacheDirectory, name);
+    try {
+      if (path.extname(name) === '.tmp') {
+        // Left over from an interrupted write
+        fs.unlinkSync(fileName);
+      } else if (path.extname(name) === CACHE_FILE_EXTENSION) {
+        var stats = fs.statSync(fileName);
+        touch(name, stats.size, stats.mtime.getTime());
+      }
+    } catch (e) {}
+  });
+}
+
+// Removes least recently used entries till the cache fits maxCacheSize
+function evict() {
+  if (cacheSize <= maxCacheSize) {
+    return;
+  }
+  var names = Object.keys(entries).sort(function(a, b) {
+    return entries[a].time - entries[b].time;
+  });
+  for (var i = 0; i < names.length && cacheSize > maxCacheSize; i++) {
+    try {
+      fs.unlinkSync(path.join(cacheDirectory, names[i]));
+    } catch (e) {
+      if (e.code !== 'ENOENT') {
+        continue;
+      }
+    }
+    forget(names[i]);
+  }
+}
+
+if (enabled) {
+  loadEntries();
+  evict();
+}
+
+function cacheFileName(sourceCode) {
+  var hash = crypto.createHash('sha1');
+  hash.update(process.versions.v8 + '|');
+  hash.update(sourceCode);
+  return hash.digest('hex') + CACHE_FILE_EXTENSION;
+}
+
+function store(name, data) {
+  // Publish the entry in one step so readers never see a partial file
+  var fileName = path.join(cacheDirectory, name);
+  var tmpName = fileName + '.tmp';
+  try {
+    fs.writeFileSync(tmpName, data, { mode: 0o600 });
+    fs.renameSync(tmpName, fileName);
+    touch(name, data.length, Date.now());
+    evict();
+  } catch (e) {
+    log.warn("writing code cache file " + fileName + " failed: " + e);
+    try { fs.unlinkSync(tmpName); } catch (e2) {}
+  }
+}
+
+function remove(name) {
+  try { fs.unlinkSync(path.join(cacheDirectory, name)); } catch (e) {}
+  forget(name);
+}
+
+/**
+ * Compiles sourceCode into a vm.Script, reusing V8's code cache from a previous run.
+ * @param sourceCode - string
+ * @param filename - name used in stack traces
+ * @returns {vm.Script}
+ */
+function compile(sourceCode, filename) {
+  var options = { filename: filename, displayErrors: true };
+  if (!enabled || sourceCode.length < MIN_SOURCE_LENGTH) {
+    return new vm.Script(sourceCode, options);
+  }
+
+  var name = cacheFileName(sourceCode);
+  var fileName = path.join(cacheDirectory, name);
+  try {
+    options.cachedData = fs.readFileSync(fileName);
+  } catch (e) {
+    options.produceCachedData = true;
+  }
+
+  var script = new vm.Script(sourceCode, options);
+  if (options.cachedData && script.cachedDataRejected) {
+    // Built by another V8 or with other flags; a fresh one is stored next load
+    log.message(4, "code cache for " + filename + " rejected");
+    remove(name);
+  } else if (options.cachedData) {
+    // Mark as recently used; also keeps the eviction order across runs
+    var now = new Date();
+    try { fs.utimesSync(fileName, now, now); } catch (e) {}
+    touch(name, options.cachedData.length, now.getTime());
+  } else if (script.cachedDataProduced) {
+    store(name, script.cachedData);
+  }
+  return script;
+}
+
+module.exports = {
+  compile: compile,
+  directory: cacheDirectory,
+  enabled: enabled
+};
@@ -0,0 +1,120 @@
+/*
+
+pxCore Copyright 2005-2018 John Robinson
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+"use strict";
+
+/**
+ * Remembers which module files each app imported, so the next launch of the app
+ * can fetch all of them up front instead of discovering them one import level
+ * at a time.  Kept in memory for the process and, under node, in a file.
+ */
+
+var isDuk=(typeof Duktape != "undefined")?true:false;
+var isV8=(typeof _isV8 != "undefined")?true:false;
+var Logger = require('rcvrcore/Logger').Logger;
+var log = new Logger('DependencyCache');
+
+var MAX_PACKAGES = 64;
+var SAVE_DELAY_MS = 2000;
+
+var fs = null;
+var cacheFile = null;
+if (!isDuk && !isV8) {
+  // Lives next to the code cache and is only trusted when that directory is
+  var codeCache = require('rcvrcore/utils/CodeCache');
+  if (codeCache.enabled) {
+    fs = require('fs');
+    cacheFile = codeCache.directory + '/dependencies.json';
+  }
+}
+
+// packageUrl -> array of module uris, most recently launched packages last
+var packages = null;
+var saveTimer = null;
+
+function load() {
+  if (packages !== null) {
+    return;
+  }
+  packages = {};
+  if (fs === null) {
+    return;
+  }
+  try {
+    packages = JSON.parse(fs.readFileSync(cacheFile, 'utf8'));
+  } catch (e) {
+    // missing or unreadable; start over
+  }
+}
+
+function save() {
+  saveTimer = null;
+  var names = Object.keys(packages);
+  for (var k = 0; k < names.length - MAX_PACKAGES; ++k) {
+    delete packages[names[k]];
+  }
+  try {
+    fs.writeFileSync(cacheFile + '.tmp', JSON.stringify(packages), { mode: 0o600 });
+    fs.renameSync(cacheFile + '.tmp', cacheFile);
+  } catch (e) {
+    log.message(4, "could not write " + cacheFile + ": " + e);
+  }
+}
+
+/**
+ * Returns the module uris the package imported on its last launch.
+ * @param packageUrl - string
+ * @returns {Array}
+ */
+function dependencies(packageUrl) {
+  load();
+  return packages.hasOwnProperty(packageUrl) ? packages[packageUrl].slice() : [];
+}
+
+/**
+ * Starts the dependency list for a new launch of the package.
+ * @param packageUrl - string
+ */
+function begin(packageUrl) {
+  load();
+  delete packages[packageUrl];
+  packages[packageUrl] = [];
+}
+
+/**
+ * Records that the package imported uri during this launch.
+ * @param packageUrl - string
+ * @param uri - string
+ */
+function record(packageUrl, uri) {
+  load();
+  var list = packages[packageUrl];
+  if (list === undefined || list.indexOf(uri) !== -1) {
+    return;
+  }
+  list.push(uri);
+  if (fs !== null && saveTimer === null) {
+    saveTimer = setTimeout(save, SAVE_DELAY_MS);
+  }
+}
+
+module.exports = {
+  dependencies: dependencies,
+  begin: begin,
+  record: record
+};
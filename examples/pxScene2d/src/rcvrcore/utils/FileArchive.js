@@ -33,12 +33,17 @@ function FileArchive(filePath, nativeFileArchive) {
   this.baseFilePath = filePath.substring(0, filePath.lastIndexOf('/'));
   this.numEntries = 0;
   this.directory = {};
+  this.jarEntries = {};
   this.jar = null;
   this.nativeFileArchive = nativeFileArchive;
 }
 
 FileArchive.prototype.removeFile = function(filename) {
-  if( this.directory.hasOwnProperty(filename) ) {
+  if( this.jarEntries.hasOwnProperty(filename) ) {
+    delete this.jarEntries[filename];
+    --this.numEntries;
+    return true;
+  } else if( this.directory.hasOwnProperty(filename) ) {
     this.directory[filename] = null;
     delete this.directory[filename];
     --this.numEntries;
@@ -52,6 +57,11 @@ FileArchive.prototype.getFileContents = function(filename) {
   log.message(10, "FileArchive::getFileContents<" + filename + ">");
   if( this.directory.hasOwnProperty(filename) ) {
     return this.directory[filename];
+  } else if( this.jarEntries.hasOwnProperty(filename) ) {
+    var contents = this.jarEntries[filename].asText();
+    delete this.jarEntries[filename];
+    this.directory[filename] = contents;
+    return contents;
   } else {
     var fileContents = null;
     if( this.nativeFileArchive !== undefined ) {
@@ -69,14 +79,18 @@ FileArchive.prototype.getFileContents = function(filename) {
   }
 };
 
+FileArchive.prototype.hasEntry = function(filename) {
+  return this.directory.hasOwnProperty(filename) || this.jarEntries.hasOwnProperty(filename);
+};
+
 FileArchive.prototype.addFile = function(filename, contents) {
-  var wasNewFile = true;
-  if( this.directory.hasOwnProperty(filename) ) {
-    wasNewFile = false;
+  var wasNewFile = !this.directory.hasOwnProperty(filename);
+  if( !this.hasEntry(filename) ) {
+    ++this.numEntries;
   }
+  delete this.jarEntries[filename];
 
   this.directory[filename] = contents;
-  ++this.numEntries;
   return wasNewFile;
 };
 
@@ -86,23 +100,28 @@ FileArchive.prototype.loadFromJarData = function(dataBuf) {
   this.loadedJarFile = true;
 };
 
+// Entries are only inflated when they are first read, so an app that
+// ships more files than it imports at startup doesn't pay for all of them
 FileArchive.prototype.processJar = function(jar) {
   for(var file in jar.files) {
     var fileEntry = jar.files[file];
     if( fileEntry.options.dir === true ) {
       continue;
     }
-    this.addArchiveEntry(file, fileEntry.asText());
+    if( !this.hasEntry(file) ) {
+      ++this.numEntries;
+    }
+    delete this.directory[file];
+    this.jarEntries[file] = fileEntry;
   }
 };
 
 FileArchive.prototype.addArchiveEntry = function(filename, data) {
-  ++this.numEntries;
-  this.directory[filename] = data;
+  this.addFile(filename, data);
 };
 
 FileArchive.prototype.hasFileContents = function(filename) {
-  var hasFile = this.directory.hasOwnProperty(filename);
+  var hasFile = this.hasEntry(filename);
   if( hasFile === false ) {
     if (this.nativeFileArchive !== undefined) {
       hasFile = isFileInList(filename, this.nativeFileArchive.fileNames);
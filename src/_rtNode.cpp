@@ -420,13 +420,13 @@ rtNodeContext::~rtNodeContext()
     #endif // ENABLE_NODE_V_6_9
       mEnv = NULL;
       #ifndef USE_CONTEXTIFY_CLONES
-      HandleMap::clearAllForContext(mId);
+      HandleMap::clearAllForContext(mIsolate, mId);
       #endif
     }
     else
     {
     // clear out persistent javascript handles
-      HandleMap::clearAllForContext(mId);
+      HandleMap::clearAllForContext(mIsolate, mId);
 #ifdef ENABLE_NODE_V_6_9
       node::deleteContextifyContext(mContextifyContext);
 #endif
@@ -32,6 +32,7 @@ pxError pxOffscreen::init(int width, int height)
   setHeight(height);
   setStride(width * 4);
   setUpsideDown(false);
+  setPremultiplied(false);
 
   return PX_OK;
 }
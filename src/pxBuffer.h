@@ -59,7 +59,7 @@ class pxBuffer
 {
 public:
 
-pxBuffer(): mPixelFormat(RT_DEFAULT_PIX), mSrcIndexR(0), mSrcIndexG(0), mSrcIndexB(0), mSrcIndexA(0), mDstIndexR(0), mDstIndexG(0), mDstIndexB(0), mDstIndexA(0), mBase(NULL), mWidth(0), mHeight(0), mStride(0), mUpsideDown(false)  {}
+pxBuffer(): mPixelFormat(RT_DEFAULT_PIX), mSrcIndexR(0), mSrcIndexG(0), mSrcIndexB(0), mSrcIndexA(0), mDstIndexR(0), mDstIndexG(0), mDstIndexB(0), mDstIndexA(0), mBase(NULL), mWidth(0), mHeight(0), mStride(0), mUpsideDown(false), mPremultiplied(false)  {}
 
   void* base() const { return mBase; }
   void setBase(void* p) { mBase = p; }
@@ -76,6 +76,10 @@ pxBuffer(): mPixelFormat(RT_DEFAULT_PIX), mSrcIndexR(0), mSrcIndexG(0), mSrcInde
   bool upsideDown() const { return mUpsideDown; }
   void setUpsideDown(bool upsideDown) { mUpsideDown = upsideDown; }
 
+  // True when color is already multiplied by alpha
+  bool premultiplied() const { return mPremultiplied; }
+  void setPremultiplied(bool premultiplied) { mPremultiplied = premultiplied; }
+
   int32_t sizeInBytes() const { return mStride * mHeight; }
 
   inline uint32_t *scanlineInt32(uint32_t line) const
@@ -240,6 +244,7 @@ protected:
   int32_t mHeight;
   int32_t mStride;
   bool mUpsideDown;
+  bool mPremultiplied;
 };
 
 #endif
@@ -25,6 +25,10 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <algorithm>
+#include <list>
+#include <map>
+#include <string>
 #include <stdarg.h>
 #include <png.h>
 
@@ -40,6 +44,15 @@
 
 #include "rtRef.h"
 #include "rtObject.h"
+#include "rtThreadPool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PX_SIMD_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PX_SIMD_NEON 1
+#endif
 
   #include <stdio.h>
   #include <string.h>
@@ -73,9 +86,87 @@ class NSVGrasterizerEx
 
 }; // CLASS;
 
+#define PX_SVG_PARSE_CACHE_SIZE 16  // parsed SVG documents kept for re-rasterizing
+
+// Parsed SVG documents by source, so rasterizing the same source again (at
+// another size, or for another object using it) skips nsvgParse.
+// Least recently used documents are dropped first.  Guarded by rastMutex.
+class NSVGimageCache
+{
+  public:
+      ~NSVGimageCache() { clear(); } // dtor
+
+    NSVGimage *find(const std::string& source)
+    {
+      std::map<std::string, NSVGimage*>::iterator it = mImages.find(source);
+      if (it == mImages.end())
+      {
+        return NULL;
+      }
+      mOrder.remove(it);
+      mOrder.push_back(it);
+      return it->second;
+    }
+
+    void add(const std::string& source, NSVGimage *image)
+    {
+      if (mImages.size() >= PX_SVG_PARSE_CACHE_SIZE)
+      {
+        nsvgDelete(mOrder.front()->second);
+        mImages.erase(mOrder.front());
+        mOrder.pop_front();
+      }
+      mOrder.push_back(mImages.insert(std::make_pair(source, image)).first);
+    }
+
+    void clear()
+    {
+      for (std::map<std::string, NSVGimage*>::iterator it = mImages.begin(); it != mImages.end(); ++it)
+      {
+        nsvgDelete(it->second);
+      }
+      mImages.clear();
+      mOrder.clear();
+    }
+
+  private:
+    std::map<std::string, NSVGimage*> mImages;
+    std::list<std::map<std::string, NSVGimage*>::iterator> mOrder;
+
+}; // CLASS;
+
 static NSVGrasterizerEx rast;
+static NSVGimageCache   svgImages;
 static rtMutex          rastMutex;
 
+#define PX_DECODE_MAX_JPG_SCALE  8  // libjpeg DCT scaling goes down to 1/8
+#define PX_DECODE_MAX_PNG_SCALE 16  // keeps the box filter sums within 32 bits
+
+// Largest reduction factor (up to maxScale) that keeps a srcW x srcH image at
+// least w x h.  A zero target dimension does not constrain the result.
+static int pxDecodeScale(int srcW, int srcH, int32_t w, int32_t h, int maxScale, bool powerOfTwo)
+{
+  int scale = 1;
+
+  if (w <= 0 && h <= 0)
+  {
+    return scale;
+  }
+
+  while (scale < maxScale)
+  {
+    int next = powerOfTwo ? (scale << 1) : (scale + 1);
+
+    if (next > maxScale || (w > 0 && (srcW / next) < w) || (h > 0 && (srcH / next) < h))
+    {
+      break;
+    }
+    scale = next;
+  }
+
+  return scale;
+}
+
 
 // Assume alpha is not premultiplied
 rtError pxLoadImage(const char *imageData, size_t imageDataSize,  pxOffscreen &o,
@@ -89,20 +180,20 @@ rtError pxLoadImage(const char *imageData, size_t imageDataSize,  pxOffscreen &o
   {
     case PX_IMAGE_PNG:
          {
-           retVal = pxLoadPNGImage(imageData, imageDataSize, o);
+           retVal = pxLoadPNGImage(imageData, imageDataSize, o, w, h);
          }
          break;
 
     case PX_IMAGE_JPG:
          {
 #ifdef ENABLE_LIBJPEG_TURBO
-           retVal = pxLoadJPGImageTurbo(imageData, imageDataSize, o);
+           retVal = pxLoadJPGImageTurbo(imageData, imageDataSize, o, w, h);
            if (retVal != RT_OK)
            {
-             retVal = pxLoadJPGImage(imageData, imageDataSize, o);
+             retVal = pxLoadJPGImage(imageData, imageDataSize, o, w, h);
            }
 #else
-        retVal = pxLoadJPGImage(imageData, imageDataSize, o);
+        retVal = pxLoadJPGImage(imageData, imageDataSize, o, w, h);
 #endif //ENABLE_LIBJPEG_TURBO
          }
          break;
@@ -121,7 +212,6 @@ rtError pxLoadImage(const char *imageData, size_t imageDataSize,  pxOffscreen &o
     return retVal;
   }
 
-
   // TODO more sane image type detection and flow
 
   if (o.mPixelFormat != RT_DEFAULT_PIX)
@@ -129,6 +219,24 @@ rtError pxLoadImage(const char *imageData, size_t imageDataSize,  pxOffscreen &o
     o.swizzleTo(RT_DEFAULT_PIX);
   }
 
+  // Finish reducing raster images the decoder could only partly reduce
+  // (interlaced PNG, JPEG past 1/8) so oversize sources are only held once
+  // at about the requested size.
+  if ((imgType == PX_IMAGE_PNG || imgType == PX_IMAGE_JPG) && (w > 0 || h > 0))
+  {
+    int scale = pxDecodeScale(o.width(), o.height(), w, h, PX_DECODE_MAX_PNG_SCALE, false);
+
+    if (scale > 1)
+    {
+      pxOffscreen reduced;
+
+      if (pxReduceImage(o, reduced, scale, scale) == RT_OK)
+      {
+        o = reduced;
+      }
+    }
+  }
+
   return retVal;
 }
 
@@ -174,7 +282,7 @@ rtError pxLoadImage(const char *filename, pxOffscreen &b,
   rtData d;
   rtError e = rtLoadFile(filename, d);
   if (e == RT_OK)
-    return pxLoadImage((const char *)d.data(), d.length(), b);
+    return pxLoadImage((const char *)d.data(), d.length(), b, w, h, sx, sy);
   else
   {
     e = RT_RESOURCE_NOT_FOUND;
@@ -764,7 +872,8 @@ extern "C" {
 #include <turbojpeg.h>
 }
 
-rtError pxLoadJPGImageTurbo(const char *buf, size_t buflen, pxOffscreen &o)
+rtError pxLoadJPGImageTurbo(const char *buf, size_t buflen, pxOffscreen &o,
+                            int32_t w /* = 0 */, int32_t h /* = 0 */)
 {
   rtLogDebug("using pxLoadJPGImageTurbo");
   if (!buf)
@@ -788,6 +897,16 @@ rtError pxLoadJPGImageTurbo(const char *buf, size_t buflen, pxOffscreen &o)
     return RT_FAIL;// TODO : add grayscale support for libjpeg turbo.  falling back to libjpeg for now
   }
 
+  // Let the IDCT produce a reduced image when the caller only needs a small one
+  int scale = pxDecodeScale(width, height, w, h, PX_DECODE_MAX_JPG_SCALE, true);
+  if (scale > 1)
+  {
+    tjscalingfactor factor = {1, scale};
+
+    width  = TJSCALED(width,  factor);
+    height = TJSCALED(height, factor);
+  }
+
   // limit memory usage to resolution 4096x4096
   if (((size_t)width * height) > ((size_t)4096 * 4096))
   {
@@ -848,7 +967,8 @@ rtError pxLoadJPGImageTurbo(const char *buf, size_t buflen, pxOffscreen &o)
 }
 #endif //ENABLE_LIBJPEG_TURBO
 
-rtError pxLoadJPGImage(const char *buf, size_t buflen, pxOffscreen &o)
+rtError pxLoadJPGImage(const char *buf, size_t buflen, pxOffscreen &o,
+                       int32_t w /* = 0 */, int32_t h /* = 0 */)
 {
   if (!buf)
   {
@@ -911,9 +1031,12 @@ rtError pxLoadJPGImage(const char *buf, size_t buflen, pxOffscreen &o)
 
   /* Step 4: set parameters for decompression */
 
-  /* In this example, we don't need to change any of the defaults set by
-   * jpeg_read_header(), so we do nothing here.
+  /* Let the IDCT produce a reduced image when the caller only needs a small
+   * one.  libjpeg rounds the output dimensions up.
    */
+  cinfo.scale_num   = 1;
+  cinfo.scale_denom = pxDecodeScale(cinfo.image_width, cinfo.image_height, w, h,
+                                    PX_DECODE_MAX_JPG_SCALE, true);
 
   /* Step 5: Start decompressor */
 
@@ -1001,7 +1124,8 @@ rtError pxStoreSVGImage(const char* /*filename*/, pxBuffer& /*b*/)  { return RT_
 
 
 rtError pxLoadSVGImage(const char* buf, size_t buflen, pxOffscreen& o, int  w /* = 0    */,      int h /* = 0    */,
-                                                                     float sx /* = 1.0f */,   float sy /* = 1.0f */)
+                                                                     float sx /* = 1.0f */,   float sy /* = 1.0f */,
+                                                                     bool premultiplied /* = false */)
 {
   rtMutexLockGuard  autoLock(rastMutex);
 
@@ -1023,37 +1147,44 @@ rtError pxLoadSVGImage(const char* buf, size_t buflen, pxOffscreen& o, int  w /*
     return RT_FAIL;
   }
 
-  // NOTE:  'nanosvg' is *destructive* to the SVG source buffer
-  //
-  //        Pass it a copy !
-  //
-  void *buf_copy = malloc(buflen);
-  if (NULL == buf_copy)
-  {
-    rtLogError("SVG:  Could not create memory for SVG data .\n");
-    return RT_FAIL;
-  }
-  memcpy(buf_copy, buf, buflen);
-  
-  NSVGimage *image = nsvgParse( (char *) buf_copy, "px", 96.0f); // 96 dpi (suggested default)
-  free(buf_copy); // clean-up
+  std::string source(buf, buflen);
+  NSVGimage *image = svgImages.find(source);
   if (image == NULL)
   {
-    rtLogError("SVG:  Could not init decode SVG.\n");
-    return RT_FAIL;
-  }
+    // NOTE:  'nanosvg' is *destructive* to the SVG source buffer
+    //
+    //        Pass it a copy !
+    //
+    char *buf_copy = (char *) malloc(buflen + 1);
+    if (NULL == buf_copy)
+    {
+      rtLogError("SVG:  Could not create memory for SVG data .\n");
+      return RT_FAIL;
+    }
+    memcpy(buf_copy, buf, buflen);
+    buf_copy[buflen] = 0; // nanosvg expects a terminated string
 
-  int image_w = (int)image->width;  // parsed SVG image dimensions
-  int image_h = (int)image->height; // parsed SVG image dimensions
+    image = nsvgParse( buf_copy, "px", 96.0f); // 96 dpi (suggested default)
+    free(buf_copy); // clean-up
+    if (image == NULL)
+    {
+      rtLogError("SVG:  Could not init decode SVG.\n");
+      return RT_FAIL;
+    }
 
-  if (image_w == 0 || image_h == 0)
-  {
-    nsvgDelete(image);
+    if ((int)image->width == 0 || (int)image->height == 0)
+    {
+      rtLogError("SVG:  Bad image dimensions  WxH: %d x %d\n", (int)image->width, (int)image->height);
+      nsvgDelete(image);
+      return RT_FAIL;
+    }
 
-    rtLogError("SVG:  Bad image dimensions  WxH: %d x %d\n", image_w, image_h);
-    return RT_FAIL;
+    svgImages.add(source, image);
   }
 
+  int image_w = (int)image->width;  // parsed SVG image dimensions
+  int image_h = (int)image->height; // parsed SVG image dimensions
+
   // Dimensions WxH ... *only* if no Scale XY
   if( (sx == 1.0f && sy == 1.0f) && (w > 0 && h > 0) ) // <<< Use WxH only if no scale. Scale takes precedence
   {
@@ -1065,10 +1196,17 @@ rtError pxLoadSVGImage(const char* buf, size_t buflen, pxOffscreen& o, int  w /*
 
   o.initWithColor( (image_w * sx), (image_h * sy), pxClear); // default sized
 
-  nsvgRasterizeFull(rast.getPtr(), image, 0, 0, sx, sy,
-                    (unsigned char*) o.base(), o.width(), o.height(), o.width() *4);
-
-  nsvgDelete(image);
+  if (premultiplied)
+  {
+    nsvgRasterizePremultiplied(rast.getPtr(), image, 0, 0, sx, sy,
+                               (unsigned char*) o.base(), o.width(), o.height(), o.width() *4);
+  }
+  else
+  {
+    nsvgRasterizeFull(rast.getPtr(), image, 0, 0, sx, sy,
+                      (unsigned char*) o.base(), o.width(), o.height(), o.width() *4);
+  }
+  o.setPremultiplied(premultiplied);
 
   return RT_OK;
 }
@@ -1118,8 +1256,208 @@ void readPngData(png_structp pngPtr, png_bytep data, png_size_t length)
   pngStruct->readPosition += length;
 }
 
+// Box filter that reduces 4 channel rows (alpha last) by integer factors
+// as they are decoded, so the full size image is never held in memory.
+// Color is weighted by alpha so transparent pixels don't bleed into edges,
+// unless the rows are already premultiplied.
+struct pxBoxRowFilter
+{
+  pxBoxRowFilter(): mScaleX(1), mScaleY(1), mSrcW(0), mSrcH(0), mDstW(0), mRowsIn(0), mRowOut(0),
+                    mWeighted(true), mSums(NULL), mRow(NULL), mOffscreen(NULL) {}
+  ~pxBoxRowFilter() { term(); }
+
+  bool init(pxOffscreen& o, int srcW, int srcH, int scale)
+  {
+    return init(o, srcW, srcH, scale, scale, false);
+  }
+
+  bool init(pxOffscreen& o, int srcW, int srcH, int scaleX, int scaleY, bool premultiplied)
+  {
+    mScaleX   = scaleX;
+    mScaleY   = scaleY;
+    mSrcW     = srcW;
+    mSrcH     = srcH;
+    mDstW     = (srcW + scaleX - 1) / scaleX;
+    mRowsIn   = mRowOut = 0;
+    mWeighted = !premultiplied;
+    mSums     = (uint32_t *)calloc(mDstW * 4, sizeof(uint32_t));
+    mRow      = (unsigned char *)malloc(srcW * 4);
+
+    if (!mSums || !mRow)
+    {
+      term();
+      return false;
+    }
+
+    mOffscreen = &o;
+    mOffscreen->init(mDstW, (srcH + scaleY - 1) / scaleY);
+    mOffscreen->setPremultiplied(premultiplied);
+    return true;
+  }
+
+  void term()
+  {
+    free(mSums);
+    free(mRow);
+    mSums = NULL;
+    mRow  = NULL;
+  }
+
+  unsigned char* row() { return mRow; }
+
+  void addRow(const unsigned char* src)
+  {
+    uint32_t* sum = mSums;
+    int col = 0;
+
+#if defined(PX_SIMD_SSE2)
+    // one pixel per lane group; 8 bit channels times alpha fit in 16 bits
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+
+    for (const unsigned char* end = src + mSrcW * 4; src < end; src += 4)
+    {
+      int pixel;
+      memcpy(&pixel, src, 4);
+      __m128i p = _mm_unpacklo_epi8(_mm_cvtsi32_si128(pixel), zero);
+      if (mWeighted)
+      {
+        short a = src[3];
+        p = _mm_mullo_epi16(p, _mm_set_epi16(0, 0, 0, 0, 1, a, a, a));
+      }
+      acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(p, zero));
+
+      if (++col == mScaleX)
+      {
+        col = 0;
+        _mm_storeu_si128((__m128i*)sum, _mm_add_epi32(_mm_loadu_si128((const __m128i*)sum), acc));
+        acc = zero;
+        sum += 4;
+      }
+    }
+    if (col)
+    {
+      _mm_storeu_si128((__m128i*)sum, _mm_add_epi32(_mm_loadu_si128((const __m128i*)sum), acc));
+    }
+#elif defined(PX_SIMD_NEON)
+    uint32x4_t acc = vdupq_n_u32(0);
+
+    for (const unsigned char* end = src + mSrcW * 4; src < end; src += 4)
+    {
+      uint32_t pixel;
+      memcpy(&pixel, src, 4);
+      uint16x4_t p = vget_low_u16(vmovl_u8(vcreate_u8(pixel)));
+      if (mWeighted)
+      {
+        uint16x4_t w = vset_lane_u16(1, vdup_n_u16(src[3]), 3);
+        p = vmul_u16(p, w);
+      }
+      acc = vaddw_u16(acc, p);
+
+      if (++col == mScaleX)
+      {
+        col = 0;
+        vst1q_u32(sum, vaddq_u32(vld1q_u32(sum), acc));
+        acc = vdupq_n_u32(0);
+        sum += 4;
+      }
+    }
+    if (col)
+    {
+      vst1q_u32(sum, vaddq_u32(vld1q_u32(sum), acc));
+    }
+#else
+    for (const unsigned char* end = src + mSrcW * 4; src < end; src += 4)
+    {
+      uint32_t a = src[3];
+      uint32_t w = mWeighted ? a : 1;
+
+      sum[0] += src[0] * w;
+      sum[1] += src[1] * w;
+      sum[2] += src[2] * w;
+      sum[3] += a;
+
+      if (++col == mScaleX)
+      {
+        col = 0;
+        sum += 4;
+      }
+    }
+#endif
+
+    if ((++mRowsIn % mScaleY) == 0 || mRowsIn == mSrcH)
+    {
+      flush();
+    }
+  }
+
+private:
+  void flush()
+  {
+    unsigned char* d = (unsigned char *)mOffscreen->scanline(mRowOut);
+    uint32_t rows = mRowsIn - (mRowOut * mScaleY);
+
+    for (int x = 0; x < mDstW; x++, d += 4)
+    {
+      uint32_t* sum  = mSums + (x * 4);
+      uint32_t  cols = (x == mDstW - 1) ? (mSrcW - x * mScaleX) : mScaleX;
+      uint32_t  n    = rows * cols;
+      uint32_t  div  = mWeighted ? sum[3] : n;
+
+      if (div)
+      {
+        d[0] = (sum[0] + div / 2) / div;
+        d[1] = (sum[1] + div / 2) / div;
+        d[2] = (sum[2] + div / 2) / div;
+      }
+      else
+      {
+        d[0] = d[1] = d[2] = 0;
+      }
+      d[3] = (sum[3] + n / 2) / n;
+    }
+
+    memset(mSums, 0, mDstW * 4 * sizeof(uint32_t));
+    mRowOut++;
+  }
+
+  int            mScaleX, mScaleY;
+  int            mSrcW, mSrcH;
+  int            mDstW;
+  int            mRowsIn, mRowOut;
+  bool           mWeighted;
+  uint32_t*      mSums;
+  unsigned char* mRow;
+  pxOffscreen*   mOffscreen;
+};
+
+rtError pxReduceImage(pxOffscreen& src, pxOffscreen& dst, int scaleX, int scaleY,
+                      bool upsideDown /* = false */)
+{
+  if (scaleX < 1 || scaleY < 1 || &src == &dst)
+  {
+    return RT_ERROR_INVALID_ARG;
+  }
+
+  pxBoxRowFilter filter;
+
+  if (!filter.init(dst, src.width(), src.height(), scaleX, scaleY, src.premultiplied()))
+  {
+    rtLogError("pxReduceImage: out of memory reducing %dx%d image", src.width(), src.height());
+    return RT_FAIL;
+  }
+  dst.setUpsideDown(upsideDown);
+
+  for (int y = 0; y < src.height(); y++)
+  {
+    filter.addRow((const unsigned char *)src.scanline(y));
+  }
+
+  return RT_OK;
+}
+
 rtError pxLoadPNGImage(const char *imageData, size_t imageDataSize,
-                       pxOffscreen &o)
+                       pxOffscreen &o, int32_t w /* = 0 */, int32_t h /* = 0 */)
 {
   rtError e = RT_FAIL;
 
@@ -1128,6 +1466,8 @@ rtError pxLoadPNGImage(const char *imageData, size_t imageDataSize,
   //  int number_of_passes;
   png_bytep *row_pointers;
   PngStruct pngStruct((char *)imageData, imageDataSize);
+  pxBoxRowFilter filter;
+  int scale = 1;
 
   if (!imageData)
   {
@@ -1211,13 +1551,40 @@ rtError pxLoadPNGImage(const char *imageData, size_t imageDataSize,
     //png_set_bgr(png_ptr);
     png_set_add_alpha(png_ptr, 0xff, PNG_FILLER_AFTER);
 
-    o.init(width, height);
+    // Interlaced images only yield complete rows on the last pass, so they
+    // are decoded at full size.
+    scale = pxDecodeScale(width, height, w, h, PX_DECODE_MAX_PNG_SCALE, false);
+    if (png_get_interlace_type(png_ptr, info_ptr) != PNG_INTERLACE_NONE)
+    {
+      scale = 1;
+    }
+
+    if (scale == 1)
+    {
+      o.init(width, height);
+    }
 
     //	    number_of_passes = png_set_interlace_handling(png_ptr);
     png_read_update_info(png_ptr, info_ptr);
 
     // read file
-    if (!setjmp(png_jmpbuf(png_ptr)))
+    if (scale > 1)
+    {
+      e = RT_FAIL;
+      if (setjmp(png_jmpbuf(png_ptr)) == 0)
+      {
+        if (filter.init(o, width, height, scale))
+        {
+          for (int y = 0; y < height; y++)
+          {
+            png_read_row(png_ptr, filter.row(), NULL);
+            filter.addRow(filter.row());
+          }
+          e = RT_OK;
+        }
+      }
+    }
+    else if (!setjmp(png_jmpbuf(png_ptr)))
     {
       row_pointers = (png_bytep *)malloc(sizeof(png_bytep) * height);
 
@@ -1254,236 +1621,1098 @@ rtError pxLoadPNGImage(const char *imageData, size_t imageDataSize,
   return e;
 }
 
-void pxTimedOffscreenSequence::init()
+// Streaming decode
+
+enum pxImageStreamStage
 {
-  mTotalTime = 0;
-  mNumPlays = 0;
-  mSequence.clear();
-}
+  PX_STREAM_DETECT,
+  PX_STREAM_PNG,
+  PX_STREAM_JPG_HEADER,
+  PX_STREAM_JPG_START,
+  PX_STREAM_JPG_SCANLINES,
+  PX_STREAM_JPG_FINISH,
+  PX_STREAM_COMPLETE,
+  PX_STREAM_FAILED
+};
 
-void pxTimedOffscreenSequence::addBuffer(pxBuffer &b, double d)
+struct pxImageStreamState
 {
-  entry e;
-  e.mOffscreen.init(b.width(), b.height());
+  pxImageStreamState(pxOffscreen& o, int32_t w, int32_t h)
+    : offscreen(o), targetW(w), targetH(h), stage(PX_STREAM_DETECT), detectSize(0),
+      width(0), height(0), hasDimensions(false),
+      png(NULL), pngInfo(NULL), pngScale(1),
+      jpgCreated(false), jpgRow(NULL), jpgBuffer(NULL), jpgBufferSize(0), jpgSkip(0) {}
+
+  pxOffscreen&       offscreen;
+  int32_t            targetW, targetH;
+  pxImageStreamStage stage;
+
+  // Leading bytes kept until there are enough to identify the format
+  unsigned char      detectBuffer[16];
+  size_t             detectSize;
+
+  int32_t            width, height;
+  bool               hasDimensions;
+
+  png_structp        png;
+  png_infop          pngInfo;
+  int                pngScale;
+  pxBoxRowFilter     pngFilter;
+
+  struct jpeg_decompress_struct jpg;
+  struct my_error_mgr           jpgError;
+  struct jpeg_source_mgr        jpgSource;
+  bool                          jpgCreated;
+  JSAMPARRAY                    jpgRow;
+  // Input libjpeg has not consumed yet; it suspends when this runs dry
+  char*                         jpgBuffer;
+  size_t                        jpgBufferSize;
+  size_t                        jpgSkip;
+};
 
-  b.blit(e.mOffscreen);
+static void pngStreamInfoCallback(png_structp png_ptr, png_infop info_ptr)
+{
+  pxImageStreamState* s = (pxImageStreamState *)png_get_progressive_ptr(png_ptr);
 
-  e.mDuration = d;
+  int width  = png_get_image_width(png_ptr, info_ptr);
+  int height = png_get_image_height(png_ptr, info_ptr);
 
-  mSequence.push_back(e);
-  mTotalTime += d;
-}
+  png_byte color_type = png_get_color_type(png_ptr, info_ptr);
+  png_byte bit_depth  = png_get_bit_depth(png_ptr, info_ptr);
 
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include "png.h"
+  if (bit_depth == 16)
+  {
+    png_set_strip_16(png_ptr);
+  }
 
-//#define PNG_APNG_SUPPORTED
+  if (color_type == PNG_COLOR_TYPE_PALETTE)
+  {
+    png_set_palette_to_rgb(png_ptr);
+  }
 
-#ifdef PNG_APNG_SUPPORTED
-void BlendOver(unsigned char **rows_dst, unsigned char **rows_src, unsigned int x, unsigned int y, unsigned int w, unsigned int h)
-{
-  unsigned int i, j;
-  int u, v, al;
+  if (color_type == PNG_COLOR_TYPE_GRAY ||
+      color_type == PNG_COLOR_TYPE_GRAY_ALPHA)
+  {
+    png_set_gray_to_rgb(png_ptr);
+  }
 
-  for (j = 0; j < h; j++)
+  if (png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS))
   {
-    unsigned char *sp = rows_src[j];
-    unsigned char *dp = rows_dst[j + y] + x * 4;
+    png_set_tRNS_to_alpha(png_ptr);
+  }
 
-    for (i = 0; i < w; i++, sp += 4, dp += 4)
+  png_set_add_alpha(png_ptr, 0xff, PNG_FILLER_AFTER);
+
+  // Interlaced rows only become final on the last pass, so those are
+  // combined at full size
+  s->pngScale = 1;
+  if (png_set_interlace_handling(png_ptr) == 1)
+  {
+    s->pngScale = pxDecodeScale(width, height, s->targetW, s->targetH, PX_DECODE_MAX_PNG_SCALE, false);
+  }
+
+  png_read_update_info(png_ptr, info_ptr);
+
+  if (s->pngScale > 1)
+  {
+    if (!s->pngFilter.init(s->offscreen, width, height, s->pngScale))
     {
-      if (sp[3] == 255)
-        memcpy(dp, sp, 4);
-      else if (sp[3] != 0)
-      {
-        if (dp[3] != 0)
-        {
-          u = sp[3] * 255;
-          v = (255 - sp[3]) * dp[3];
-          al = u + v;
-          dp[0] = (sp[0] * u + dp[0] * v) / al;
-          dp[1] = (sp[1] * u + dp[1] * v) / al;
-          dp[2] = (sp[2] * u + dp[2] * v) / al;
-          dp[3] = al / 255;
-        }
-        else
-          memcpy(dp, sp, 4);
-      }
+      png_error(png_ptr, "out of memory");
     }
   }
+  else
+  {
+    s->offscreen.initWithColor(width, height, pxClear);
+  }
+
+  s->width  = s->offscreen.width();
+  s->height = s->offscreen.height();
+  s->hasDimensions = true;
 }
-#endif
 
-rtError pxLoadAPNGImage(const char *imageData, size_t imageDataSize,
-                        pxTimedOffscreenSequence &s)
+static void pngStreamRowCallback(png_structp png_ptr, png_bytep new_row, png_uint_32 row_num, int /*pass*/)
 {
-  if (!imageData)
+  pxImageStreamState* s = (pxImageStreamState *)png_get_progressive_ptr(png_ptr);
+
+  if (new_row == NULL)
   {
-    rtLogError("FATAL: Invalid arguments - imageData = NULL");
-    return RT_FAIL;
+    return;
   }
 
-  if (imageDataSize < 8)
+  if (s->pngScale > 1)
   {
-    rtLogError("FATAL: Invalid arguments - imageDataSize < 8");
-    return RT_FAIL;
+    s->pngFilter.addRow(new_row);
+  }
+  else
+  {
+    png_progressive_combine_row(png_ptr, (png_bytep)s->offscreen.scanline(row_num), new_row);
   }
+}
 
-  s.init();
+static void pngStreamEndCallback(png_structp png_ptr, png_infop /*info_ptr*/)
+{
+  pxImageStreamState* s = (pxImageStreamState *)png_get_progressive_ptr(png_ptr);
 
-  PngStruct pngStruct((char *)imageData, imageDataSize);
+  s->offscreen.mPixelFormat = RT_PIX_RGBA;
+  s->stage = PX_STREAM_COMPLETE;
+}
 
-  unsigned char header[8]; // 8 is the maximum size that can be checked
+METHODDEF(void) jpgStreamInitSource(j_decompress_ptr /*cinfo*/) {}
+METHODDEF(void) jpgStreamTermSource(j_decompress_ptr /*cinfo*/) {}
 
-  // test for it being a png
-  memcpy(header, imageData, 8);
-  pngStruct.readPosition += 8;
+// Returning FALSE suspends the decoder until more data is fed
+METHODDEF(boolean) jpgStreamFillInputBuffer(j_decompress_ptr /*cinfo*/)
+{
+  return FALSE;
+}
 
-  // test PNG header
-  if (png_sig_cmp(header, 0, 8) != 0)
+METHODDEF(void) jpgStreamSkipInputData(j_decompress_ptr cinfo, long num_bytes)
+{
+  pxImageStreamState* s = (pxImageStreamState *)cinfo->client_data;
+  struct jpeg_source_mgr* src = cinfo->src;
+
+  if (num_bytes <= 0)
   {
-    // TODO Improve Detection of different image types
-    //    rtLogError("FATAL: Invalid PNG header");
+    return;
+  }
+
+  if ((size_t)num_bytes > src->bytes_in_buffer)
+  {
+    // Drop the remainder from data that hasn't arrived yet
+    s->jpgSkip += (size_t)num_bytes - src->bytes_in_buffer;
+    src->next_input_byte += src->bytes_in_buffer;
+    src->bytes_in_buffer = 0;
+  }
+  else
+  {
+    src->next_input_byte += num_bytes;
+    src->bytes_in_buffer -= num_bytes;
+  }
+}
+
+static rtError pngStreamFeed(pxImageStreamState* s, const char* data, size_t size)
+{
+  if (setjmp(png_jmpbuf(s->png)))
+  {
+    s->stage = PX_STREAM_FAILED;
+    return RT_FAIL;
+  }
+
+  png_process_data(s->png, s->pngInfo, (png_bytep)data, size);
+  return RT_OK;
+}
+
+static rtError jpgStreamFeed(pxImageStreamState* s, const char* data, size_t size)
+{
+  struct jpeg_source_mgr* src = &s->jpgSource;
+
+  if (s->jpgSkip > 0)
+  {
+    size_t skip = (s->jpgSkip < size) ? s->jpgSkip : size;
+
+    s->jpgSkip -= skip;
+    data += skip;
+    size -= skip;
+  }
+
+  // Keep what libjpeg hasn't consumed and append the new data after it
+  size_t unconsumed = src->bytes_in_buffer;
+
+  if (unconsumed > 0 && src->next_input_byte != (const JOCTET *)s->jpgBuffer)
+  {
+    memmove(s->jpgBuffer, src->next_input_byte, unconsumed);
+  }
+
+  char* buffer = (char *)realloc(s->jpgBuffer, unconsumed + size + 1);
+
+  if (!buffer)
+  {
+    s->stage = PX_STREAM_FAILED;
     return RT_FAIL;
   }
 
-  //unsigned int width, height, channels, rowbytes, size, i, j;
-  unsigned int width, height, i, j;
+  memcpy(buffer + unconsumed, data, size);
+  s->jpgBuffer     = buffer;
+  s->jpgBufferSize = unconsumed + size;
 
-  unsigned long size, rowbytes;
+  src->next_input_byte = (const JOCTET *)s->jpgBuffer;
+  src->bytes_in_buffer = s->jpgBufferSize;
 
-  png_bytepp rows_image;
-  png_bytepp rows_frame;
-  unsigned char *p_image;
-  unsigned char *p_frame;
-  unsigned char *p_temp;
+  if (setjmp(s->jpgError.setjmp_buffer))
+  {
+    s->stage = PX_STREAM_FAILED;
+    return RT_FAIL;
+  }
 
-  png_structp png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-  png_infop info_ptr = png_create_info_struct(png_ptr);
-  if (png_ptr && info_ptr)
+  if (s->stage == PX_STREAM_JPG_HEADER)
   {
-    if (setjmp(png_jmpbuf(png_ptr)))
+    if (jpeg_read_header(&s->jpg, TRUE) == JPEG_SUSPENDED)
     {
-      png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
-      return RT_FAIL;
+      return RT_OK;
     }
 
-    png_set_read_fn(png_ptr, (png_voidp)&pngStruct, readPngData);
-    png_set_sig_bytes(png_ptr, 8);
-    png_read_info(png_ptr, info_ptr);
-    png_set_expand(png_ptr);
-    png_set_strip_16(png_ptr);
-    png_set_palette_to_rgb(png_ptr);
-    png_set_gray_to_rgb(png_ptr);
-    png_set_add_alpha(png_ptr, 0xff, PNG_FILLER_AFTER);
-    (void)png_set_interlace_handling(png_ptr);
-    png_read_update_info(png_ptr, info_ptr);
-    width = png_get_image_width(png_ptr, info_ptr);
-    height = png_get_image_height(png_ptr, info_ptr);
-    //channels = png_get_channels(png_ptr, info_ptr);
-    rowbytes = png_get_rowbytes(png_ptr, info_ptr);
-    size = height * rowbytes;
-    p_image = (unsigned char *)malloc(size);
-    p_frame = (unsigned char *)malloc(size);
-    p_temp = (unsigned char *)malloc(size);
-    rows_image = (png_bytepp)malloc(height * sizeof(png_bytep));
-    rows_frame = (png_bytepp)malloc(height * sizeof(png_bytep));
-    if (p_image && p_frame && p_temp && rows_image && rows_frame)
+    s->jpg.out_color_space = JCS_RGB;
+    s->jpg.scale_num       = 1;
+    s->jpg.scale_denom     = pxDecodeScale(s->jpg.image_width, s->jpg.image_height,
+                                           s->targetW, s->targetH, PX_DECODE_MAX_JPG_SCALE, true);
+    jpeg_calc_output_dimensions(&s->jpg);
+
+    s->width  = s->jpg.output_width;
+    s->height = s->jpg.output_height;
+    s->hasDimensions = true;
+    s->stage  = PX_STREAM_JPG_START;
+  }
+
+  if (s->stage == PX_STREAM_JPG_START)
+  {
+    // Progressive JPEGs consume all of their scans in here before
+    // the first scanline is available
+    if (!jpeg_start_decompress(&s->jpg))
     {
-      png_uint_32 frames = 1;
-      png_uint_32 x0 = 0;
-      png_uint_32 y0 = 0;
-      png_uint_32 w0 = width;
-      png_uint_32 h0 = height;
-      unsigned int first = 0;
-      unsigned short delay_num = 1;
-      unsigned short delay_den = 10;
+      return RT_OK;
+    }
 
-#ifdef PNG_APNG_SUPPORTED
-      png_uint_32 plays = 0;
-      unsigned char dop = 0;
-      unsigned char bop = 0;
+    s->jpgRow = (*s->jpg.mem->alloc_sarray)((j_common_ptr)&s->jpg, JPOOL_IMAGE,
+                                             s->jpg.output_width * s->jpg.output_components, 1);
+    s->offscreen.init(s->jpg.output_width, s->jpg.output_height);
+    s->stage = PX_STREAM_JPG_SCANLINES;
+  }
 
-      first = (png_get_first_frame_is_hidden(png_ptr, info_ptr) != 0) ? 1 : 0;
-      if (png_get_valid(png_ptr, info_ptr, PNG_INFO_acTL))
-        png_get_acTL(png_ptr, info_ptr, &frames, &plays);
+  if (s->stage == PX_STREAM_JPG_SCANLINES)
+  {
+    while (s->jpg.output_scanline < s->jpg.output_height)
+    {
+      int y = s->jpg.output_scanline;
 
-      s.setNumPlays(plays);
-#endif
-      for (j = 0; j < height; j++)
-        rows_image[j] = p_image + j * rowbytes;
+      if (jpeg_read_scanlines(&s->jpg, s->jpgRow, 1) == 0)
+      {
+        return RT_OK;
+      }
 
-      for (j = 0; j < height; j++)
-        rows_frame[j] = p_frame + j * rowbytes;
+      pxPixel *p = s->offscreen.scanline(y);
+      unsigned char *b = (unsigned char *)s->jpgRow[0];
+      unsigned char *bend = b + (s->jpg.output_width * 3);
 
-      for (i = 0; i < frames; i++)
+      while (b < bend)
       {
-#ifdef PNG_APNG_SUPPORTED
-        if (png_get_valid(png_ptr, info_ptr, PNG_INFO_acTL))
+        p->r = b[0];
+        p->g = b[1];
+        p->b = b[2];
+        p->a = 255;
+        b += 3;
+        p++;
+      }
+    }
+    s->stage = PX_STREAM_JPG_FINISH;
+  }
+
+  if (s->stage == PX_STREAM_JPG_FINISH)
+  {
+    if (!jpeg_finish_decompress(&s->jpg))
+    {
+      return RT_OK;
+    }
+
+    s->offscreen.mPixelFormat = RT_PIX_ARGB;
+    s->stage = PX_STREAM_COMPLETE;
+  }
+
+  return RT_OK;
+}
+
+static rtError streamFeed(pxImageStreamState* s, const char* data, size_t size)
+{
+  rtError e = (s->stage == PX_STREAM_PNG) ? pngStreamFeed(s, data, size) : jpgStreamFeed(s, data, size);
+
+  if (s->stage == PX_STREAM_COMPLETE && s->offscreen.mPixelFormat != RT_DEFAULT_PIX)
+  {
+    s->offscreen.swizzleTo(RT_DEFAULT_PIX);
+  }
+
+  return e;
+}
+
+pxImageStreamDecoder::pxImageStreamDecoder(pxOffscreen& o, int32_t w /* = 0 */, int32_t h /* = 0 */)
+  : mState(new pxImageStreamState(o, w, h))
+{
+}
+
+pxImageStreamDecoder::~pxImageStreamDecoder()
+{
+  if (mState->png)
+  {
+    png_destroy_read_struct(&mState->png, &mState->pngInfo, NULL);
+  }
+
+  if (mState->jpgCreated)
+  {
+    jpeg_destroy_decompress(&mState->jpg);
+  }
+
+  free(mState->jpgBuffer);
+  delete mState;
+}
+
+rtError pxImageStreamDecoder::feed(const char* data, size_t size)
+{
+  pxImageStreamState* s = mState;
+
+  if (s->stage == PX_STREAM_FAILED)
+  {
+    return RT_FAIL;
+  }
+
+  if (s->stage == PX_STREAM_COMPLETE || size == 0)
+  {
+    return RT_OK;
+  }
+
+  if (s->stage == PX_STREAM_DETECT)
+  {
+    size_t n = sizeof(s->detectBuffer) - s->detectSize;
+
+    n = (n < size) ? n : size;
+    memcpy(s->detectBuffer + s->detectSize, data, n);
+    s->detectSize += n;
+    data += n;
+    size -= n;
+
+    if (s->detectSize < sizeof(s->detectBuffer))
+    {
+      return RT_OK;
+    }
+
+    switch (getImageType(s->detectBuffer, s->detectSize))
+    {
+      case PX_IMAGE_PNG:
+        s->png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+        s->pngInfo = s->png ? png_create_info_struct(s->png) : NULL;
+
+        if (!s->pngInfo)
         {
-          png_read_frame_head(png_ptr, info_ptr);
-          png_get_next_frame_fcTL(png_ptr, info_ptr, &w0, &h0, &x0, &y0, &delay_num, &delay_den, &dop, &bop);
+          s->stage = PX_STREAM_FAILED;
+          return RT_FAIL;
+        }
 
-          if (!delay_den)
-            delay_den = 100;
+        png_set_progressive_read_fn(s->png, (png_voidp)s, pngStreamInfoCallback,
+                                    pngStreamRowCallback, pngStreamEndCallback);
+        s->stage = PX_STREAM_PNG;
+        break;
+
+      case PX_IMAGE_JPG:
+        s->jpg.err = jpeg_std_error(&s->jpgError.pub);
+        s->jpgError.pub.error_exit = my_error_exit;
+
+        if (setjmp(s->jpgError.setjmp_buffer))
+        {
+          s->stage = PX_STREAM_FAILED;
+          return RT_FAIL;
         }
-        if (i == first)
+
+        jpeg_create_decompress(&s->jpg);
+        s->jpgCreated      = true;
+        s->jpg.client_data = s;
+
+        s->jpgSource.init_source       = jpgStreamInitSource;
+        s->jpgSource.fill_input_buffer = jpgStreamFillInputBuffer;
+        s->jpgSource.skip_input_data   = jpgStreamSkipInputData;
+        s->jpgSource.resync_to_restart = jpeg_resync_to_restart;
+        s->jpgSource.term_source       = jpgStreamTermSource;
+        s->jpgSource.next_input_byte   = NULL;
+        s->jpgSource.bytes_in_buffer   = 0;
+        s->jpg.src = &s->jpgSource;
+
+        s->stage = PX_STREAM_JPG_HEADER;
+        break;
+
+      default:
+        s->stage = PX_STREAM_FAILED;
+        return RT_FAIL;
+    }
+
+    rtError e = streamFeed(s, (const char *)s->detectBuffer, s->detectSize);
+
+    if (e != RT_OK || size == 0)
+    {
+      return e;
+    }
+  }
+
+  return streamFeed(s, data, size);
+}
+
+bool pxImageStreamDecoder::hasDimensions() const
+{
+  return mState->hasDimensions;
+}
+
+int32_t pxImageStreamDecoder::width() const
+{
+  return mState->width;
+}
+
+int32_t pxImageStreamDecoder::height() const
+{
+  return mState->height;
+}
+
+bool pxImageStreamDecoder::isComplete() const
+{
+  return mState->stage == PX_STREAM_COMPLETE;
+}
+
+bool pxImageStreamDecoder::failed() const
+{
+  return mState->stage == PX_STREAM_FAILED;
+}
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "png.h"
+
+//#define PNG_APNG_SUPPORTED
+
+#ifdef PNG_APNG_SUPPORTED
+void BlendOver(unsigned char **rows_dst, unsigned char **rows_src, unsigned int x, unsigned int y, unsigned int w, unsigned int h)
+{
+  unsigned int i, j;
+  int u, v, al;
+
+  for (j = 0; j < h; j++)
+  {
+    unsigned char *sp = rows_src[j];
+    unsigned char *dp = rows_dst[j + y] + x * 4;
+
+    for (i = 0; i < w; i++, sp += 4, dp += 4)
+    {
+      if (sp[3] == 255)
+        memcpy(dp, sp, 4);
+      else if (sp[3] != 0)
+      {
+        if (dp[3] != 0)
         {
-          bop = PNG_BLEND_OP_SOURCE;
-          if (dop == PNG_DISPOSE_OP_PREVIOUS)
-            dop = PNG_DISPOSE_OP_BACKGROUND;
+          u = sp[3] * 255;
+          v = (255 - sp[3]) * dp[3];
+          al = u + v;
+          dp[0] = (sp[0] * u + dp[0] * v) / al;
+          dp[1] = (sp[1] * u + dp[1] * v) / al;
+          dp[2] = (sp[2] * u + dp[2] * v) / al;
+          dp[3] = al / 255;
         }
+        else
+          memcpy(dp, sp, 4);
+      }
+    }
+  }
+}
 #endif
-        png_read_image(png_ptr, rows_frame);
+
+#define PX_APNG_LOOK_AHEAD 3  // decoded frames kept per cursor
+
+// Frame control values of one APNG frame, from its fcTL chunk
+struct pxAPNGFrameInfo
+{
+  uint32_t x, y, w, h;
+  uint16_t delayNum, delayDen;
+  uint8_t dispose, blend;
+};
+
+// The compressed file and its frame table, shared read-only by the sequence
+// and its cursors
+struct pxAPNGFile
+{
+  pxAPNGFile(): refCount(1), animated(false), first(0), width(0), height(0) {}
+
+  void addRef() { rtAtomicInc(&refCount); }
+  void release()
+  {
+    if (rtAtomicDec(&refCount) == 0)
+      delete this;
+  }
+
+  rtAtomic refCount;
+  rtData data;
+  bool animated;
+  uint32_t first;  // 1 when the default image is not part of the animation
+  uint32_t width, height;
+  std::vector<pxAPNGFrameInfo> frames;
+};
+
+// libpng state of one forward pass through a pxAPNGFile
+struct pxAPNGDecodeState
+{
+  pxAPNGDecodeState(pxAPNGFile *f): file(f), readPosition(0),
+                       png_ptr(NULL), info_ptr(NULL), rowbytes(0), p_image(NULL), p_frame(NULL),
+                       p_temp(NULL), rows_image(NULL), rows_frame(NULL), nextFrame(0), failed(false)
+  {
+    file->addRef();
+    for (int i = 0; i < PX_APNG_LOOK_AHEAD; i++)
+      ringFrame[i] = -1;
+  }
+
+  pxAPNGFile *file;
+  size_t readPosition;
+
+  png_structp png_ptr;
+  png_infop info_ptr;
+  size_t rowbytes;
+  unsigned char *p_image;
+  unsigned char *p_frame;
+  unsigned char *p_temp;
+  png_bytepp rows_image;
+  png_bytepp rows_frame;
+  uint32_t nextFrame;  // next frame in the file, counting a hidden default image
+  bool failed;
+
+  // Decoded frames, owned by a cursor; -1 while empty or being written
+  pxOffscreen ring[PX_APNG_LOOK_AHEAD];
+  int64_t ringFrame[PX_APNG_LOOK_AHEAD];
+};
+
+static uint32_t pngUint32(const unsigned char *p)
+{
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// Walks the chunk list without decoding to get the canvas size, play count
+// and frame table.  A PNG without acTL is a single frame.
+static bool pxScanAPNG(pxAPNGFile *s, uint32_t &plays)
+{
+  const unsigned char *data = s->data.data();
+  size_t size = s->data.length();
+  bool haveIDAT = false;
+  bool fcTLBeforeIDAT = false;
+
+  plays = 0;
+  for (size_t pos = 8; pos + 12 <= size;)
+  {
+    uint32_t length = pngUint32(data + pos);
+    const unsigned char *type = data + pos + 4;
+    const unsigned char *chunk = data + pos + 8;
+
+    if (length > size - pos - 12)
+      return false;
+
+    if (memcmp(type, "IHDR", 4) == 0 && length >= 8)
+    {
+      s->width = pngUint32(chunk);
+      s->height = pngUint32(chunk + 4);
+    }
+    else if (memcmp(type, "acTL", 4) == 0 && length >= 8)
+    {
+      s->animated = true;
+      plays = pngUint32(chunk + 4);
+    }
+    else if (memcmp(type, "fcTL", 4) == 0 && length >= 26)
+    {
+      pxAPNGFrameInfo f;
+      f.w = pngUint32(chunk + 4);
+      f.h = pngUint32(chunk + 8);
+      f.x = pngUint32(chunk + 12);
+      f.y = pngUint32(chunk + 16);
+      f.delayNum = (chunk[20] << 8) | chunk[21];
+      f.delayDen = (chunk[22] << 8) | chunk[23];
+      f.dispose = chunk[24];
+      f.blend = chunk[25];
+      if (f.w == 0 || f.h == 0 || f.x > s->width || f.y > s->height ||
+          f.w > s->width - f.x || f.h > s->height - f.y)
+        return false;
+      s->frames.push_back(f);
+      if (!haveIDAT)
+        fcTLBeforeIDAT = true;
+    }
+    else if (memcmp(type, "IDAT", 4) == 0)
+    {
+      haveIDAT = true;
+    }
+    else if (memcmp(type, "IEND", 4) == 0)
+    {
+      break;
+    }
+    pos += length + 12;
+  }
+
+  if (!haveIDAT || s->width == 0 || s->height == 0)
+    return false;
+
+  if (!s->animated || s->frames.empty())
+  {
+    pxAPNGFrameInfo f = { 0, 0, s->width, s->height, 1, 10, 0, 0 };
+    s->animated = false;
+    s->frames.clear();
+    s->frames.push_back(f);
+  }
+  s->first = (s->animated && !fcTLBeforeIDAT) ? 1 : 0;
+  return true;
+}
+
+static void readAPNGData(png_structp pngPtr, png_bytep data, png_size_t length)
+{
+  pxAPNGDecodeState *s = (pxAPNGDecodeState *)png_get_io_ptr(pngPtr);
+
+  if (length > s->file->data.length() - s->readPosition)
+    png_error(pngPtr, "read past end of APNG data");
+
+  memcpy((char *)data, s->file->data.data() + s->readPosition, length);
+  s->readPosition += length;
+}
+
+static void pxAPNGClose(pxAPNGDecodeState *s)
+{
+  if (s->png_ptr)
+    png_destroy_read_struct(&s->png_ptr, &s->info_ptr, NULL);
+  s->png_ptr = NULL;
+  s->info_ptr = NULL;
+  SAFE_FREE(s->rows_frame);
+  SAFE_FREE(s->rows_image);
+  SAFE_FREE(s->p_temp);
+  SAFE_FREE(s->p_frame);
+  SAFE_FREE(s->p_image);
+  s->nextFrame = 0;
+}
+
+static void pxAPNGDestroy(pxAPNGDecodeState *s)
+{
+  pxAPNGClose(s);
+  s->file->release();
+  delete s;
+}
+
+static bool pxAPNGOpen(pxAPNGDecodeState *s)
+{
+  pxAPNGClose(s);
+
+  s->png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+  s->info_ptr = s->png_ptr ? png_create_info_struct(s->png_ptr) : NULL;
+  if (!s->png_ptr || !s->info_ptr)
+  {
+    pxAPNGClose(s);
+    return false;
+  }
+
+  if (setjmp(png_jmpbuf(s->png_ptr)))
+  {
+    pxAPNGClose(s);
+    return false;
+  }
+
+  s->readPosition = 8;
+  png_set_read_fn(s->png_ptr, (png_voidp)s, readAPNGData);
+  png_set_sig_bytes(s->png_ptr, 8);
+  png_read_info(s->png_ptr, s->info_ptr);
+  png_set_expand(s->png_ptr);
+  png_set_strip_16(s->png_ptr);
+  png_set_palette_to_rgb(s->png_ptr);
+  png_set_gray_to_rgb(s->png_ptr);
+  png_set_add_alpha(s->png_ptr, 0xff, PNG_FILLER_AFTER);
+  (void)png_set_interlace_handling(s->png_ptr);
+  png_read_update_info(s->png_ptr, s->info_ptr);
+
+  if (png_get_image_width(s->png_ptr, s->info_ptr) != s->file->width ||
+      png_get_image_height(s->png_ptr, s->info_ptr) != s->file->height)
+  {
+    pxAPNGClose(s);
+    return false;
+  }
+
+  uint32_t height = s->file->height;
+  s->rowbytes = png_get_rowbytes(s->png_ptr, s->info_ptr);
+  size_t size = height * s->rowbytes;
+  s->p_image = (unsigned char *)calloc(size, 1);
+  s->p_frame = (unsigned char *)malloc(size);
+  s->rows_image = (png_bytepp)malloc(height * sizeof(png_bytep));
+  s->rows_frame = (png_bytepp)malloc(height * sizeof(png_bytep));
+  if (!s->p_image || !s->p_frame || !s->rows_image || !s->rows_frame)
+  {
+    pxAPNGClose(s);
+    return false;
+  }
+
+  for (uint32_t j = 0; j < height; j++)
+  {
+    s->rows_image[j] = s->p_image + j * s->rowbytes;
+    s->rows_frame[j] = s->p_frame + j * s->rowbytes;
+  }
+  return true;
+}
+
+// Reads the next frame in the file and composites it onto the canvas.  The
+// result is copied to o (if given) before the frame's dispose op is applied.
+static bool pxAPNGReadFrame(pxAPNGDecodeState *s, pxOffscreen *o)
+{
+  if (setjmp(png_jmpbuf(s->png_ptr)))
+  {
+    pxAPNGClose(s);
+    return false;
+  }
+
+  uint32_t width = s->file->width;
+  uint32_t height = s->file->height;
+  png_uint_32 x0 = 0;
+  png_uint_32 y0 = 0;
+  png_uint_32 w0 = width;
+  png_uint_32 h0 = height;
+  uint32_t j;
 
 #ifdef PNG_APNG_SUPPORTED
-        if (dop == PNG_DISPOSE_OP_PREVIOUS)
-          memcpy(p_temp, p_image, size);
+  unsigned char dop = 0;
+  unsigned char bop = 0;
+  if (s->file->animated)
+  {
+    unsigned short delay_num, delay_den;
+    png_read_frame_head(s->png_ptr, s->info_ptr);
+    if (s->nextFrame >= s->file->first)
+      png_get_next_frame_fcTL(s->png_ptr, s->info_ptr, &w0, &h0, &x0, &y0, &delay_num, &delay_den, &dop, &bop);
+  }
+  if (s->nextFrame == s->file->first)
+  {
+    bop = PNG_BLEND_OP_SOURCE;
+    if (dop == PNG_DISPOSE_OP_PREVIOUS)
+      dop = PNG_DISPOSE_OP_BACKGROUND;
+  }
+#endif
+  if (x0 > width || y0 > height || w0 > width - x0 || h0 > height - y0)
+    png_error(s->png_ptr, "APNG frame outside of canvas");
 
-        if (bop == PNG_BLEND_OP_OVER)
-          BlendOver(rows_image, rows_frame, x0, y0, w0, h0);
-        else
+  png_read_image(s->png_ptr, s->rows_frame);
+
+  // The hidden default image only has to be consumed
+  if (s->nextFrame >= s->file->first)
+  {
+#ifdef PNG_APNG_SUPPORTED
+    if (dop == PNG_DISPOSE_OP_PREVIOUS)
+    {
+      if (!s->p_temp)
+        s->p_temp = (unsigned char *)malloc(height * s->rowbytes);
+      if (!s->p_temp)
+        png_error(s->png_ptr, "out of memory");
+      memcpy(s->p_temp, s->p_image, height * s->rowbytes);
+    }
+
+    if (bop == PNG_BLEND_OP_OVER)
+      BlendOver(s->rows_image, s->rows_frame, x0, y0, w0, h0);
+    else
 #endif
-          for (j = 0; j < h0; j++)
-            memcpy(rows_image[j + y0] + x0 * 4, rows_frame[j], w0 * 4);
+      for (j = 0; j < h0; j++)
+        memcpy(s->rows_image[j + y0] + x0 * 4, s->rows_frame[j], w0 * 4);
 
-        // TODO Extra copy of frame going on here
-        if (i >= first)
-        {
-          pxOffscreen o;
-          o.init(width, height);
-          for (uint32_t i = 0; i < height; i++)
-          {
-            memcpy(o.scanline(i), rows_image[i], width * 4);
-          }
-          s.addBuffer(o, (double)delay_num / (double)delay_den);
-        }
+    if (o)
+    {
+      o->init(width, height);
+      for (j = 0; j < height; j++)
+        memcpy((void *)o->scanline(j), s->rows_image[j], width * 4);
+    }
 
 #ifdef PNG_APNG_SUPPORTED
-        if (dop == PNG_DISPOSE_OP_PREVIOUS)
-          memcpy(p_image, p_temp, size);
-        else if (dop == PNG_DISPOSE_OP_BACKGROUND)
-          for (j = 0; j < h0; j++)
-            memset(rows_image[j + y0] + x0 * 4, 0, w0 * 4);
+    if (dop == PNG_DISPOSE_OP_PREVIOUS)
+      memcpy(s->p_image, s->p_temp, height * s->rowbytes);
+    else if (dop == PNG_DISPOSE_OP_BACKGROUND)
+      for (j = 0; j < h0; j++)
+        memset(s->rows_image[j + y0] + x0 * 4, 0, w0 * 4);
 #endif
-      }
-      png_read_end(png_ptr, info_ptr);
+  }
+
+  s->nextFrame++;
+  if (s->nextFrame >= s->file->frames.size() + s->file->first)
+    pxAPNGClose(s);  // restarted from the top on the next loop
+  return true;
+}
 
+// Decodes forward (restarting the file if needed) until frameNum, which is
+// copied to o
+static bool pxAPNGDecodeTo(pxAPNGDecodeState *s, uint32_t frameNum, pxOffscreen *o)
+{
+  uint32_t target = frameNum + s->file->first;
+
+  if ((s->png_ptr == NULL || s->nextFrame > target) && !pxAPNGOpen(s))
+    return false;
+
+  while (s->png_ptr != NULL && s->nextFrame <= target)
+  {
+    bool last = (s->nextFrame == target);
+    if (!pxAPNGReadFrame(s, last ? o : NULL))
+    {
+      rtLogError("pxAPNGDecodeTo() - failed to decode frame %u", frameNum);
+      return false;
     }
+    if (last)
+      return true;
+  }
+  return false;
+}
 
-    free(rows_frame);
-    free(rows_image);
-    free(p_temp);
-    free(p_frame);
-    free(p_image);
+pxTimedOffscreenSequence::~pxTimedOffscreenSequence()
+{
+  init();
+}
+
+void pxTimedOffscreenSequence::init()
+{
+  mTotalTime = 0;
+  mNumPlays = 0;
+  mWidth = 0;
+  mHeight = 0;
+  mSequence.clear();
+  if (mFile)
+  {
+    mFile->release();
+    mFile = NULL;
   }
-  png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+}
+
+void pxTimedOffscreenSequence::addBuffer(pxBuffer &b, double d)
+{
+  entry e;
+  e.mOffscreen.init(b.width(), b.height());
+
+  b.blit(e.mOffscreen);
 
+  e.mDuration = d;
+  e.mDirtyX = e.mDirtyY = 0;
+  e.mDirtyW = b.width();
+  e.mDirtyH = b.height();
+
+  if (mSequence.empty())
+  {
+    mWidth = b.width();
+    mHeight = b.height();
+  }
+  mSequence.push_back(e);
+  mTotalTime += d;
+}
+
+rtError pxTimedOffscreenSequence::initAPNG(const char *imageData, size_t imageDataSize)
+{
+  init();
+
+  uint32_t plays;
+  mFile = new pxAPNGFile;
+  mFile->data.init((const uint8_t *)imageData, imageDataSize);
+  if (!pxScanAPNG(mFile, plays))
+  {
+    init();
+    return RT_FAIL;
+  }
+
+  mWidth = mFile->width;
+  mHeight = mFile->height;
+  setNumPlays(plays);
+
+  for (uint32_t i = 0; i < mFile->frames.size(); i++)
+  {
+    const pxAPNGFrameInfo &f = mFile->frames[i];
+    entry e;
+    e.mDuration = (double)f.delayNum / (double)(f.delayDen ? f.delayDen : 100);
+
+    // A frame changes its own area plus whatever the previous one disposed of
+    int32_t l = f.x, t = f.y, r = f.x + f.w, b = f.y + f.h;
+    if (i == 0)
+    {
+      l = t = 0;
+      r = mWidth;
+      b = mHeight;
+    }
+    else if (mFile->frames[i - 1].dispose != 0)
+    {
+      const pxAPNGFrameInfo &p = mFile->frames[i - 1];
+      l = std::min<int32_t>(l, p.x);
+      t = std::min<int32_t>(t, p.y);
+      r = std::max<int32_t>(r, p.x + p.w);
+      b = std::max<int32_t>(b, p.y + p.h);
+    }
+    e.mDirtyX = l;
+    e.mDirtyY = t;
+    e.mDirtyW = r - l;
+    e.mDirtyH = b - t;
+
+    mSequence.push_back(e);
+    mTotalTime += e.mDuration;
+  }
+
+  // The first frame is shared by every cursor; decoding it here also
+  // catches broken files at load time
+  pxAPNGDecodeState *decoder = new pxAPNGDecodeState(mFile);
+  bool decoded = pxAPNGDecodeTo(decoder, 0, &mSequence[0].mOffscreen);
+  pxAPNGDestroy(decoder);
+  if (!decoded)
+  {
+    init();
+    return RT_FAIL;
+  }
   return RT_OK;
 }
 
+bool pxTimedOffscreenSequence::dirtyRect(uint32_t from, uint32_t to, int32_t& x, int32_t& y, int32_t& w, int32_t& h)
+{
+  if (from >= to || to >= mSequence.size())
+  {
+    return false;
+  }
+
+  int32_t l = mSequence[to].mDirtyX;
+  int32_t t = mSequence[to].mDirtyY;
+  int32_t r = l + mSequence[to].mDirtyW;
+  int32_t b = t + mSequence[to].mDirtyH;
+  for (uint32_t i = from + 1; i < to; i++)
+  {
+    const entry &e = mSequence[i];
+    l = std::min(l, e.mDirtyX);
+    t = std::min(t, e.mDirtyY);
+    r = std::max(r, e.mDirtyX + e.mDirtyW);
+    b = std::max(b, e.mDirtyY + e.mDirtyH);
+  }
+  x = l;
+  y = t;
+  w = r - l;
+  h = b - t;
+  return true;
+}
+
+pxTimedOffscreenCursor::pxTimedOffscreenCursor(pxTimedOffscreenSequence& s)
+  : mSequence(s), mNumFrames(s.numFrames()), mDecoder(NULL), mCurrent(0), mDecoding(false),
+    mMutex(), mRefCount(0)
+{
+  if (s.mFile != NULL && s.mSequence.size() > 1)
+  {
+    mDecoder = new pxAPNGDecodeState(s.mFile);
+  }
+}
+
+pxTimedOffscreenCursor::~pxTimedOffscreenCursor()
+{
+  if (mDecoder != NULL)
+  {
+    pxAPNGDestroy(mDecoder);
+  }
+}
+
+unsigned long pxTimedOffscreenCursor::AddRef()
+{
+  return rtAtomicInc(&mRefCount);
+}
+
+unsigned long pxTimedOffscreenCursor::Release()
+{
+  long l = rtAtomicDec(&mRefCount);
+  if (l == 0)
+  {
+    delete this;
+  }
+  return l;
+}
+
+// Called with mMutex held.  Picks the first frame of the window starting at
+// mCurrent that isn't decoded yet; the window never wraps, so its frames
+// map to distinct ring slots and the slot of a decoded mCurrent is left alone.
+bool pxTimedOffscreenCursor::nextFrameToDecode(uint32_t& f)
+{
+  if (mDecoder->failed)
+  {
+    return false;
+  }
+  for (f = std::max<uint32_t>(mCurrent, 1); f < mCurrent + PX_APNG_LOOK_AHEAD && f < mNumFrames; f++)
+  {
+    if (mDecoder->ringFrame[f % PX_APNG_LOOK_AHEAD] != f)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Runs on the thread pool, at most one per cursor at a time
+void pxTimedOffscreenCursor::decodeTask(void* data)
+{
+  pxTimedOffscreenCursor* c = (pxTimedOffscreenCursor*)data;
+  pxAPNGDecodeState* s = c->mDecoder;
+  uint32_t f;
+
+  c->mMutex.lock();
+  while (c->nextFrameToDecode(f))
+  {
+    uint32_t slot = f % PX_APNG_LOOK_AHEAD;
+    s->ringFrame[slot] = -1;
+    c->mMutex.unlock();
+
+    bool decoded = pxAPNGDecodeTo(s, f, &s->ring[slot]);
+
+    c->mMutex.lock();
+    if (!decoded)
+    {
+      s->failed = true;
+      break;
+    }
+    s->ringFrame[slot] = f;
+  }
+  c->mDecoding = false;
+  c->mMutex.unlock();
+  c->Release();
+}
+
+pxOffscreen* pxTimedOffscreenCursor::frame(uint32_t frameNum)
+{
+  if (frameNum >= mNumFrames)
+  {
+    return NULL;
+  }
+  if (mDecoder == NULL)
+  {
+    return &mSequence.mSequence[frameNum].mOffscreen;
+  }
+
+  rtMutexLockGuard lock(mMutex);
+  mCurrent = frameNum;
+  uint32_t slot = frameNum % PX_APNG_LOOK_AHEAD;
+  pxOffscreen* o = NULL;
+  if (frameNum == 0)
+  {
+    o = &mSequence.mSequence[0].mOffscreen;
+  }
+  else if (mDecoder->ringFrame[slot] == frameNum)
+  {
+    o = &mDecoder->ring[slot];
+  }
+
+  uint32_t f;
+  if (!mDecoding && nextFrameToDecode(f))
+  {
+    mDecoding = true;
+    AddRef();
+    rtThreadPool::globalInstance()->executeTask(new rtThreadTask(decodeTask, this, ""));
+  }
+  return o;
+}
+
+rtError pxLoadAPNGImage(const char *imageData, size_t imageDataSize,
+                        pxTimedOffscreenSequence &s)
+{
+  if (!imageData)
+  {
+    rtLogError("FATAL: Invalid arguments - imageData = NULL");
+    return RT_FAIL;
+  }
+
+  if (imageDataSize < 8)
+  {
+    rtLogError("FATAL: Invalid arguments - imageDataSize < 8");
+    return RT_FAIL;
+  }
+
+  s.init();
+
+  // test PNG header
+  if (png_sig_cmp((png_const_bytep)imageData, 0, 8) != 0)
+  {
+    // TODO Improve Detection of different image types
+    //    rtLogError("FATAL: Invalid PNG header");
+    return RT_FAIL;
+  }
+
+  return s.initAPNG(imageData, imageDataSize);
+}
+
 rtString imageType2str(pxImageType t)
 {
   switch(t)
@@ -26,6 +26,8 @@
 #ifndef PX_UTIL_H
 #define PX_UTIL_H
 #include "rtFile.h"
+#include "rtMutex.h"
+#include "rtAtomic.h"
 
 #include <vector>
 
@@ -40,15 +42,23 @@ rtError base64_encode(const unsigned char *data, size_t input_length, rtString &
 rtError base64_decode(rtString &s, rtData &d);
 rtError base64_decode(const unsigned char *data, size_t input_length, rtData &d);
 
+struct pxAPNGFile;
+struct pxAPNGDecodeState;
+class pxTimedOffscreenCursor;
+
 class pxTimedOffscreenSequence
 {
 public:
-  pxTimedOffscreenSequence():mTotalTime(0),mNumPlays(0) {}
-  ~pxTimedOffscreenSequence() {}
+  pxTimedOffscreenSequence():mTotalTime(0),mNumPlays(0),mWidth(0),mHeight(0),mFile(NULL) {}
+  ~pxTimedOffscreenSequence();
 
   void init();
   void addBuffer(pxBuffer &b, double duration);
 
+  // Keeps a copy of the compressed APNG and decodes only its first frame.
+  // The others are decoded by each pxTimedOffscreenCursor playing it.
+  rtError initAPNG(const char *imageData, size_t imageDataSize);
+
   uint32_t numFrames()
   {
     return mSequence.size();
@@ -64,11 +74,27 @@ public:
     mNumPlays = numPlays;
   }
 
+  uint32_t width()
+  {
+    return mWidth;
+  }
+
+  uint32_t height()
+  {
+    return mHeight;
+  }
+
+  // For APNGs only frame 0 is held here; use a pxTimedOffscreenCursor to
+  // get the others
   pxOffscreen &getFrameBuffer(int frameNum)
   {
     return mSequence[frameNum].mOffscreen;
   }
 
+  // Returns the area that changes going from frame 'from' to frame 'to', or
+  // false if the whole frame has to be replaced
+  bool dirtyRect(uint32_t from, uint32_t to, int32_t& x, int32_t& y, int32_t& w, int32_t& h);
+
   double getDuration(int frameNum)
   {
     return mSequence[frameNum].mDuration;
@@ -80,18 +106,59 @@ public:
   }
 
 private:
+  friend class pxTimedOffscreenCursor;
+
+  pxTimedOffscreenSequence(const pxTimedOffscreenSequence&);
+  pxTimedOffscreenSequence& operator=(const pxTimedOffscreenSequence&);
+
   struct entry
   {
     pxOffscreen mOffscreen;
     double mDuration;
+    // Area that differs from the previous frame
+    int32_t mDirtyX, mDirtyY, mDirtyW, mDirtyH;
   };
 
   std::vector<entry> mSequence;
   double mTotalTime;
   uint32_t mNumPlays;
+  uint32_t mWidth;
+  uint32_t mHeight;
+  pxAPNGFile* mFile;
 
 }; // CLASS - pxTimedOffscreenSequence
 
+// One playback of a pxTimedOffscreenSequence.  APNG frames after the first
+// are decoded a few frames ahead of the requested one on a worker thread,
+// into a ring owned by the cursor, so images sharing a sequence can play at
+// different frames.  Must not outlive the sequence or its next init().
+class pxTimedOffscreenCursor
+{
+public:
+  pxTimedOffscreenCursor(pxTimedOffscreenSequence& s);
+
+  unsigned long AddRef();
+  unsigned long Release();
+
+  // Returns frameNum if it has been decoded, otherwise NULL, and queues the
+  // decoding of what follows.  The buffer is valid until the next call.
+  pxOffscreen* frame(uint32_t frameNum);
+
+private:
+  ~pxTimedOffscreenCursor();
+
+  static void decodeTask(void* data);
+  bool nextFrameToDecode(uint32_t& f);
+
+  pxTimedOffscreenSequence& mSequence;  // only used on the calling thread
+  uint32_t mNumFrames;
+  pxAPNGDecodeState* mDecoder;
+  uint32_t mCurrent;
+  bool mDecoding;
+  rtMutex mMutex;
+  rtAtomic mRefCount;
+}; // CLASS - pxTimedOffscreenCursor
+
 
 typedef enum pxImageType_
 {
@@ -111,10 +178,19 @@ pxImageType;
 pxImageType getImageType(const uint8_t* data, size_t len);
 rtString imageType2str(pxImageType t);
 
+// w/h are the size the image will be displayed at.  SVG is rasterized at that
+// size; JPG and PNG are reduced by an integer factor that keeps them at least
+// that large, at decode time where the decoder allows it and by a box filter
+// otherwise.  Zero leaves the image at its natural size.
 rtError pxLoadImage( const char* imageData, size_t imageDataSize, pxOffscreen& o, int32_t w = 0, int32_t h = 0, float sx = 1.0f, float sy = 1.0f);
 rtError pxLoadImage( const char* filename,                        pxOffscreen& b, int32_t w = 0, int32_t h = 0, float sx = 1.0f, float sy = 1.0f);
 rtError pxStoreImage(const char* filename, pxOffscreen& b);
 
+// Box filters src into dst, averaging scaleX x scaleY blocks (partial blocks
+// at the right and bottom edges included).  dst is reinitialized and keeps
+// src's premultiplied state; upsideDown sets its row order.
+rtError pxReduceImage(pxOffscreen& src, pxOffscreen& dst, int scaleX, int scaleY, bool upsideDown = false);
+
 bool pxIsPNGImage(rtData d);
 bool pxIsPNGImage(const char* imageData, size_t imageDataSize);
 
@@ -124,7 +200,7 @@ rtError pxLoadAPNGImage(const char *imageData, size_t imageDataSize,
   pxTimedOffscreenSequence &s);
 
 rtError pxLoadPNGImage(const char* imageData, size_t imageDataSize, 
-                       pxOffscreen& o);
+                       pxOffscreen& o, int32_t w = 0, int32_t h = 0);
 rtError pxLoadPNGImage(const char* filename, pxOffscreen& o);
 rtError pxStorePNGImage(const char* filename, pxOffscreen& b,
                         bool grayscale = false, bool alpha=true);
@@ -137,14 +213,47 @@ rtError pxStoreJPGImage(const char* filename, pxBuffer& b);
 #endif
 
 #ifdef ENABLE_LIBJPEG_TURBO
-rtError pxLoadJPGImageTurbo(const char* buf, size_t buflen, pxOffscreen& o);
+rtError pxLoadJPGImageTurbo(const char* buf, size_t buflen, pxOffscreen& o, int32_t w = 0, int32_t h = 0);
 #endif //ENABLE_LIBJPEG_TURBO
 
-rtError pxLoadJPGImage(const char* imageData, size_t imageDataSize, pxOffscreen& o);
+rtError pxLoadJPGImage(const char* imageData, size_t imageDataSize, pxOffscreen& o, int32_t w = 0, int32_t h = 0);
 rtError pxLoadJPGImage(const char* filename, pxOffscreen& o);
 
 
-rtError pxLoadSVGImage(const char* buf, size_t buflen, pxOffscreen& o, int w = 0, int h = 0, float sx = 1.0f, float sy = 1.0f);
+struct pxImageStreamState;
+
+// Incremental JPG/PNG decoder that is fed the image data as it downloads.
+// The dimensions are available as soon as the header has arrived and the
+// image is decoded into the offscreen passed to the constructor, reduced to
+// the w/h target in the same way as pxLoadImage.  Other formats, and streams
+// that can't be decoded incrementally, report failed() and should be decoded
+// from the complete buffer instead.
+class pxImageStreamDecoder
+{
+public:
+  pxImageStreamDecoder(pxOffscreen& o, int32_t w = 0, int32_t h = 0);
+  ~pxImageStreamDecoder();
+
+  rtError feed(const char* data, size_t size);
+
+  bool hasDimensions() const;
+  int32_t width() const;
+  int32_t height() const;
+
+  bool isComplete() const;
+  bool failed() const;
+
+private:
+  pxImageStreamDecoder(const pxImageStreamDecoder&);
+  pxImageStreamDecoder& operator=(const pxImageStreamDecoder&);
+
+  pxImageStreamState* mState;
+};
+
+// Parsed documents are cached by source, so rasterizing the same source again
+// is cheaper.  premultiplied leaves o with color multiplied by alpha.
+rtError pxLoadSVGImage(const char* buf, size_t buflen, pxOffscreen& o, int w = 0, int h = 0, float sx = 1.0f, float sy = 1.0f,
+                       bool premultiplied = false);
 rtError pxLoadSVGImage(const char* filename,           pxOffscreen& o, int w = 0, int h = 0, float sx = 1.0f, float sy = 1.0f);
 rtError pxStoreSVGImage(const char* filename, pxBuffer& b); // NOT SUPPORTED
 
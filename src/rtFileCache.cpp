@@ -29,12 +29,135 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <errno.h>
+#include <zlib.h>
 #include "rtSettings.h"
 
 #define DEFAULT_MAX_CACHE_SIZE 20971520
+#define DEFAULT_MAX_PIXEL_CACHE_SIZE 67108864
+#define DEFAULT_MAX_CODE_CACHE_SIZE 16777216
 
 using namespace std;
 
+rtCacheIndex::rtCacheIndex():mSize(0)
+{
+}
+
+void rtCacheIndex::populate(const rtString& directory)
+{
+  clear();
+
+  DIR *dir = opendir(directory.cString());
+  if (NULL == dir)
+  {
+    return;
+  }
+
+  struct dirent *direntry;
+  struct stat buf;
+  for (direntry = readdir(dir); direntry != NULL; direntry = readdir(dir))
+  {
+    if ((strcmp(direntry->d_name,".") == 0) || (strcmp(direntry->d_name,"..") == 0))
+    {
+      continue;
+    }
+
+    rtString filename = direntry->d_name;
+    rtString path = directory;
+    path.append("/");
+    path.append(filename);
+    if (stat(path.cString(), &buf) < 0)
+    {
+      rtLogWarn("Reading the cache directory is failed for file(%s)", path.cString());
+      continue;
+    }
+
+    // Left over from an interrupted write
+    if (filename.endsWith(".tmp"))
+    {
+      unlink(path.cString());
+      continue;
+    }
+
+    touch(filename, buf.st_size, buf.st_mtime);
+  }
+  closedir(dir);
+}
+
+void rtCacheIndex::touch(const rtString& filename, int64_t size, time_t t)
+{
+  erase(filename);
+  entry e;
+  e.size = size;
+  e.timeIter = mFileTimeMap.insert(make_pair(t ? t : time(NULL), filename));
+  mFileMap[filename] = e;
+  mSize += size;
+}
+
+bool rtCacheIndex::erase(const rtString& filename)
+{
+  map<rtString,entry>::iterator it = mFileMap.find(filename);
+  if (it == mFileMap.end())
+  {
+    return false;
+  }
+  mSize -= it->second.size;
+  mFileTimeMap.erase(it->second.timeIter);
+  mFileMap.erase(it);
+  return true;
+}
+
+int64_t rtCacheIndex::evict(const rtString& directory, int64_t maxSize)
+{
+  timeMap::iterator iter = mFileTimeMap.begin();
+  while ((mSize > maxSize) && (iter != mFileTimeMap.end()))
+  {
+    rtString path = directory;
+    path.append("/");
+    path.append(iter->second);
+    if ((0 != unlink(path.cString())) && (errno != ENOENT))
+    {
+      rtLogWarn("!!! deletion of cache failed during cleanup for file(%s)", path.cString());
+      ++iter;
+      continue;
+    }
+    map<rtString,entry>::iterator it = mFileMap.find(iter->second);
+    mSize -= it->second.size;
+    mFileMap.erase(it);
+    mFileTimeMap.erase(iter++);
+  }
+  return mSize;
+}
+
+void rtCacheIndex::removeAll(const rtString& directory)
+{
+  for (map<rtString,entry>::iterator it = mFileMap.begin(); it != mFileMap.end(); ++it)
+  {
+    rtString path = directory;
+    path.append("/");
+    path.append(it->first);
+    unlink(path.cString());
+  }
+  clear();
+}
+
+void rtCacheIndex::clear()
+{
+  mFileMap.clear();
+  mFileTimeMap.clear();
+  mSize = 0;
+}
+
+int64_t rtCacheIndex::fileSize(const rtString& filename) const
+{
+  map<rtString,entry>::const_iterator it = mFileMap.find(filename);
+  return (it == mFileMap.end()) ? 0 : it->second.size;
+}
+
+/**********************************************************************/
+
 rtFileCache* rtFileCache::instance()
 {
   if (NULL == mCache)
@@ -451,3 +574,679 @@ rtString rtFileCache::absPath(rtString& filename)
   absPathString.append(filename);
   return absPathString;
 }
+
+/**********************************************************************/
+
+// On-disk layout of a pixel cache entry: header, key, then the pixel rows
+// (width * 4 bytes each), zlib compressed if flagged.
+struct rtPixelCacheHeader
+{
+  char     magic[4];
+  uint32_t version;
+  int32_t  width;
+  int32_t  height;
+  uint32_t compressed;
+  uint32_t keyLength;
+  uint64_t dataLength;
+};
+
+static const char     kPixelCacheMagic[4] = { 'P', 'X', 'P', 'C' };
+static const uint32_t kPixelCacheVersion  = 1;
+
+// Largest width or height read back from a cache file, so a corrupt header
+// can't ask for a huge allocation
+static const int32_t  kPixelCacheMaxDimension = 16384;
+// zlib can't compress better than about 1032:1
+static const uint64_t kPixelCacheMaxInflateRatio = 1032;
+
+rtPixelCache* rtPixelCache::mCache = NULL;
+
+// instance() is called from the decode threads
+static rtMutex& pixelCacheInstanceMutex()
+{
+  static rtMutex* m = new rtMutex;
+  return *m;
+}
+
+rtPixelCache* rtPixelCache::instance()
+{
+  rtMutexLockGuard lock(pixelCacheInstanceMutex());
+  if (NULL == mCache)
+  {
+    mCache = new rtPixelCache();
+  }
+  return mCache;
+}
+
+void rtPixelCache::destroy()
+{
+  rtMutexLockGuard lock(pixelCacheInstanceMutex());
+  if (NULL != mCache)
+  {
+    delete mCache;
+  }
+  mCache = NULL;
+}
+
+rtPixelCache::rtPixelCache():mMaxSize(DEFAULT_MAX_PIXEL_CACHE_SIZE),mDirectory("/tmp/pixelcache"),
+  mCompressionEnabled(false),mIndex(),mCacheMutex()
+{
+  rtValue val;
+  if (RT_OK == rtSettings::instance()->value("pixelCacheDirectory", val))
+  {
+    mDirectory = val.toString();
+  }
+  if (RT_OK == rtSettings::instance()->value("pixelCacheMaxSize", val))
+  {
+    mMaxSize = val.toInt64();
+  }
+  if (RT_OK == rtSettings::instance()->value("pixelCacheCompression", val))
+  {
+    mCompressionEnabled = (val.toString().compare("true") == 0);
+  }
+  rtLogInfo("The pixel cache directory is set to %s", mDirectory.cString());
+  setCacheDirectory(mDirectory.cString());
+}
+
+rtPixelCache::~rtPixelCache()
+{
+  mIndex.clear();
+}
+
+rtError rtPixelCache::setMaxCacheSize(int64_t bytes)
+{
+  mCacheMutex.lock();
+  mMaxSize = bytes;
+  mIndex.evict(mDirectory, mMaxSize);
+  mCacheMutex.unlock();
+  return RT_OK;
+}
+
+int64_t rtPixelCache::maxCacheSize()
+{
+  return mMaxSize;
+}
+
+int64_t rtPixelCache::cacheSize()
+{
+  return mIndex.size();
+}
+
+rtError rtPixelCache::setCacheDirectory(const char* directory)
+{
+  if ((NULL == directory) || (0 == strlen(directory)))
+  {
+    return RT_ERROR;
+  }
+
+  mCacheMutex.lock();
+  mDirectory = directory;
+  if (0 != mkdir(mDirectory.cString(), 0777) && errno != EEXIST)
+  {
+    rtLogWarn("creation of pixel cache directory(%s) failed", mDirectory.cString());
+  }
+  mIndex.populate(mDirectory);
+  mCacheMutex.unlock();
+  return RT_OK;
+}
+
+rtError rtPixelCache::cacheDirectory(rtString& dir)
+{
+  if (mDirectory.isEmpty())
+    return RT_ERROR;
+  dir = mDirectory;
+  return RT_OK;
+}
+
+void rtPixelCache::setCompressionEnabled(bool val)
+{
+  mCompressionEnabled = val;
+}
+
+bool rtPixelCache::compressionEnabled()
+{
+  return mCompressionEnabled;
+}
+
+rtString rtPixelCache::cacheKey(const char* url, const char* validator, int32_t w, int32_t h,
+                                float sx, float sy)
+{
+  // Without a validator there is no way to tell the entry is still current
+  if ((NULL == url) || (NULL == validator) || (0 == strlen(validator)))
+  {
+    return rtString();
+  }
+
+  stringstream stream;
+  stream << url << "|" << validator << "|" << w << "x" << h << "|" << sx << "x" << sy;
+  return stream.str().c_str();
+}
+
+rtError rtPixelCache::addToCache(const rtString& key, pxOffscreen& o)
+{
+  if (key.isEmpty() || o.width() <= 0 || o.height() <= 0)
+  {
+    return RT_ERROR;
+  }
+
+  size_t rowLength = (size_t)o.width() * 4;
+  size_t rawLength = rowLength * o.height();
+
+  // Rows are stored tightly packed top to bottom
+  rtData packed;
+  const uint8_t* raw = (const uint8_t*)o.base();
+  if ((size_t)o.stride() != rowLength || o.upsideDown())
+  {
+    packed.init(rawLength);
+    for (int y = 0; y < o.height(); y++)
+    {
+      memcpy(packed.data() + y * rowLength, o.scanline(y), rowLength);
+    }
+    raw = packed.data();
+  }
+
+  rtPixelCacheHeader header;
+  memcpy(header.magic, kPixelCacheMagic, sizeof(header.magic));
+  header.version    = kPixelCacheVersion;
+  header.width      = o.width();
+  header.height     = o.height();
+  header.compressed = 0;
+  header.keyLength  = key.byteLength();
+  header.dataLength = rawLength;
+
+  rtData compressed;
+  if (mCompressionEnabled)
+  {
+    uLongf compressedLength = compressBound(rawLength);
+    compressed.init(compressedLength);
+    if (Z_OK == compress2(compressed.data(), &compressedLength, raw, rawLength, Z_BEST_SPEED) &&
+        compressedLength < rawLength)
+    {
+      raw = compressed.data();
+      header.compressed = 1;
+      header.dataLength = compressedLength;
+    }
+  }
+
+  rtString filename = hashedFileName(key);
+  rtString path = absPath(filename);
+  rtString tmpPath = path;
+  tmpPath.append(".tmp");
+
+  FILE* fp = fopen(tmpPath.cString(), "wb");
+  if (NULL == fp)
+  {
+    rtLogWarn("unable to create pixel cache file(%s)", tmpPath.cString());
+    return RT_ERROR;
+  }
+
+  bool written = (fwrite(&header, sizeof(header), 1, fp) == 1) &&
+                 (fwrite(key.cString(), header.keyLength, 1, fp) == 1) &&
+                 (fwrite(raw, header.dataLength, 1, fp) == 1);
+  written = (0 == fclose(fp)) && written;
+
+  // Publish the entry in one step so readers never see a partial file
+  if (!written || (0 != rename(tmpPath.cString(), path.cString())))
+  {
+    rtLogWarn("writing pixel cache file(%s) failed", path.cString());
+    unlink(tmpPath.cString());
+    return RT_ERROR;
+  }
+
+  mCacheMutex.lock();
+  mIndex.touch(filename, sizeof(header) + header.keyLength + header.dataLength);
+  int64_t size = mIndex.evict(mDirectory, mMaxSize);
+  mCacheMutex.unlock();
+
+  rtLogDebug("pixel cache add key(%s) %dx%d total size(%ld)", key.cString(), o.width(), o.height(), (long)size);
+  return RT_OK;
+}
+
+rtError rtPixelCache::pixels(const rtString& key, pxOffscreen& o)
+{
+  if (key.isEmpty())
+  {
+    return RT_ERROR;
+  }
+
+  rtString filename = hashedFileName(key);
+  rtString path = absPath(filename);
+
+  int fd = open(path.cString(), O_RDONLY);
+  if (fd < 0)
+  {
+    return RT_ERROR;
+  }
+
+  struct stat buf;
+  if ((fstat(fd, &buf) < 0) || ((size_t)buf.st_size < sizeof(rtPixelCacheHeader)))
+  {
+    close(fd);
+    return RT_ERROR;
+  }
+
+  size_t fileLength = buf.st_size;
+  void* mapped = mmap(NULL, fileLength, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (MAP_FAILED == mapped)
+  {
+    return RT_ERROR;
+  }
+
+  const uint8_t* file = (const uint8_t*)mapped;
+  const rtPixelCacheHeader* header = (const rtPixelCacheHeader*)file;
+  const uint8_t* data = file + sizeof(rtPixelCacheHeader) + header->keyLength;
+  bool sizeValid = (header->width > 0) && (header->width <= kPixelCacheMaxDimension) &&
+                   (header->height > 0) && (header->height <= kPixelCacheMaxDimension) &&
+                   (header->dataLength <= fileLength);
+  size_t rowLength = sizeValid ? (size_t)header->width * 4 : 0;
+  size_t rawLength = rowLength * (sizeValid ? header->height : 0);
+
+  // Reject other versions, hash collisions, truncated files and sizes the
+  // payload can't hold
+  rtError e = RT_ERROR;
+  if ((0 == memcmp(header->magic, kPixelCacheMagic, sizeof(header->magic))) &&
+      (header->version == kPixelCacheVersion) && sizeValid &&
+      (header->keyLength == (uint32_t)key.byteLength()) &&
+      (sizeof(rtPixelCacheHeader) + header->keyLength + header->dataLength == fileLength) &&
+      (0 == memcmp(file + sizeof(rtPixelCacheHeader), key.cString(), header->keyLength)) &&
+      (header->compressed ? (rawLength <= header->dataLength * kPixelCacheMaxInflateRatio)
+                          : (header->dataLength == rawLength)))
+  {
+    o.init(header->width, header->height);
+
+    rtData inflated;
+    if (header->compressed)
+    {
+      uLongf inflatedLength = rawLength;
+      inflated.init(rawLength);
+      if ((Z_OK == uncompress(inflated.data(), &inflatedLength, data, header->dataLength)) &&
+          (inflatedLength == rawLength))
+      {
+        data = inflated.data();
+        e = RT_OK;
+      }
+    }
+    else
+    {
+      e = RT_OK;
+    }
+
+    if (RT_OK == e)
+    {
+      for (int y = 0; y < header->height; y++)
+      {
+        memcpy((void*)o.scanline(y), data + y * rowLength, rowLength);
+      }
+      o.mPixelFormat = RT_DEFAULT_PIX;
+    }
+  }
+
+  munmap(mapped, fileLength);
+
+  if (RT_OK == e)
+  {
+    // Mark as recently used; also keeps the eviction order across runs
+    utimes(path.cString(), NULL);
+    mCacheMutex.lock();
+    mIndex.touch(filename, fileLength);
+    mCacheMutex.unlock();
+  }
+  else
+  {
+    removeData(key);
+  }
+
+  return e;
+}
+
+rtError rtPixelCache::removeData(const rtString& key)
+{
+  rtString filename = hashedFileName(key);
+  rtString path = absPath(filename);
+
+  mCacheMutex.lock();
+  mIndex.erase(filename);
+  mCacheMutex.unlock();
+
+  if ((0 != unlink(path.cString())) && (errno != ENOENT))
+  {
+    rtLogWarn("removal of pixel cache file(%s) failed", path.cString());
+    return RT_ERROR;
+  }
+  return RT_OK;
+}
+
+void rtPixelCache::clearCache()
+{
+  mCacheMutex.lock();
+  mIndex.removeAll(mDirectory);
+  mCacheMutex.unlock();
+}
+
+rtString rtPixelCache::hashedFileName(const rtString& key)
+{
+  long int hash = hashFn(key.cString());
+  stringstream stream;
+  stream << hash << ".px";
+  return stream.str().c_str();
+}
+
+rtString rtPixelCache::absPath(const rtString& filename)
+{
+  rtString absPathString = mDirectory;
+  absPathString.append("/");
+  absPathString.append(filename);
+  return absPathString;
+}
+
+/**********************************************************************/
+
+// On-disk layout of a code cache entry: header, key, then the engine data.
+// checksum is the crc32 of key and data.
+struct rtCodeCacheHeader
+{
+  char     magic[4];
+  uint32_t version;
+  uint32_t keyLength;
+  uint32_t dataLength;
+  uint32_t checksum;
+};
+
+static const char     kCodeCacheMagic[4] = { 'P', 'X', 'C', 'C' };
+static const uint32_t kCodeCacheVersion  = 2;
+
+static uint32_t codeCacheChecksum(const rtString& key, const uint8_t* data, uint32_t length)
+{
+  uLong crc = crc32(0L, Z_NULL, 0);
+  crc = crc32(crc, (const Bytef*)key.cString(), key.byteLength());
+  crc = crc32(crc, (const Bytef*)data, length);
+  return (uint32_t)crc;
+}
+
+// Engines load cached code as is, so only use a directory nobody else can
+// write to: a real directory owned by this user with no group/other access
+static bool isPrivateDirectory(const char* directory)
+{
+  struct stat buf;
+  if (0 != lstat(directory, &buf))
+  {
+    return false;
+  }
+  return S_ISDIR(buf.st_mode) && (buf.st_uid == geteuid()) && ((buf.st_mode & 077) == 0);
+}
+
+rtCodeCache* rtCodeCache::mCache = NULL;
+
+rtCodeCache* rtCodeCache::instance()
+{
+  if (NULL == mCache)
+  {
+    mCache = new rtCodeCache();
+  }
+  return mCache;
+}
+
+void rtCodeCache::destroy()
+{
+  if (NULL != mCache)
+  {
+    delete mCache;
+  }
+  mCache = NULL;
+}
+
+rtCodeCache::rtCodeCache():mMaxSize(DEFAULT_MAX_CODE_CACHE_SIZE),mDirectory(),
+  mEnabled(true),mDirectoryUsable(false),mIndex(),mCacheMutex()
+{
+  // Per user, so another account can't plant entries
+  stringstream defaultDirectory;
+  defaultDirectory << "/tmp/codecache-" << geteuid();
+  mDirectory = defaultDirectory.str().c_str();
+
+  rtValue val;
+  if (RT_OK == rtSettings::instance()->value("codeCacheDirectory", val))
+  {
+    mDirectory = val.toString();
+  }
+  if (RT_OK == rtSettings::instance()->value("codeCacheMaxSize", val))
+  {
+    mMaxSize = val.toInt64();
+  }
+  if (RT_OK == rtSettings::instance()->value("codeCacheEnabled", val))
+  {
+    mEnabled = (val.toString().compare("false") != 0);
+  }
+  rtLogInfo("The code cache directory is set to %s", mDirectory.cString());
+  setCacheDirectory(mDirectory.cString());
+}
+
+rtCodeCache::~rtCodeCache()
+{
+  mIndex.clear();
+}
+
+rtError rtCodeCache::setMaxCacheSize(int64_t bytes)
+{
+  mCacheMutex.lock();
+  mMaxSize = bytes;
+  mIndex.evict(mDirectory, mMaxSize);
+  mCacheMutex.unlock();
+  return RT_OK;
+}
+
+int64_t rtCodeCache::maxCacheSize()
+{
+  return mMaxSize;
+}
+
+int64_t rtCodeCache::cacheSize()
+{
+  return mIndex.size();
+}
+
+rtError rtCodeCache::setCacheDirectory(const char* directory)
+{
+  if ((NULL == directory) || (0 == strlen(directory)))
+  {
+    return RT_ERROR;
+  }
+
+  mCacheMutex.lock();
+  mDirectory = directory;
+  mIndex.clear();
+  if (0 != mkdir(mDirectory.cString(), 0700) && errno != EEXIST)
+  {
+    rtLogWarn("creation of code cache directory(%s) failed", mDirectory.cString());
+  }
+  mDirectoryUsable = isPrivateDirectory(mDirectory.cString());
+  if (!mDirectoryUsable)
+  {
+    rtLogWarn("code cache directory(%s) is not a private directory of this user, code cache disabled", mDirectory.cString());
+    mCacheMutex.unlock();
+    return RT_ERROR;
+  }
+  mIndex.populate(mDirectory);
+  mIndex.evict(mDirectory, mMaxSize);
+  mCacheMutex.unlock();
+  return RT_OK;
+}
+
+rtError rtCodeCache::cacheDirectory(rtString& dir)
+{
+  if (mDirectory.isEmpty())
+    return RT_ERROR;
+  dir = mDirectory;
+  return RT_OK;
+}
+
+bool rtCodeCache::enabled()
+{
+  return mEnabled && mDirectoryUsable;
+}
+
+rtString rtCodeCache::cacheKey(const char* source, size_t length, const char* engineVersion)
+{
+  if ((NULL == source) || (NULL == engineVersion))
+  {
+    return rtString();
+  }
+
+  std::hash<std::string> sourceHashFn;
+  stringstream stream;
+  stream << engineVersion << "|" << length << "|" << sourceHashFn(std::string(source, length));
+  return stream.str().c_str();
+}
+
+rtError rtCodeCache::addToCache(const rtString& key, const uint8_t* data, uint32_t length)
+{
+  if (!mDirectoryUsable || key.isEmpty() || (NULL == data) || (0 == length))
+  {
+    return RT_ERROR;
+  }
+
+  rtCodeCacheHeader header;
+  memcpy(header.magic, kCodeCacheMagic, sizeof(header.magic));
+  header.version    = kCodeCacheVersion;
+  header.keyLength  = key.byteLength();
+  header.dataLength = length;
+  header.checksum   = codeCacheChecksum(key, data, length);
+
+  rtString filename = hashedFileName(key);
+  rtString path = absPath(filename);
+  rtString tmpPath = path;
+  tmpPath.append(".tmp");
+
+  int fd = open(tmpPath.cString(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  FILE* fp = (fd < 0) ? NULL : fdopen(fd, "wb");
+  if (NULL == fp)
+  {
+    rtLogWarn("unable to create code cache file(%s)", tmpPath.cString());
+    if (fd >= 0)
+    {
+      close(fd);
+    }
+    return RT_ERROR;
+  }
+
+  bool written = (fwrite(&header, sizeof(header), 1, fp) == 1) &&
+                 (fwrite(key.cString(), header.keyLength, 1, fp) == 1) &&
+                 (fwrite(data, length, 1, fp) == 1);
+  written = (0 == fclose(fp)) && written;
+
+  // Publish the entry in one step so readers never see a partial file
+  if (!written || (0 != rename(tmpPath.cString(), path.cString())))
+  {
+    rtLogWarn("writing code cache file(%s) failed", path.cString());
+    unlink(tmpPath.cString());
+    return RT_ERROR;
+  }
+
+  mCacheMutex.lock();
+  mIndex.touch(filename, sizeof(header) + header.keyLength + length);
+  int64_t size = mIndex.evict(mDirectory, mMaxSize);
+  mCacheMutex.unlock();
+
+  rtLogDebug("code cache add key(%s) %u bytes total size(%ld)", key.cString(), length, (long)size);
+  return RT_OK;
+}
+
+rtError rtCodeCache::data(const rtString& key, rtData& d)
+{
+  if (!mDirectoryUsable || key.isEmpty())
+  {
+    return RT_ERROR;
+  }
+
+  rtString filename = hashedFileName(key);
+  rtString path = absPath(filename);
+
+  FILE* fp = fopen(path.cString(), "rb");
+  if (NULL == fp)
+  {
+    return RT_ERROR;
+  }
+
+  // Reject other versions, hash collisions, truncated and corrupted files
+  rtError e = RT_ERROR;
+  rtCodeCacheHeader header;
+  if ((fread(&header, sizeof(header), 1, fp) == 1) &&
+      (0 == memcmp(header.magic, kCodeCacheMagic, sizeof(header.magic))) &&
+      (header.version == kCodeCacheVersion) &&
+      (header.keyLength == (uint32_t)key.byteLength()) &&
+      (header.dataLength > 0))
+  {
+    rtData storedKey;
+    storedKey.init(header.keyLength);
+    if ((fread(storedKey.data(), header.keyLength, 1, fp) == 1) &&
+        (0 == memcmp(storedKey.data(), key.cString(), header.keyLength)))
+    {
+      d.init(header.dataLength);
+      if ((fread(d.data(), header.dataLength, 1, fp) == 1) && (fgetc(fp) == EOF) &&
+          (header.checksum == codeCacheChecksum(key, d.data(), header.dataLength)))
+      {
+        e = RT_OK;
+      }
+      else
+      {
+        d.term();
+      }
+    }
+  }
+  fclose(fp);
+
+  if (RT_OK == e)
+  {
+    // Mark as recently used; also keeps the eviction order across runs
+    utimes(path.cString(), NULL);
+    mCacheMutex.lock();
+    mIndex.touch(filename, sizeof(header) + header.keyLength + header.dataLength);
+    mCacheMutex.unlock();
+  }
+  else
+  {
+    removeData(key);
+  }
+
+  return e;
+}
+
+rtError rtCodeCache::removeData(const rtString& key)
+{
+  rtString filename = hashedFileName(key);
+  rtString path = absPath(filename);
+
+  mCacheMutex.lock();
+  mIndex.erase(filename);
+  mCacheMutex.unlock();
+
+  if ((0 != unlink(path.cString())) && (errno != ENOENT))
+  {
+    rtLogWarn("removal of code cache file(%s) failed", path.cString());
+    return RT_ERROR;
+  }
+  return RT_OK;
+}
+
+void rtCodeCache::clearCache()
+{
+  mCacheMutex.lock();
+  mIndex.removeAll(mDirectory);
+  mCacheMutex.unlock();
+}
+
+rtString rtCodeCache::hashedFileName(const rtString& key)
+{
+  long int hash = hashFn(key.cString());
+  stringstream stream;
+  stream << hash << ".jsc";
+  return stream.str().c_str();
+}
+
+rtString rtCodeCache::absPath(const rtString& filename)
+{
+  rtString absPathString = mDirectory;
+  absPathString.append("/");
+  absPathString.append(filename);
+  return absPathString;
+}
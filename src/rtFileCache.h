@@ -31,6 +31,54 @@
 #include <map>
 // TODO elimate std::string from headers and impl
 #include <string>
+#include <time.h>
+
+/* Size and last use of the files in a cache directory, shared by the pixel and
+   code caches below.  Evicts least recently used files once they pass a size limit.  Not
+   locked; each cache calls it with its own mutex held. */
+class rtCacheIndex
+{
+  public:
+    rtCacheIndex();
+
+    /* replace the entries with the files in directory, ordered by modification
+       time, deleting *.tmp files left over from interrupted writes */
+    void populate(const rtString& directory);
+
+    /* record filename as used at time t, now if t is 0 */
+    void touch(const rtString& filename, int64_t size, time_t t = 0);
+
+    /* forget filename. Returns false if it was not recorded */
+    bool erase(const rtString& filename);
+
+    /* delete the least recently used files from directory till the total size
+       fits maxSize, return the new total size */
+    int64_t evict(const rtString& directory, int64_t maxSize);
+
+    /* delete every recorded file from directory and forget them */
+    void removeAll(const rtString& directory);
+
+    /* forget every file */
+    void clear();
+
+    /* returns the recorded size of filename, 0 if not recorded */
+    int64_t fileSize(const rtString& filename) const;
+
+    /* returns the total size of the recorded files */
+    int64_t size() const { return mSize; }
+
+  private:
+    typedef std::multimap<time_t,rtString> timeMap;
+    struct entry
+    {
+      int64_t size;
+      timeMap::iterator timeIter;
+    };
+
+    timeMap mFileTimeMap;
+    std::map<rtString,entry> mFileMap;
+    int64_t mSize;
+};
 
 class rtFileCache
 {
@@ -110,4 +158,127 @@ class rtFileCache
     rtMutex mCacheMutex;
     static rtFileCache* mCache;
 };
+
+class pxOffscreen;
+
+/* Second tier cache holding decoded image pixels, so images seen on a previous run
+   are read back instead of decoded again.  Entries are keyed by url, validator
+   (ETag/Last-Modified) and decode size and have their own directory and budget. */
+class rtPixelCache
+{
+  public:
+    /* set the maximum cache size. Default value is 64 MB */
+    rtError setMaxCacheSize(int64_t bytes);
+
+    /* returns the maximum cache size */
+    int64_t maxCacheSize();
+
+    /* returns the current cache size */
+    int64_t cacheSize();
+
+    /* sets the cache directory.Returns RT_OK on success and RT_ERROR on failure */
+    rtError setCacheDirectory(const char* directory);
+
+    /* returns the cache directory provisioned */
+    rtError cacheDirectory(rtString&);
+
+    /* enables zlib compression of entries added from now on */
+    void setCompressionEnabled(bool val);
+    bool compressionEnabled();
+
+    /* returns the key for an image decoded at w x h and scale sx, sy. Empty if validator is empty */
+    static rtString cacheKey(const char* url, const char* validator, int32_t w, int32_t h,
+                             float sx = 1.0f, float sy = 1.0f);
+
+    /* store the pixels for key. Returns RT_OK on success and RT_ERROR on failure */
+    rtError addToCache(const rtString& key, pxOffscreen& o);
+
+    /* read the pixels for key into o. Returns RT_OK on success and RT_ERROR on failure */
+    rtError pixels(const rtString& key, pxOffscreen& o);
+
+    /* removes the entry for key. Returns RT_OK on success and RT_ERROR on failure */
+    rtError removeData(const rtString& key);
+
+    /* clear the complete cache */
+    void clearCache();
+
+    static rtPixelCache* instance();
+
+    static void destroy();
+  private:
+    rtPixelCache();
+    ~rtPixelCache();
+
+    rtString hashedFileName(const rtString& key);
+    rtString absPath(const rtString& filename);
+
+    int64_t mMaxSize;
+    rtString mDirectory;
+    bool mCompressionEnabled;
+    std::hash<std::string> hashFn;
+    rtCacheIndex mIndex;
+    rtMutex mCacheMutex;
+    static rtPixelCache* mCache;
+};
+
+/* Script engine code cache, so scripts compiled on a previous run skip parsing and
+   compilation.  Entries are keyed by engine version and source hash; the engine
+   does its own check on consume and rejected entries should be removed. */
+class rtCodeCache
+{
+  public:
+    /* set the maximum cache size. Default value is 16 MB */
+    rtError setMaxCacheSize(int64_t bytes);
+
+    /* returns the maximum cache size */
+    int64_t maxCacheSize();
+
+    /* returns the current cache size */
+    int64_t cacheSize();
+
+    /* sets the cache directory, created 0700 if missing.  The cache is disabled unless
+       it is a directory owned by this user with no group or other access.
+       Returns RT_OK on success and RT_ERROR on failure */
+    rtError setCacheDirectory(const char* directory);
+
+    /* returns the cache directory provisioned */
+    rtError cacheDirectory(rtString&);
+
+    /* false when turned off with the codeCacheEnabled setting or the directory is unusable */
+    bool enabled();
+
+    /* returns the key for source compiled by the given engine version */
+    static rtString cacheKey(const char* source, size_t length, const char* engineVersion);
+
+    /* store the compiled data for key. Returns RT_OK on success and RT_ERROR on failure */
+    rtError addToCache(const rtString& key, const uint8_t* data, uint32_t length);
+
+    /* read the compiled data for key. Returns RT_OK on success and RT_ERROR on failure */
+    rtError data(const rtString& key, rtData& d);
+
+    /* removes the entry for key. Returns RT_OK on success and RT_ERROR on failure */
+    rtError removeData(const rtString& key);
+
+    /* clear the complete cache */
+    void clearCache();
+
+    static rtCodeCache* instance();
+
+    static void destroy();
+  private:
+    rtCodeCache();
+    ~rtCodeCache();
+
+    rtString hashedFileName(const rtString& key);
+    rtString absPath(const rtString& filename);
+
+    int64_t mMaxSize;
+    rtString mDirectory;
+    bool mEnabled;
+    bool mDirectoryUsable;
+    std::hash<std::string> hashFn;
+    rtCacheIndex mIndex;
+    rtMutex mCacheMutex;
+    static rtCodeCache* mCache;
+};
 #endif
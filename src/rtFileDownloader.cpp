@@ -123,6 +123,8 @@ static size_t WriteMemoryCallback(void *contents, size_t size, size_t nmemb, voi
   mem->contentsSize += downloadSize;
   mem->contentsBuffer[mem->contentsSize] = 0;
 
+  mem->downloadRequest->executeDownloadSink((const char*)contents, downloadSize);
+
   if (mem->downloadRequest->useCallbackDataSize() == true)
   {
      return downloadCallbackSize;
@@ -179,7 +181,7 @@ void onDownloadHandleCheck()
 
 rtFileDownloadRequest::rtFileDownloadRequest(const char* imageUrl, void* callbackData, void (*callbackFunction)(rtFileDownloadRequest*))
       : mFileUrl(imageUrl), mProxyServer(),
-    mErrorString(), mHttpStatusCode(0), mCallbackFunction(callbackFunction), mDownloadProgressCallbackFunction(NULL), mDownloadProgressUserPtr(NULL),
+    mErrorString(), mHttpStatusCode(0), mCallbackFunction(callbackFunction), mDownloadProgressCallbackFunction(NULL), mDownloadProgressUserPtr(NULL), mDownloadSink(NULL),
     mDownloadedData(0), mDownloadedDataSize(), mDownloadStatusCode(0) ,mCallbackData(callbackData),
     mCallbackFunctionMutex(), mHeaderData(0), mHeaderDataSize(0), mHeaderOnly(false), mDownloadHandleExpiresTime(-2)
 #ifdef ENABLE_HTTP_CACHE
@@ -285,6 +287,31 @@ size_t rtFileDownloadRequest::executeDownloadProgressCallback(void * ptr, size_t
   return 0;
 }
 
+void rtFileDownloadRequest::setDownloadSink(rtFileDownloadSink* sink)
+{
+  mCallbackFunctionMutex.lock();
+  mDownloadSink = sink;
+  mCallbackFunctionMutex.unlock();
+}
+
+rtFileDownloadSink* rtFileDownloadRequest::downloadSink()
+{
+  mCallbackFunctionMutex.lock();
+  rtFileDownloadSink* sink = mDownloadSink;
+  mCallbackFunctionMutex.unlock();
+  return sink;
+}
+
+void rtFileDownloadRequest::executeDownloadSink(const char* data, size_t size)
+{
+  mCallbackFunctionMutex.lock();
+  if (mDownloadSink != NULL)
+  {
+    mDownloadSink->onDownloadData(this, data, size);
+  }
+  mCallbackFunctionMutex.unlock();
+}
+
 void rtFileDownloadRequest::setDownloadedData(char* data, size_t size)
 {
   mDownloadedData = data;
@@ -627,8 +654,8 @@ void rtFileDownloader::raiseDownloadPriority(rtFileDownloadRequest* downloadRequ
 {
   if (downloadRequest != NULL)
   {
-    rtThreadPool *mainThreadPool = rtThreadPool::globalInstance();
-    mainThreadPool->raisePriority(downloadRequest->fileUrl());
+    rtThreadPool *ioThreadPool = rtThreadPool::ioInstance();
+    ioThreadPool->raisePriority(downloadRequest->fileUrl());
   }
 }
 
@@ -1000,7 +1027,7 @@ bool rtFileDownloader::checkAndDownloadFromCache(rtFileDownloadRequest* download
 
 void rtFileDownloader::downloadFileInBackground(rtFileDownloadRequest* downloadRequest)
 {
-    rtThreadPool* mainThreadPool = rtThreadPool::globalInstance();
+    rtThreadPool* ioThreadPool = rtThreadPool::ioInstance();
 
     if (downloadRequest->downloadHandleExpiresTime() < -1)
     {
@@ -1009,7 +1036,7 @@ void rtFileDownloader::downloadFileInBackground(rtFileDownloadRequest* downloadR
 
     rtThreadTask* task = new rtThreadTask(startFileDownloadInBackground, (void*)downloadRequest, downloadRequest->fileUrl());
 
-    mainThreadPool->executeTask(task);
+    ioThreadPool->executeTask(task);
 }
 
 rtFileDownloadRequest* rtFileDownloader::nextDownloadRequest()
@@ -1127,6 +1154,21 @@ void rtFileDownloader::setCallbackFunctionThreadSafe(rtFileDownloadRequest* down
   mDownloadRequestVectorMutex->unlock();
 }
 
+void rtFileDownloader::setDownloadSinkThreadSafe(rtFileDownloadRequest* downloadRequest,
+                                                 rtFileDownloadSink* sink, void* owner)
+{
+  mDownloadRequestVectorMutex->lock();
+  for (std::vector<rtFileDownloadRequest*>::iterator it=mDownloadRequestVector->begin(); it!=mDownloadRequestVector->end(); ++it)
+  {
+    if ((*it) == downloadRequest && (*it)->callbackData() == owner)
+    {
+      downloadRequest->setDownloadSink(sink);
+      break;
+    }
+  }
+  mDownloadRequestVectorMutex->unlock();
+}
+
 void rtFileDownloader::cancelDownloadRequestThreadSafe(rtFileDownloadRequest* downloadRequest, void* owner)
 {
   mDownloadRequestVectorMutex->lock();
@@ -43,6 +43,20 @@
 #pragma GCC diagnostic pop
 #endif
 
+class rtFileDownloadRequest;
+
+// Receives the body of a download chunk by chunk as it arrives, on the
+// download thread and ahead of the completion callback.  The body is still
+// buffered and handed to the completion callback as usual.  Calls are made
+// with the request's callback mutex held, so once the sink is cleared with
+// setDownloadSinkThreadSafe no call is running or will be made.
+class rtFileDownloadSink
+{
+public:
+  virtual ~rtFileDownloadSink() {}
+  virtual void onDownloadData(rtFileDownloadRequest* downloadRequest, const char* data, size_t size) = 0;
+};
+
 class rtFileDownloadRequest
 {
 public:
@@ -62,6 +76,9 @@ public:
   void setHttpStatusCode(long statusCode);
   bool executeCallback(int statusCode);
   size_t executeDownloadProgressCallback(void *ptr, size_t size, size_t nmemb);
+  void setDownloadSink(rtFileDownloadSink* sink);
+  rtFileDownloadSink* downloadSink();
+  void executeDownloadSink(const char* data, size_t size);
   void setDownloadedData(char* data, size_t size);
   void downloadedData(char*& data, size_t& size);
   char* downloadedData();
@@ -117,6 +134,7 @@ private:
   void (*mCallbackFunction)(rtFileDownloadRequest*);
   size_t (*mDownloadProgressCallbackFunction)(void *ptr, size_t size, size_t nmemb, void *userData);
   void *mDownloadProgressUserPtr;
+  rtFileDownloadSink* mDownloadSink;
   char* mDownloadedData;
   size_t mDownloadedDataSize;
   int mDownloadStatusCode;
@@ -159,6 +177,7 @@ public:
 
     static rtFileDownloader* instance();
     static void setCallbackFunctionThreadSafe(rtFileDownloadRequest* downloadRequest, void (*callbackFunction)(rtFileDownloadRequest*), void* owner);
+    static void setDownloadSinkThreadSafe(rtFileDownloadRequest* downloadRequest, rtFileDownloadSink* sink, void* owner);
     static void cancelDownloadRequestThreadSafe(rtFileDownloadRequest* downloadRequest, void* owner);
     static bool isDownloadRequestCanceled(rtFileDownloadRequest* downloadRequest, void* owner);
 
@@ -19,6 +19,7 @@
 // rtObject.cpp
 
 #include "rtObject.h"
+#include "rtPool.h"
 #include <errno.h>
 
 using namespace std;
@@ -35,18 +36,85 @@ unsigned long rtEmit::Release() {
   return l;
 }
 
+rtEmit::_rtEmitEvent* rtEmit::findEvent(const char* eventName)
+{
+  return const_cast<_rtEmitEvent*>(static_cast<const rtEmit*>(this)->findEvent(eventName));
+}
+
+const rtEmit::_rtEmitEvent* rtEmit::findEvent(const char* eventName) const
+{
+  if (!eventName)
+    return NULL;
+  for (vector<_rtEmitEvent>::const_iterator it = mEvents.begin(); it != mEvents.end(); ++it)
+  {
+    const char* n = it->n.cString();
+    if (n == eventName || (n[0] == eventName[0] && strcmp(n, eventName) == 0))
+      return &(*it);
+  }
+  return NULL;
+}
+
+rtEmit::_rtEmitEvent* rtEmit::findEvent(const rtString& eventName)
+{
+  return const_cast<_rtEmitEvent*>(static_cast<const rtEmit*>(this)->findEvent(eventName));
+}
+
+const rtEmit::_rtEmitEvent* rtEmit::findEvent(const rtString& eventName) const
+{
+  if (!eventName.isInterned())
+    return findEvent(eventName.cString());
+
+  // A bucket for an interned name shares its text, unless the bucket was
+  // made before the name was interned
+  const char* name = eventName.cString();
+  for (vector<_rtEmitEvent>::const_iterator it = mEvents.begin(); it != mEvents.end(); ++it)
+  {
+    const char* n = it->n.cString();
+    if (n == name)
+      return &(*it);
+    if (!it->n.isInterned() && n[0] == name[0] && strcmp(n, name) == 0)
+      return &(*it);
+  }
+  return NULL;
+}
+
+void rtEmit::addEntry(const _rtEmitEntry& e)
+{
+  _rtEmitEvent* ev = findEvent(e.n);
+  if (!ev)
+  {
+    mEvents.push_back(_rtEmitEvent());
+    ev = &mEvents.back();
+    // Share the text of built-in names; others are copied so they go away
+    // with the bucket
+    ev->n = rtString::findInterned(e.n.cString());
+    if (ev->n.isEmpty())
+      ev->n = e.n;
+  }
+  ev->entries.push_back(e);
+}
+
 rtError rtEmit::setListener(const char* eventName, rtIFunction* f)
 {
-  for (vector<_rtEmitEntry>::iterator it = mEntries.begin();
-       it != mEntries.end(); it++)
+  _rtEmitEvent* ev = findEvent(eventName);
+  if (ev)
   {
-    _rtEmitEntry& e = (*it);
-    if (e.n == eventName && e.isProp)
+    for (vector<_rtEmitEntry>::iterator it = ev->entries.begin();
+         it != ev->entries.end(); it++)
     {
-      mEntries.erase(it);
-      // There can only be one
-      break;
+      _rtEmitEntry& e = (*it);
+      if (e.isProp && !e.markForDelete)
+      {
+        if (mDispatchDepth == 0)
+          ev->entries.erase(it);
+        else
+          e.markForDelete = true;
+        // There can only be one
+        break;
+      }
     }
+    if (ev->entries.empty())
+      mEvents.erase(mEvents.begin() + (ev - &mEvents[0]));
   }
   if (f)
   {
@@ -57,7 +125,10 @@ rtError rtEmit::setListener(const char* eventName, rtIFunction* f)
     e.markForDelete = false;
     e.fnHash = f->hash();
     e.emitOnce = false;
-    mEntries.push_back(e);
+    if (mDispatchDepth == 0)
+      addEntry(e);
+    else
+      mPendingEntriesToAdd.push_back(e);
   }
   
   return RT_OK;
@@ -69,16 +140,20 @@ rtError rtEmit::addListener(const char* eventName, rtIFunction* f, bool emitOnce
     return RT_ERROR;
   // Only allow unique entries
   bool found = false;
-  for (vector<_rtEmitEntry>::iterator it = mEntries.begin(); 
-       it != mEntries.end(); it++)
+  _rtEmitEvent* ev = findEvent(eventName);
+  if (ev)
   {
-    _rtEmitEntry& e = (*it);
-    // mHash check for javscript events callback 
-    // markForDelete check is added to handle scenario where same handler is deleted and added immediately in same handler
-    if (e.n == eventName && ((e.f.getPtr() == f) || ((f->hash() != (size_t)-1) && (e.fnHash == f->hash()) && (false == e.markForDelete))) && !e.isProp)
+    for (vector<_rtEmitEntry>::iterator it = ev->entries.begin(); 
+         it != ev->entries.end(); it++)
     {
-      found = true;
-      break;
+      _rtEmitEntry& e = (*it);
+      // mHash check for javscript events callback 
+      // markForDelete check is added to handle scenario where same handler is deleted and added immediately in same handler
+      if (((e.f.getPtr() == f) || ((f->hash() != (size_t)-1) && (e.fnHash == f->hash()))) && (false == e.markForDelete) && !e.isProp)
+      {
+        found = true;
+        break;
+      }
     }
   }
   if (!found)
@@ -90,9 +165,9 @@ rtError rtEmit::addListener(const char* eventName, rtIFunction* f, bool emitOnce
     e.markForDelete = false;
     e.fnHash = f->hash();
     e.emitOnce = emitOnce;
-    if (!mProcessingEvents)
+    if (mDispatchDepth == 0)
     {
-      mEntries.push_back(e);
+      addEntry(e);
     }
     else
     {
@@ -104,131 +179,157 @@ rtError rtEmit::addListener(const char* eventName, rtIFunction* f, bool emitOnce
   return RT_OK;
 }
 
+static bool sameListener(const rtFunctionRef& a, size_t aHash, rtIFunction* f)
+{
+  return (a.getPtr() == f) || (((size_t)-1 != aHash) && (aHash == f->hash()));
+}
+
 rtError rtEmit::delListener(const char* eventName, rtIFunction* f)
 {
   if (!eventName || !f)
     return RT_ERROR;
 
-  for (vector<_rtEmitEntry>::iterator it = mEntries.begin(); 
-       it != mEntries.end(); it++)
+  _rtEmitEvent* ev = findEvent(eventName);
+  if (ev)
   {
-    _rtEmitEntry& e = (*it);
-    if (e.n == eventName && ((e.f.getPtr() == f) || (((size_t)-1 != e.fnHash) && (e.fnHash == f->hash()))) && !e.isProp)
+    for (vector<_rtEmitEntry>::iterator it = ev->entries.begin(); 
+         it != ev->entries.end(); it++)
     {
-      // if no events is being processed currently, remove the event entries
-      if (!mProcessingEvents)
-      	mEntries.erase(it);
-      else
-        it->markForDelete = true;
-      // There can only be one
+      _rtEmitEntry& e = (*it);
+      if (!e.isProp && !e.markForDelete && sameListener(e.f, e.fnHash, f))
+      {
+        // if no events is being processed currently, remove the event entries
+        if (mDispatchDepth == 0)
+        {
+          ev->entries.erase(it);
+          if (ev->entries.empty())
+            mEvents.erase(mEvents.begin() + (ev - &mEvents[0]));
+        }
+        else
+          e.markForDelete = true;
+        // There can only be one
+        return RT_OK;
+      }
+    }
+  }
+
+  // added and removed by listeners of the event being sent
+  for (vector<_rtEmitEntry>::iterator it = mPendingEntriesToAdd.begin();
+       it != mPendingEntriesToAdd.end(); it++)
+  {
+    if (!it->isProp && it->n == eventName && sameListener(it->f, it->fnHash, f))
+    {
+      mPendingEntriesToAdd.erase(it);
       break;
     }
   }
   return RT_OK;
 }
 
+bool rtEmit::hasListeners(const char* eventName) const
+{
+  if (mEvents.empty())
+    return false;
+  return hasLiveEntries(findEvent(eventName));
+}
+
+bool rtEmit::hasListeners(const rtString& eventName) const
+{
+  if (mEvents.empty())
+    return false;
+  return hasLiveEntries(findEvent(eventName));
+}
+
+bool rtEmit::hasLiveEntries(const _rtEmitEvent* ev)
+{
+  if (!ev)
+    return false;
+  for (vector<_rtEmitEntry>::const_iterator it = ev->entries.begin(); it != ev->entries.end(); ++it)
+  {
+    if (!it->markForDelete)
+      return true;
+  }
+  return false;
+}
+
+size_t rtEmit::listenerCount() const
+{
+  size_t count = 0;
+  for (vector<_rtEmitEvent>::const_iterator it = mEvents.begin(); it != mEvents.end(); ++it)
+    count += it->entries.size();
+  return count;
+}
+
+void rtEmit::dispatch(int numArgs, const rtValue* args, rtValue* result)
+{
+  rtString eventName = args[0].toString();
+  rtLogDebug("rtEmit::Send %s", eventName.cString());
+
+  _rtEmitEvent* ev = findEvent(eventName);
+  if (!ev)
+    return;
+
+  // Listeners added meanwhile are queued and removed ones only marked, so
+  // the bucket stays put while it is walked
+  mDispatchDepth++;
+  size_t count = ev->entries.size();
+  for (size_t i = 0; i < count; i++)
+  {
+    _rtEmitEntry& e = ev->entries[i];
+    if (e.markForDelete)
+      continue;
+    if (e.emitOnce)
+      e.markForDelete = true;
+
+    // Do this here to make interop synchronous
+    rtError err;
+    // have to invoke all no opportunity to return errors
+    // pass NULL as final argument for indication of asynchronous call
+    err = e.f->Send(numArgs-1, args+1, result);
+    if (err != RT_OK)
+      rtLogInfo("failed to send. %s", rtStrError(err));
+
+    // EPIPE means it's disconnected
+    if (err == rtErrorFromErrno(EPIPE) || err == RT_ERROR_STREAM_CLOSED)
+    {
+      rtLogInfo("removing entry from remote client");
+      e.markForDelete = true;
+    }
+  }
+  mDispatchDepth--;
+}
+
 rtError rtEmit::Send(int numArgs, const rtValue* args, rtValue* result) 
 {
   (void)result;
   if (numArgs > 0)
   {
-    rtString eventName = args[0].toString();
-    rtLogDebug("rtEmit::Send %s", eventName.cString());
-
-    vector<_rtEmitEntry>::iterator it = mEntries.begin();
-    
-    mProcessingEvents = true;
-    while (it != mEntries.end())
-    {
-      _rtEmitEntry& e = (*it);
-      if (e.n == eventName)
-      {
-        // Do this here to make interop synchronous
-        rtError err;
-        rtValue discard;
-        // have to invoke all no opportunity to return errors
-        // SYNC EVENTS
+    // SYNC EVENTS
 #ifndef DISABLE_SYNC_EVENTS
-        // SYNC EVENTS ... enables stopPropagation() ...
-        //
-        // pass NULL as final argument for indication of asynchronous call
-        err = e.f->Send(numArgs-1, args+1, &discard);
+    // SYNC EVENTS ... enables stopPropagation() ...
+    //
+    rtValue discard;
+    dispatch(numArgs, args, &discard);
 #else
 
 #warning "  >>>>>>  No SYNC EVENTS... stopPropagation() will be broken !!"
 
-        err = e.f->Send(numArgs-1, args+1, NULL);
+    dispatch(numArgs, args, NULL);
 #endif
-        if (err != RT_OK)
-          rtLogInfo("failed to send. %s", rtStrError(err));
-
-        // EPIPE means it's disconnected
-        if (err == rtErrorFromErrno(EPIPE) || err == RT_ERROR_STREAM_CLOSED)
-        {
-          rtLogInfo("removing entry from remote client");
-          it = mEntries.erase(it);
-        }
-        else if (e.emitOnce)
-        {
-          it = mEntries.erase(it);
-        }
-        else
-        {
-          ++it;
-        }
-      }
-      else
-      {
-        ++it;
-      }
-    }
-    mProcessingEvents = false;
-    processPendingEvents();
+    if (mDispatchDepth == 0)
+      processPendingEvents();
   }
   return RT_OK;
 }
 
 // function to send events asynchronously
-// don't need code for handling cases in mid of events send,as it is asynchronous
 rtError rtEmit::SendAsync(int numArgs, const rtValue* args) 
 {
   if (numArgs > 0)
   {
-    rtString eventName = args[0].toString();
-    rtLogDebug("rtEmit::SendAsync %s", eventName.cString());
-    vector<_rtEmitEntry>::iterator it = mEntries.begin();
-
-    while (it != mEntries.end())
-    {
-      _rtEmitEntry& e = (*it);
-      if (e.n == eventName)
-      {
-        rtError err;
-        err = e.f->Send(numArgs-1, args+1, NULL);
-        if (err != RT_OK)
-          rtLogInfo("failed to send. %s", rtStrError(err));
-
-        // EPIPE means it's disconnected
-        if (err == rtErrorFromErrno(EPIPE) || err == RT_ERROR_STREAM_CLOSED)
-        {
-          rtLogInfo("removing entry from remote client");
-          it = mEntries.erase(it);
-        }
-        else if (e.emitOnce)
-        {
-          it = mEntries.erase(it);
-        }
-        else
-        {
-          ++it;
-        }
-      }
-      else
-      {
-        ++it;
-      }
-    }
-    processPendingEvents();
+    dispatch(numArgs, args, NULL);
+    if (mDispatchDepth == 0)
+      processPendingEvents();
   }
   return RT_OK;
 }
@@ -236,35 +337,44 @@ rtError rtEmit::SendAsync(int numArgs, const rtValue* args)
 // function to process pending events to get deleted or added
 void rtEmit::processPendingEvents()
 {
-  vector<_rtEmitEntry>::iterator it = mEntries.begin();
-  while (it != mEntries.end())
+  vector<_rtEmitEvent>::iterator ev = mEvents.begin();
+  while (ev != mEvents.end())
   {
-    if (true == it->markForDelete)
+    vector<_rtEmitEntry>& entries = ev->entries;
+    vector<_rtEmitEntry>::iterator it = entries.begin();
+    while (it != entries.end())
     {
-      it = mEntries.erase(it);
+      if (true == it->markForDelete)
+        it = entries.erase(it);
+      else
+        ++it;
     }
+    if (entries.empty())
+      ev = mEvents.erase(ev);
     else
-    {
-      ++it;
-    }
+      ++ev;
   }
 
-  vector<_rtEmitEntry>::iterator pendingit = mPendingEntriesToAdd.begin();
-  while (pendingit != mPendingEntriesToAdd.end())
-  {
-    _rtEmitEntry& src = (*pendingit);
-    _rtEmitEntry dest;
-    dest.n = src.n;
-    dest.f = src.f;
-    dest.isProp = src.isProp;
-    dest.markForDelete = src.markForDelete;
-    dest.fnHash = src.fnHash;
-    dest.emitOnce = src.emitOnce;
+  for (vector<_rtEmitEntry>::iterator it = mPendingEntriesToAdd.begin();
+       it != mPendingEntriesToAdd.end(); ++it)
+    addEntry(*it);
+  mPendingEntriesToAdd.clear();
+}
 
-    mEntries.push_back(dest);
-    ++pendingit;
+rtError rtEmit::clearListeners()
+{
+  if (mDispatchDepth == 0)
+    mEvents.clear();
+  else
+  {
+    for (vector<_rtEmitEvent>::iterator ev = mEvents.begin(); ev != mEvents.end(); ++ev)
+    {
+      for (vector<_rtEmitEntry>::iterator it = ev->entries.begin(); it != ev->entries.end(); ++it)
+        it->markForDelete = true;
+    }
   }
   mPendingEntriesToAdd.clear();
+  return RT_OK;
 }
 
 rtError rtEmit::clearListeners(const char* eventName)
@@ -272,24 +382,16 @@ rtError rtEmit::clearListeners(const char* eventName)
   if (!eventName)
     return RT_ERROR;
 
-  vector<_rtEmitEntry>::iterator it = mEntries.begin();
-  while (it != mEntries.end())
+  _rtEmitEvent* ev = findEvent(eventName);
+  if (ev)
   {
-    _rtEmitEntry& e = (*it);
-    if (e.n == eventName)
-    {
-      // if no events is being processed currently, remove the event entries
-      if (!mProcessingEvents)
-        it = mEntries.erase(it);
-      else
-      {
-        it->markForDelete = true;
-        ++it;
-      }
-    }
+    // if no events is being processed currently, remove the event entries
+    if (mDispatchDepth == 0)
+      mEvents.erase(mEvents.begin() + (ev - &mEvents[0]));
     else
     {
-      ++it;
+      for (vector<_rtEmitEntry>::iterator it = ev->entries.begin(); it != ev->entries.end(); ++it)
+        it->markForDelete = true;
     }
   }
   return RT_OK;
@@ -306,6 +408,27 @@ rtError rtEmitRef::SendAsync(int numArgs,const rtValue* args)
   return (*this)->SendAsync(numArgs, args);
 }
 // rtArrayObject
+static rtPool* arrayObjectPool()
+{
+  static rtPool* pool = rtPool::create("rtArrayObject", sizeof(rtArrayObject));
+  return pool;
+}
+
+void* rtArrayObject::operator new(size_t size)
+{
+  if (size != sizeof(rtArrayObject))
+    return ::operator new(size);
+  return arrayObjectPool()->alloc();
+}
+
+void rtArrayObject::operator delete(void* p, size_t size)
+{
+  if (size != sizeof(rtArrayObject))
+    ::operator delete(p);
+  else
+    arrayObjectPool()->free(p);
+}
+
 void rtArrayObject::empty()
 {
   mElements.clear();
@@ -313,7 +436,7 @@ void rtArrayObject::empty()
 
 void rtArrayObject::pushBack(rtValue v)
 {
-  mElements.push_back(v);
+  mElements.push_back(std::move(v));
 }
 
 rtError rtArrayObject::Get(const char* name, rtValue* value) const
@@ -361,16 +484,109 @@ rtError rtArrayObject::Set(uint32_t i, const rtValue* value)
 }
 
 // rtMapObject
-vector<rtNamedValue>::iterator rtMapObject::find(const char* name)
+static uint32_t rtMapHash(const char* s)
+{
+  // FNV-1a
+  uint32_t h = 2166136261u;
+  while (*s)
+  {
+    h ^= (uint8_t)*s++;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+static rtPool* mapObjectPool()
+{
+  static rtPool* pool = rtPool::create("rtMapObject", sizeof(rtMapObject), 128);
+  return pool;
+}
+
+void* rtMapObject::operator new(size_t size)
+{
+  if (size != sizeof(rtMapObject))
+    return ::operator new(size);
+  return mapObjectPool()->alloc();
+}
+
+void rtMapObject::operator delete(void* p, size_t size)
+{
+  if (size != sizeof(rtMapObject))
+    ::operator delete(p);
+  else
+    mapObjectPool()->free(p);
+}
+
+int32_t rtMapObject::find(const char* name, uint32_t hash) const
+{
+  if (mIndex.empty())
+  {
+    for (size_t i = 0; i < mProps.size(); i++)
+    {
+      if (mProps[i].hash == hash && !strcmp(mProps[i].n.cString(), name))
+        return (int32_t)i;
+    }
+    return -1;
+  }
+
+  size_t mask = mIndex.size() - 1;
+  for (size_t b = hash & mask; mIndex[b] >= 0; b = (b + 1) & mask)
+  {
+    const rtNamedValue& p = mProps[mIndex[b]];
+    if (p.hash == hash && !strcmp(p.n.cString(), name))
+      return mIndex[b];
+  }
+  return -1;
+}
+
+void rtMapObject::place(uint32_t i)
+{
+  size_t mask = mIndex.size() - 1;
+  size_t b = mProps[i].hash & mask;
+  while (mIndex[b] >= 0)
+    b = (b + 1) & mask;
+  mIndex[b] = (int32_t)i;
+}
+
+void rtMapObject::rehash(size_t buckets)
+{
+  mIndex.assign(buckets, -1);
+  for (uint32_t i = 0; i < mProps.size(); i++)
+    place(i);
+}
+
+rtValue& rtMapObject::insert(const char* name, uint32_t hash)
 {
-  vector<rtNamedValue>::iterator it = mProps.begin(); 
-  while(it != mProps.end())
+  mProps.push_back(rtNamedValue());
+  rtNamedValue& p = mProps.back();
+  p.n = name;
+  p.hash = hash;
+
+  // keep the index at most half full
+  size_t buckets = mIndex.empty() ? 4 * kIndexThreshold : mIndex.size();
+  if (!mIndex.empty() || mProps.size() > kIndexThreshold)
   {
-    if (it->n == name)
-      return it;
-    it++;
+    while (mProps.size() * 2 > buckets)
+      buckets *= 2;
+    if (buckets != mIndex.size())
+      rehash(buckets);
+    else
+      place((uint32_t)mProps.size() - 1);
+  }
+  return p.v;
+}
+
+void rtMapObject::reserve(uint32_t n)
+{
+  mProps.reserve(n);
+  if (n > kIndexThreshold)
+  {
+    size_t buckets = mIndex.empty() ? 4 * kIndexThreshold : mIndex.size();
+    while (n * 2 > buckets)
+      buckets *= 2;
+    if (buckets != mIndex.size())
+      rehash(buckets);
   }
-  return it;
 }
 
 rtError rtMapObject::Get(const char* name, rtValue* value) const
@@ -378,12 +594,11 @@ rtError rtMapObject::Get(const char* name, rtValue* value) const
   if (!value) 
     return RT_FAIL;
 
-  rtMapObject* this_ = const_cast<rtMapObject*>(this);
-  
-  vector<rtNamedValue>::iterator it = this_->find(name);
-  if (it != mProps.end())
+  name = name?name:"";
+  int32_t i = find(name, rtMapHash(name));
+  if (i >= 0)
   {
-    *value = it->v;
+    *value = mProps[i].v;
     return RT_OK;
   }
   else if (!strcmp(name, "description"))
@@ -395,11 +610,12 @@ rtError rtMapObject::Get(const char* name, rtValue* value) const
   else if (!strcmp(name, "allKeys"))
   {
     rtRefT<rtArrayObject> keys = new rtArrayObject;
-    vector<rtNamedValue>::const_iterator it = this_->mProps.begin();
-    while(it != this_->mProps.end())
+    keys->reserve((uint32_t)mProps.size());
+    vector<rtNamedValue>::const_iterator it = mProps.begin();
+    while(it != mProps.end())
     {
       // exclude allKeys
-      if (it->n != "allKeys")
+      if (strcmp(it->n.cString(), "allKeys"))
         keys->pushBack(it->n);
       it++;
     }
@@ -414,21 +630,36 @@ rtError rtMapObject::Set(const char* name, const rtValue* value)
   if (!value) 
     return RT_FAIL;
   
-  vector<rtNamedValue>::iterator it = find(name);
-  if (it != mProps.end())
-  {
-    it->v = *value;
-    return RT_OK;
-  }
+  name = name?name:"";
+  uint32_t hash = rtMapHash(name);
+  int32_t i = find(name, hash);
+  if (i >= 0)
+    mProps[i].v = *value;
   else
   {
-    rtNamedValue v;
-    v.n = name;
-    v.v = *value;
-    mProps.push_back(v);
-    return RT_OK;
+    // value may be one of ours, which inserting can move
+    rtValue v(*value);
+    insert(name, hash) = std::move(v);
   }
-  return RT_PROP_NOT_FOUND;
+  return RT_OK;
+}
+
+rtError rtMapObject::set(const char* name, rtValue&& value)
+{
+  name = name?name:"";
+  uint32_t hash = rtMapHash(name);
+  int32_t i = find(name, hash);
+  if (i >= 0)
+    mProps[i].v = std::move(value);
+  else
+    insert(name, hash) = std::move(value);
+  return RT_OK;
+}
+
+void rtMapObject::clear()
+{
+  mProps.clear();
+  mIndex.clear();
 }
 
 rtError rtMapObject::Get(uint32_t /*i*/, rtValue* /*value*/) const
@@ -442,6 +673,29 @@ rtError rtMapObject::Set(uint32_t /*i*/, const rtValue* /*value*/)
 }
 
 
+// rtMapObjectCache
+rtObjectRef rtMapObjectCache::get()
+{
+  if (mFree.empty())
+    return new rtMapObject;
+  rtObjectRef e = mFree.back().getPtr();
+  mFree.pop_back();
+  mReused++;
+  return e;
+}
+
+void rtMapObjectCache::recycle(rtObjectRef& e)
+{
+  rtMapObject* m = dynamic_cast<rtMapObject*>(e.getPtr());
+  if (m && m->refCount() == 1 && mFree.size() < mMaxCached)
+  {
+    m->clear();
+    mFree.push_back(m);
+  }
+  e = NULL;
+}
+
+
 // rtObject
   
 unsigned long /*__stdcall__ */ rtObject::AddRef() 
@@ -564,6 +818,28 @@ void rtObjectBase::set(rtObjectRef o)
   if (!o) 
     return;
 
+  // Native maps, and script objects that can hand over all their properties
+  // in one call, are copied without a lookup per key
+  rtMapObject* map = dynamic_cast<rtMapObject*>(o.getPtr());
+  rtValue all;
+  if (!map)
+  {
+    rtIPropertySnapshot* snapshot = dynamic_cast<rtIPropertySnapshot*>(o.getPtr());
+    if (snapshot && RT_OK == snapshot->allProperties(all))
+      map = dynamic_cast<rtMapObject*>(all.toObject().getPtr());
+  }
+  if (map)
+  {
+    for (uint32_t i = 0; i < map->count(); i++)
+    {
+      // same as the allKeys path, which never reports itself
+      if (map->keyAt(i) == "allKeys")
+        continue;
+      set(map->keyAt(i), map->valueAt(i));
+    }
+    return;
+  }
+
   rtObjectRef keys = o.get<rtObjectRef>("allKeys");
   if (keys)
   {
@@ -602,36 +878,36 @@ rtError rtObjectBase::send(const char* messageName) {
   return Send(messageName, 0, 0);
 }
 
-rtError rtObjectBase::send(const char* messageName, const rtValue& arg1) {
-  rtValue args[1] = {arg1};
+rtError rtObjectBase::send(const char* messageName, rtValue arg1) {
+  rtValue args[1] = {std::move(arg1)};
   return Send(messageName, 1, args);
 }
 
-rtError rtObjectBase::send(const char* messageName, const rtValue& arg1, 
-			   const rtValue& arg2) {
-  rtValue args[2] = {arg1, arg2};
+rtError rtObjectBase::send(const char* messageName, rtValue arg1, 
+			   rtValue arg2) {
+  rtValue args[2] = {std::move(arg1), std::move(arg2)};
   return Send(messageName, 2, args);
 }
 
-rtError rtObjectBase::send(const char* messageName, const rtValue& arg1, 
-			   const rtValue& arg2, const rtValue& arg3) {
-  rtValue args[3] = {arg1, arg2, arg3};
+rtError rtObjectBase::send(const char* messageName, rtValue arg1, 
+			   rtValue arg2, rtValue arg3) {
+  rtValue args[3] = {std::move(arg1), std::move(arg2), std::move(arg3)};
   return Send(messageName, 3, args);
 }
 
-rtError rtObjectBase::send(const char* messageName, const rtValue& arg1, 
-			   const rtValue& arg2, const rtValue& arg3, 
-			   const rtValue& arg4)
+rtError rtObjectBase::send(const char* messageName, rtValue arg1, 
+			   rtValue arg2, rtValue arg3, 
+			   rtValue arg4)
 {
-  rtValue args[4] = {arg1, arg2, arg3, arg4};
+  rtValue args[4] = {std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4)};
   return Send(messageName, 4, args);
 }
 
-rtError rtObjectBase::send(const char* messageName, const rtValue& arg1, 
-			   const rtValue& arg2, const rtValue& arg3, 
-			   const rtValue& arg4, const rtValue& arg5)
+rtError rtObjectBase::send(const char* messageName, rtValue arg1, 
+			   rtValue arg2, rtValue arg3, 
+			   rtValue arg4, rtValue arg5)
 {
-  rtValue args[5] = {arg1, arg2, arg3, arg4, arg5};
+  rtValue args[5] = {std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5)};
   return Send(messageName, 5, args);
 }
 
@@ -640,60 +916,60 @@ rtError rtFunctionBase::send()
   return Send(0, 0, NULL);
 }
 
-rtError rtFunctionBase::sendAsync(const rtValue& arg1, const rtValue& arg2)
+rtError rtFunctionBase::sendAsync(rtValue arg1, rtValue arg2)
 {
-  rtValue args[2] = {arg1, arg2};
+  rtValue args[2] = {std::move(arg1), std::move(arg2)};
   return SendAsync(2, args);
 }
 
-rtError rtFunctionBase::send(const rtValue& arg1)
+rtError rtFunctionBase::send(rtValue arg1)
 {
-  rtValue args[1] = {arg1};
+  rtValue args[1] = {std::move(arg1)};
   return Send(1, args, NULL);
 }
 
-rtError rtFunctionBase::send(const rtValue& arg1, const rtValue& arg2)
+rtError rtFunctionBase::send(rtValue arg1, rtValue arg2)
 {
-  rtValue args[2] = {arg1, arg2};
+  rtValue args[2] = {std::move(arg1), std::move(arg2)};
   return Send(2, args);
 }
 
-rtError rtFunctionBase::send(const rtValue& arg1, const rtValue& arg2, 
-			     const rtValue& arg3)
+rtError rtFunctionBase::send(rtValue arg1, rtValue arg2, 
+			     rtValue arg3)
 {
-  rtValue args[3] = {arg1, arg2, arg3};
+  rtValue args[3] = {std::move(arg1), std::move(arg2), std::move(arg3)};
   return Send(3, args);
 }
 
-rtError rtFunctionBase::send(const rtValue& arg1, const rtValue& arg2, 
-			     const rtValue& arg3, const rtValue& arg4)
+rtError rtFunctionBase::send(rtValue arg1, rtValue arg2, 
+			     rtValue arg3, rtValue arg4)
 {
-  rtValue args[4] = {arg1, arg2, arg3, arg4};
+  rtValue args[4] = {std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4)};
   return Send(4, args);
 }
 
-rtError rtFunctionBase::send(const rtValue& arg1, const rtValue& arg2, 
-			     const rtValue& arg3, const rtValue& arg4,
-			     const rtValue& arg5)
+rtError rtFunctionBase::send(rtValue arg1, rtValue arg2, 
+			     rtValue arg3, rtValue arg4,
+			     rtValue arg5)
 {
-  rtValue args[5] = {arg1, arg2, arg3, arg4, arg5};
+  rtValue args[5] = {std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5)};
   return Send(5, args);
 }
 
-rtError rtFunctionBase::send(const rtValue& arg1, const rtValue& arg2, 
-			     const rtValue& arg3, const rtValue& arg4,
-			     const rtValue& arg5, const rtValue& arg6)
+rtError rtFunctionBase::send(rtValue arg1, rtValue arg2, 
+			     rtValue arg3, rtValue arg4,
+			     rtValue arg5, rtValue arg6)
 {
-  rtValue args[6] = {arg1, arg2, arg3, arg4, arg5, arg6};
+  rtValue args[6] = {std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6)};
   return Send(6, args);
 }
 
-rtError rtFunctionBase::send(const rtValue& arg1, const rtValue& arg2, 
-			     const rtValue& arg3, const rtValue& arg4,
-			     const rtValue& arg5, const rtValue& arg6,
-			     const rtValue& arg7)
+rtError rtFunctionBase::send(rtValue arg1, rtValue arg2, 
+			     rtValue arg3, rtValue arg4,
+			     rtValue arg5, rtValue arg6,
+			     rtValue arg7)
 {
-  rtValue args[7] = {arg1, arg2, arg3, arg4, arg5, arg6, arg7};
+  rtValue args[7] = {std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6), std::move(arg7)};
   return Send(7, args);
 }
 
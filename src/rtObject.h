@@ -65,6 +65,18 @@ class rtIFunction
     virtual void setHash(size_t) = 0;
 };
 
+// Mix-in for rtIObject(s), such as script object wrappers, that can hand
+// over all their properties in one call.  rtObjectBase::set(rtObjectRef)
+// uses it instead of a lookup per key.
+class rtIPropertySnapshot
+{
+  public:
+    virtual ~rtIPropertySnapshot() {}
+
+    // Sets v to an rtMapObject holding every enumerable property
+    virtual rtError allProperties(rtValue& v) const = 0;
+};
+
 class rtObjectRef;
 
 // Mix-in providing convenience methods for rtIObject(s)
@@ -92,68 +104,68 @@ public:
 
   // convenience methods
   rtError send(const char* messageName);
-  rtError send(const char* messageName, const rtValue& arg1);
-  rtError send(const char* messageName, const rtValue& arg1, 
-	       const rtValue& arg2);
-  rtError send(const char* messageName, const rtValue& arg1, 
-	       const rtValue& arg2, const rtValue& arg3);
-  rtError send(const char* messageName, const rtValue& arg1, 
-	       const rtValue& arg2, const rtValue& arg3, 
-	       const rtValue& arg4);
-  rtError send(const char* messageName, const rtValue& arg1, 
-	       const rtValue& arg2, const rtValue& arg3, 
-	       const rtValue& arg4, const rtValue& arg5);
-  rtError send(const char* messageName, const rtValue& arg1, 
-	       const rtValue& arg2, const rtValue& arg3, 
-	       const rtValue& arg4, const rtValue& arg5,
-	       const rtValue& arg6);
-  rtError send(const char* messageName, const rtValue& arg1, 
-	       const rtValue& arg2, const rtValue& arg3, 
-	       const rtValue& arg4, const rtValue& arg5,
-	       const rtValue& arg6, const rtValue& arg7);
-  rtError send(const char* messageName, const rtValue& arg1, 
-	       const rtValue& arg2, const rtValue& arg3, 
-	       const rtValue& arg4, const rtValue& arg5,
-	       const rtValue& arg6, const rtValue& arg7,
-	       const rtValue& arg8);
-  rtError send(const char* messageName, const rtValue& arg1, 
-	       const rtValue& arg2, const rtValue& arg3, 
-	       const rtValue& arg4, const rtValue& arg5,
-	       const rtValue& arg6, const rtValue& arg7,
-	       const rtValue& arg8, const rtValue& arg9);
+  rtError send(const char* messageName, rtValue arg1);
+  rtError send(const char* messageName, rtValue arg1, 
+	       rtValue arg2);
+  rtError send(const char* messageName, rtValue arg1, 
+	       rtValue arg2, rtValue arg3);
+  rtError send(const char* messageName, rtValue arg1, 
+	       rtValue arg2, rtValue arg3, 
+	       rtValue arg4);
+  rtError send(const char* messageName, rtValue arg1, 
+	       rtValue arg2, rtValue arg3, 
+	       rtValue arg4, rtValue arg5);
+  rtError send(const char* messageName, rtValue arg1, 
+	       rtValue arg2, rtValue arg3, 
+	       rtValue arg4, rtValue arg5,
+	       rtValue arg6);
+  rtError send(const char* messageName, rtValue arg1, 
+	       rtValue arg2, rtValue arg3, 
+	       rtValue arg4, rtValue arg5,
+	       rtValue arg6, rtValue arg7);
+  rtError send(const char* messageName, rtValue arg1, 
+	       rtValue arg2, rtValue arg3, 
+	       rtValue arg4, rtValue arg5,
+	       rtValue arg6, rtValue arg7,
+	       rtValue arg8);
+  rtError send(const char* messageName, rtValue arg1, 
+	       rtValue arg2, rtValue arg3, 
+	       rtValue arg4, rtValue arg5,
+	       rtValue arg6, rtValue arg7,
+	       rtValue arg8, rtValue arg9);
 
   // convenience methods with return type coercion
   template <typename T> 
     rtError sendReturns(const char* messageName, T& result);  
   template <typename T> 
-    rtError sendReturns(const char* messageName, const rtValue& arg1, 
+    rtError sendReturns(const char* messageName, rtValue arg1, 
 			T& result);
   template <typename T> 
-    rtError sendReturns(const char* messageName, const rtValue& arg1, 
-			const rtValue& arg2, T& result);
+    rtError sendReturns(const char* messageName, rtValue arg1, 
+			rtValue arg2, T& result);
   template <typename T> 
-    rtError sendReturns(const char* messageName, const rtValue& arg1, 
-			const rtValue& arg2, const rtValue& arg3, 
+    rtError sendReturns(const char* messageName, rtValue arg1, 
+			rtValue arg2, rtValue arg3, 
 			T& result);
   template <typename T> 
-    rtError sendReturns(const char* messageName, const rtValue& arg1, 
-			const rtValue& arg2, const rtValue& arg3, 
-			const rtValue& arg4, T& result);
+    rtError sendReturns(const char* messageName, rtValue arg1, 
+			rtValue arg2, rtValue arg3, 
+			rtValue arg4, T& result);
   template <typename T> 
-    rtError sendReturns(const char* messageName, const rtValue& arg1, 
-			const rtValue& arg2, const rtValue& arg3, 
-			const rtValue& arg4, const rtValue& arg5,
+    rtError sendReturns(const char* messageName, rtValue arg1, 
+			rtValue arg2, rtValue arg3, 
+			rtValue arg4, rtValue arg5,
       T& result);
   template <typename T> 
-    rtError sendReturns(const char* messageName, const rtValue& arg1, 
-			const rtValue& arg2, const rtValue& arg3, 
-			const rtValue& arg4, const rtValue& arg5,
-      const rtValue& arg6, T& result);
+    rtError sendReturns(const char* messageName, rtValue arg1, 
+			rtValue arg2, rtValue arg3, 
+			rtValue arg4, rtValue arg5,
+      rtValue arg6, T& result);
   template <typename T> 
-    rtError sendReturns(const char* messageName, const rtValue& arg1, 
-			const rtValue& arg2, const rtValue& arg3, 
-			const rtValue& arg4, const rtValue& arg5,
-      const rtValue& arg6, const rtValue& arg7,
+    rtError sendReturns(const char* messageName, rtValue arg1, 
+			rtValue arg2, rtValue arg3, 
+			rtValue arg4, rtValue arg5,
+      rtValue arg6, rtValue arg7,
       T& result);
 
   // General case
@@ -174,53 +186,53 @@ class rtFunctionBase
 {
 public:
   rtError send();
-  rtError send(const rtValue& arg1);
-  rtError send(const rtValue& arg1, const rtValue& arg2);
-  rtError send(const rtValue& arg1, const rtValue& arg2, 
-	       const rtValue& arg3);
-  rtError send(const rtValue& arg1, const rtValue& arg2, 
-	       const rtValue& arg3, const rtValue& arg4);
-  rtError send(const rtValue& arg1, const rtValue& arg2, 
-	       const rtValue& arg3, const rtValue& arg4,
-	       const rtValue& arg5);
-  rtError send(const rtValue& arg1, const rtValue& arg2, 
-	       const rtValue& arg3, const rtValue& arg4,
-	       const rtValue& arg5, const rtValue& arg6);
-  rtError send(const rtValue& arg1, const rtValue& arg2, 
-	       const rtValue& arg3, const rtValue& arg4,
-	       const rtValue& arg5, const rtValue& arg6,
-	       const rtValue& arg7);
+  rtError send(rtValue arg1);
+  rtError send(rtValue arg1, rtValue arg2);
+  rtError send(rtValue arg1, rtValue arg2, 
+	       rtValue arg3);
+  rtError send(rtValue arg1, rtValue arg2, 
+	       rtValue arg3, rtValue arg4);
+  rtError send(rtValue arg1, rtValue arg2, 
+	       rtValue arg3, rtValue arg4,
+	       rtValue arg5);
+  rtError send(rtValue arg1, rtValue arg2, 
+	       rtValue arg3, rtValue arg4,
+	       rtValue arg5, rtValue arg6);
+  rtError send(rtValue arg1, rtValue arg2, 
+	       rtValue arg3, rtValue arg4,
+	       rtValue arg5, rtValue arg6,
+	       rtValue arg7);
   
-  rtError sendAsync(const rtValue& arg1, const rtValue& arg2);
+  rtError sendAsync(rtValue arg1, rtValue arg2);
 
   template <typename T> 
     rtError sendReturns(T& result);
   template <typename T> 
-    rtError sendReturns(const rtValue& arg1, T& result);
+    rtError sendReturns(rtValue arg1, T& result);
   template <typename T> 
-    rtError sendReturns(const rtValue& arg1, const rtValue& arg2, 
+    rtError sendReturns(rtValue arg1, rtValue arg2, 
 			T& result);
   template <typename T> 
-    rtError sendReturns(const rtValue& arg1, const rtValue& arg2, 
-			const rtValue& arg3, T& result);
+    rtError sendReturns(rtValue arg1, rtValue arg2, 
+			rtValue arg3, T& result);
   template <typename T> 
-    rtError sendReturns(const rtValue& arg1, const rtValue& arg2, 
-			const rtValue& arg3, const rtValue& arg4, 
+    rtError sendReturns(rtValue arg1, rtValue arg2, 
+			rtValue arg3, rtValue arg4, 
 			T& result);
   template <typename T> 
-    rtError sendReturns(const rtValue& arg1, const rtValue& arg2, 
-			const rtValue& arg3, const rtValue& arg4, 
-			const rtValue& arg5, T& result);
+    rtError sendReturns(rtValue arg1, rtValue arg2, 
+			rtValue arg3, rtValue arg4, 
+			rtValue arg5, T& result);
   template <typename T> 
-    rtError sendReturns(const rtValue& arg1, const rtValue& arg2, 
-			const rtValue& arg3, const rtValue& arg4, 
-			const rtValue& arg5, const rtValue& arg6, 
+    rtError sendReturns(rtValue arg1, rtValue arg2, 
+			rtValue arg3, rtValue arg4, 
+			rtValue arg5, rtValue arg6, 
       T& result);
   template <typename T> 
-    rtError sendReturns(const rtValue& arg1, const rtValue& arg2, 
-			const rtValue& arg3, const rtValue& arg4, 
-			const rtValue& arg5, const rtValue& arg6,
-      const rtValue& arg7, T& result);            
+    rtError sendReturns(rtValue arg1, rtValue arg2, 
+			rtValue arg3, rtValue arg4, 
+			rtValue arg5, rtValue arg6,
+      rtValue arg7, T& result);            
   finline rtError Send(int numArgs, const rtValue* args) 
     {return Send(numArgs, args, NULL);}
 
@@ -316,6 +328,8 @@ public:
   virtual unsigned long /*__stdcall*/ AddRef();
   virtual unsigned long /*__stdcall*/ Release();
 
+  unsigned long refCount() const { return mRefCount; }
+
 #if 1
 
   // hook for doing "post construction" activities
@@ -394,10 +408,10 @@ rtError rtObjectBase::sendReturns(const char* messageName, T& result)
 }
 
 template <typename T> 
-rtError rtObjectBase::sendReturns(const char* messageName, const rtValue& arg1, 
+rtError rtObjectBase::sendReturns(const char* messageName, rtValue arg1, 
 				  T& result) 
 {
-  rtValue args[1] = {arg1};
+  rtValue args[1] = {std::move(arg1)};
   rtValue resultValue;
   rtError e = SendReturns(messageName, 1, args, resultValue);
   if (e == RT_OK) 
@@ -406,10 +420,10 @@ rtError rtObjectBase::sendReturns(const char* messageName, const rtValue& arg1,
 }
 
 template <typename T> 
-rtError rtObjectBase::sendReturns(const char* messageName, const rtValue& arg1, 
-				  const rtValue& arg2, T& result) 
+rtError rtObjectBase::sendReturns(const char* messageName, rtValue arg1, 
+				  rtValue arg2, T& result) 
 {
-  rtValue args[2] = {arg1, arg2};
+  rtValue args[2] = {std::move(arg1), std::move(arg2)};
   rtValue resultValue;
   rtError e = SendReturns(messageName, 2, args, resultValue);
   if (e == RT_OK) 
@@ -418,11 +432,11 @@ rtError rtObjectBase::sendReturns(const char* messageName, const rtValue& arg1,
 }
 
 template <typename T> 
-rtError rtObjectBase::sendReturns(const char* messageName, const rtValue& arg1, 
-				  const rtValue& arg2, const rtValue& arg3, 
+rtError rtObjectBase::sendReturns(const char* messageName, rtValue arg1, 
+				  rtValue arg2, rtValue arg3, 
 				  T& result)
 {
-  rtValue args[3] = {arg1, arg2, arg3};
+  rtValue args[3] = {std::move(arg1), std::move(arg2), std::move(arg3)};
   rtValue resultValue;
   rtError e = SendReturns(messageName, 3, args, resultValue);
   if (e == RT_OK) 
@@ -431,11 +445,11 @@ rtError rtObjectBase::sendReturns(const char* messageName, const rtValue& arg1,
 }
 
 template <typename T> 
-rtError rtObjectBase::sendReturns(const char* messageName, const rtValue& arg1, 
-				  const rtValue& arg2, const rtValue& arg3, 
-				  const rtValue& arg4, T& result)
+rtError rtObjectBase::sendReturns(const char* messageName, rtValue arg1, 
+				  rtValue arg2, rtValue arg3, 
+				  rtValue arg4, T& result)
 {
-  rtValue args[] = {arg1, arg2, arg3, arg4};
+  rtValue args[] = {std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4)};
   rtValue resultValue;
   rtError e = SendReturns(messageName, 4, args, resultValue);
   if (e == RT_OK) 
@@ -444,12 +458,12 @@ rtError rtObjectBase::sendReturns(const char* messageName, const rtValue& arg1,
 }
 
 template <typename T> 
-rtError rtObjectBase::sendReturns(const char* messageName, const rtValue& arg1, 
-				  const rtValue& arg2, const rtValue& arg3, 
-				  const rtValue& arg4, const rtValue& arg5,
+rtError rtObjectBase::sendReturns(const char* messageName, rtValue arg1, 
+				  rtValue arg2, rtValue arg3, 
+				  rtValue arg4, rtValue arg5,
           T& result)
 {
-  rtValue args[] = {arg1, arg2, arg3, arg4, arg5};
+  rtValue args[] = {std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5)};
   rtValue resultValue;
   rtError e = SendReturns(messageName, 5, args, resultValue);
   if (e == RT_OK) 
@@ -458,12 +472,12 @@ rtError rtObjectBase::sendReturns(const char* messageName, const rtValue& arg1,
 }
 
 template <typename T> 
-rtError rtObjectBase::sendReturns(const char* messageName, const rtValue& arg1, 
-				  const rtValue& arg2, const rtValue& arg3, 
-				  const rtValue& arg4, const rtValue& arg5,
-          const rtValue& arg6, T& result)
+rtError rtObjectBase::sendReturns(const char* messageName, rtValue arg1, 
+				  rtValue arg2, rtValue arg3, 
+				  rtValue arg4, rtValue arg5,
+          rtValue arg6, T& result)
 {
-  rtValue args[] = {arg1, arg2, arg3, arg4, arg5, arg6};
+  rtValue args[] = {std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6)};
   rtValue resultValue;
   rtError e = SendReturns(messageName, 6, args, resultValue);
   if (e == RT_OK) 
@@ -472,13 +486,13 @@ rtError rtObjectBase::sendReturns(const char* messageName, const rtValue& arg1,
 }
 
 template <typename T> 
-rtError rtObjectBase::sendReturns(const char* messageName, const rtValue& arg1, 
-				  const rtValue& arg2, const rtValue& arg3, 
-				  const rtValue& arg4, const rtValue& arg5,
-          const rtValue& arg6, const rtValue& arg7,
+rtError rtObjectBase::sendReturns(const char* messageName, rtValue arg1, 
+				  rtValue arg2, rtValue arg3, 
+				  rtValue arg4, rtValue arg5,
+          rtValue arg6, rtValue arg7,
           T& result)
 {
-  rtValue args[] = {arg1, arg2, arg3, arg4, arg5, arg6, arg7};
+  rtValue args[] = {std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6), std::move(arg7)};
   rtValue resultValue;
   rtError e = SendReturns(messageName, 7, args, resultValue);
   if (e == RT_OK) 
@@ -497,9 +511,9 @@ rtError rtFunctionBase::sendReturns(T& result)
 }
 
 template <typename T> 
-rtError rtFunctionBase::sendReturns(const rtValue& arg1, T& result)
+rtError rtFunctionBase::sendReturns(rtValue arg1, T& result)
 {
-  rtValue args[1] = {arg1};
+  rtValue args[1] = {std::move(arg1)};
   rtValue resultValue;
   rtError e = SendReturns(1, args, resultValue);
   if (e == RT_OK) 
@@ -508,10 +522,10 @@ rtError rtFunctionBase::sendReturns(const rtValue& arg1, T& result)
 }
 
 template <typename T> 
-rtError rtFunctionBase::sendReturns(const rtValue& arg1, const rtValue& arg2, 
+rtError rtFunctionBase::sendReturns(rtValue arg1, rtValue arg2, 
 				    T& result)
 {
-  rtValue args[2] = {arg1, arg2};
+  rtValue args[2] = {std::move(arg1), std::move(arg2)};
   rtValue resultValue;
   rtError e = SendReturns(2, args, resultValue);
   if (e == RT_OK) 
@@ -520,10 +534,10 @@ rtError rtFunctionBase::sendReturns(const rtValue& arg1, const rtValue& arg2,
 }
 
 template <typename T> 
-rtError rtFunctionBase::sendReturns(const rtValue& arg1, const rtValue& arg2, 
-				    const rtValue& arg3, T& result)
+rtError rtFunctionBase::sendReturns(rtValue arg1, rtValue arg2, 
+				    rtValue arg3, T& result)
 {
-  rtValue args[3] = {arg1, arg2, arg3};
+  rtValue args[3] = {std::move(arg1), std::move(arg2), std::move(arg3)};
   rtValue resultValue;
   rtError e = SendReturns(3, args, resultValue);
   if (e == RT_OK) 
@@ -532,11 +546,11 @@ rtError rtFunctionBase::sendReturns(const rtValue& arg1, const rtValue& arg2,
 }
 
 template <typename T> 
-rtError rtFunctionBase::sendReturns(const rtValue& arg1, const rtValue& arg2, 
-				    const rtValue& arg3, const rtValue& arg4, 
+rtError rtFunctionBase::sendReturns(rtValue arg1, rtValue arg2, 
+				    rtValue arg3, rtValue arg4, 
 				    T& result)
 {
-  rtValue args[] = {arg1, arg2, arg3, arg4};
+  rtValue args[] = {std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4)};
   rtValue resultValue;
   rtError e = SendReturns(4, args, resultValue);
   if (e == RT_OK) 
@@ -545,11 +559,11 @@ rtError rtFunctionBase::sendReturns(const rtValue& arg1, const rtValue& arg2,
 }
 
 template <typename T> 
-rtError rtFunctionBase::sendReturns(const rtValue& arg1, const rtValue& arg2, 
-				    const rtValue& arg3, const rtValue& arg4, 
-				    const rtValue& arg5, T& result)
+rtError rtFunctionBase::sendReturns(rtValue arg1, rtValue arg2, 
+				    rtValue arg3, rtValue arg4, 
+				    rtValue arg5, T& result)
 {
-  rtValue args[] = {arg1, arg2, arg3, arg4, arg5};
+  rtValue args[] = {std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5)};
   rtValue resultValue;
   rtError e = SendReturns(5, args, resultValue);
   if (e == RT_OK) 
@@ -558,12 +572,12 @@ rtError rtFunctionBase::sendReturns(const rtValue& arg1, const rtValue& arg2,
 }
 
 template <typename T> 
-rtError rtFunctionBase::sendReturns(const rtValue& arg1, const rtValue& arg2, 
-				    const rtValue& arg3, const rtValue& arg4, 
-				    const rtValue& arg5, const rtValue& arg6,
+rtError rtFunctionBase::sendReturns(rtValue arg1, rtValue arg2, 
+				    rtValue arg3, rtValue arg4, 
+				    rtValue arg5, rtValue arg6,
             T& result)
 {
-  rtValue args[] = {arg1, arg2, arg3, arg4, arg5, arg6};
+  rtValue args[] = {std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6)};
   rtValue resultValue;
   rtError e = SendReturns(6, args, resultValue);
   if (e == RT_OK) 
@@ -572,12 +586,12 @@ rtError rtFunctionBase::sendReturns(const rtValue& arg1, const rtValue& arg2,
 }
 
 template <typename T> 
-rtError rtFunctionBase::sendReturns(const rtValue& arg1, const rtValue& arg2, 
-				    const rtValue& arg3, const rtValue& arg4, 
-				    const rtValue& arg5, const rtValue& arg6,
-            const rtValue& arg7, T& result)
+rtError rtFunctionBase::sendReturns(rtValue arg1, rtValue arg2, 
+				    rtValue arg3, rtValue arg4, 
+				    rtValue arg5, rtValue arg6,
+            rtValue arg7, T& result)
 {
-  rtValue args[] = {arg1, arg2, arg3, arg4, arg5, arg6, arg7};
+  rtValue args[] = {std::move(arg1), std::move(arg2), std::move(arg3), std::move(arg4), std::move(arg5), std::move(arg6), std::move(arg7)};
   rtValue resultValue;
   rtError e = SendReturns(7, args, resultValue);
   if (e == RT_OK) 
@@ -659,7 +673,7 @@ class rtEmit: public rtIFunction
 {
 
 public:
-  rtEmit(): mRefCount(0), mProcessingEvents(false), mPendingEntriesToAdd() {}
+  rtEmit(): mRefCount(0), mDispatchDepth(0), mPendingEntriesToAdd() {}
   virtual ~rtEmit() {}
 
   virtual unsigned long AddRef();
@@ -669,9 +683,18 @@ public:
   rtError addListener(const char* eventName, rtIFunction* f, bool emitOnce = false);
   rtError delListener(const char* eventName, rtIFunction* f);
 
-  rtError clearListeners() {mEntries.clear(); return RT_OK;}
+  rtError clearListeners();
   rtError clearListeners(const char* eventName);
 
+  // True if anything listens for eventName, so senders can skip building
+  // events nobody will see.  Senders on hot paths should pass names from
+  // rtString::intern, which are matched by pointer.
+  bool hasListeners(const char* eventName) const;
+  bool hasListeners(const rtString& eventName) const;
+
+  // Listeners across all events
+  size_t listenerCount() const;
+
   virtual rtError Send(int numArgs,const rtValue* args,rtValue* result);
   virtual rtError SendAsync(int numArgs, const rtValue* args);
 
@@ -688,6 +711,7 @@ public:
 
 private:
   void processPendingEvents();
+  void dispatch(int numArgs, const rtValue* args, rtValue* result);
 
 protected:
   struct _rtEmitEntry
@@ -699,10 +723,29 @@ protected:
     size_t fnHash;
     bool emitOnce;
   };
-  
-  std::vector<_rtEmitEntry> mEntries;
+
+  // Listeners are bucketed by event.  A bucket shares the text of its name
+  // if that name was interned, so looking it up by the interned name is a
+  // pointer compare; other names are compared as text.
+  struct _rtEmitEvent
+  {
+    rtString n;
+    std::vector<_rtEmitEntry> entries;
+  };
+
+  _rtEmitEvent* findEvent(const char* eventName);
+  const _rtEmitEvent* findEvent(const char* eventName) const;
+  _rtEmitEvent* findEvent(const rtString& eventName);
+  const _rtEmitEvent* findEvent(const rtString& eventName) const;
+  static bool hasLiveEntries(const _rtEmitEvent* ev);
+  void addEntry(const _rtEmitEntry& e);
+
+  // Buckets and entries are only erased or added once no Send is running,
+  // so dispatch can walk them in place; changes made by listeners are
+  // marked or queued in the meantime
+  std::vector<_rtEmitEvent> mEvents;
   rtAtomic mRefCount;
-  bool mProcessingEvents;
+  int mDispatchDepth;
   std::vector<_rtEmitEntry> mPendingEntriesToAdd;
 };
 
@@ -727,8 +770,13 @@ public:
   rtProperty(length, length, _setLength, uint32_t);
 
   rtArrayObject() {}
+
+  // instances come from a shared pool; subclasses fall back to the heap
+  static void* operator new(size_t size);
+  static void operator delete(void* p, size_t size);
   
   void empty();
+  void reserve(uint32_t n) { mElements.reserve(n); }
   void pushBack(rtValue v);
 
   virtual rtError Get(const char* name, rtValue* value) const;
@@ -753,21 +801,74 @@ struct rtNamedValue
 {
   rtString n;
   rtValue v;
+  uint32_t hash;
 };
 
+/**
+  Properties are kept in insertion order, which allKeys reports.  Small
+  maps are searched linearly; past kIndexThreshold properties an open
+  addressed hash index of their positions is maintained as well.
+*/
 class rtMapObject: public rtObject 
 {
 public:
   rtDeclareObject(rtMapObject, rtObject);
+
+  // instances come from a shared pool; subclasses fall back to the heap
+  static void* operator new(size_t size);
+  static void operator delete(void* p, size_t size);
   
   virtual rtError Get(const char* name, rtValue* value) const;
   virtual rtError Get(uint32_t /*i*/, rtValue* /*value*/) const;
   virtual rtError Set(const char* name, const rtValue* value);
   virtual rtError Set(uint32_t /*i*/, const rtValue* /*value*/);
 
+  // Bulk construction ... size for n properties up front and move values in
+  void reserve(uint32_t n);
+  using rtObjectBase::set;
+  rtError set(const char* name, rtValue&& value);
+
+  // Direct access in insertion order, for walking every property without
+  // a lookup per key
+  uint32_t count() const { return (uint32_t)mProps.size(); }
+  const rtString& keyAt(uint32_t i) const { return mProps[i].n; }
+  const rtValue& valueAt(uint32_t i) const { return mProps[i].v; }
+
+  // Drop every property but keep the storage for the next fill
+  void clear();
+
 private:
-  std::vector<rtNamedValue>::iterator find(const char* name);
+  enum { kIndexThreshold = 8 };
+
+  int32_t find(const char* name, uint32_t hash) const;
+  rtValue& insert(const char* name, uint32_t hash);
+  void rehash(size_t buckets);
+  void place(uint32_t i);
+
   std::vector<rtNamedValue> mProps;
+  std::vector<int32_t> mIndex; // positions in mProps, -1 when free
+};
+
+// Hands out event maps and takes them back once dispatch is over.  A map
+// is only reused when the caller's reference is the last one, i.e. no
+// listener (or script) kept hold of it.  Not thread safe; keep one per
+// dispatching thread.
+class rtMapObjectCache
+{
+public:
+  rtMapObjectCache(uint32_t maxCached = 4): mMaxCached(maxCached), mReused(0) {}
+
+  rtObjectRef get();
+  // Always releases e
+  void recycle(rtObjectRef& e);
+
+  uint32_t cached() const { return (uint32_t)mFree.size(); }
+  uint64_t reused() const { return mReused; }
+
+private:
+  uint32_t mMaxCached;
+  uint64_t mReused;
+  std::vector<rtRefT<rtMapObject> > mFree;
 };
 
 #endif
@@ -0,0 +1,224 @@
+/*
+
+ pxCore Copyright 2005-2018 John Robinson
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+// rtPool.h
+
+#ifndef RT_POOL_H
+#define RT_POOL_H
+
+#include "rtMutex.h"
+#include "rtLog.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <new>
+#include <vector>
+
+// Define DISABLE_RT_POOL to send every allocation straight to malloc, which
+// keeps heap checkers (valgrind, asan) able to see individual objects
+
+struct rtPoolStats
+{
+  const char* name;
+  size_t blockSize;
+  uint32_t slabs;
+  uint32_t inUse;
+  uint32_t peak;
+  uint64_t allocs;
+};
+
+// Fixed size block allocator.  Blocks are carved out of slabs that are kept
+// for the life of the process, so a steady stream of same sized objects
+// reuses the same few pages instead of fragmenting the heap.
+class rtPool
+{
+public:
+  // Pools are never destroyed since objects can still be released into
+  // them during static destruction
+  static rtPool* create(const char* name, size_t blockSize,
+                        uint32_t blocksPerSlab = 64)
+  {
+    rtPool* p = new rtPool(name, blockSize, blocksPerSlab);
+    rtMutexLockGuard lock(registryMutex());
+    registry().push_back(p);
+    return p;
+  }
+
+  void* alloc()
+  {
+#ifdef DISABLE_RT_POOL
+    void* b = malloc(mBlockSize);
+    if (!b)
+      throw std::bad_alloc();
+    rtMutexLockGuard lock(mMutex);
+#else
+    rtMutexLockGuard lock(mMutex);
+    if (!mFree)
+      grow();
+    void* b = mFree;
+    mFree = mFree->next;
+#endif
+    mAllocs++;
+    if (++mInUse > mPeak)
+      mPeak = mInUse;
+    return b;
+  }
+
+  void free(void* p)
+  {
+    if (!p)
+      return;
+#ifdef DISABLE_RT_POOL
+    ::free(p);
+    rtMutexLockGuard lock(mMutex);
+#else
+    rtMutexLockGuard lock(mMutex);
+    block* b = (block*)p;
+    b->next = mFree;
+    mFree = b;
+#endif
+    mInUse--;
+  }
+
+  size_t blockSize() const { return mBlockSize; }
+
+  rtPoolStats stats() const
+  {
+    rtMutexLockGuard lock(mMutex);
+    rtPoolStats s;
+    s.name = mName;
+    s.blockSize = mBlockSize;
+    s.slabs = (uint32_t)mSlabs.size();
+    s.inUse = mInUse;
+    s.peak = mPeak;
+    s.allocs = mAllocs;
+    return s;
+  }
+
+  static void allStats(std::vector<rtPoolStats>& stats)
+  {
+    rtMutexLockGuard lock(registryMutex());
+    stats.clear();
+    for (size_t i = 0; i < registry().size(); i++)
+      stats.push_back(registry()[i]->stats());
+  }
+
+  static void dumpStats()
+  {
+    std::vector<rtPoolStats> stats;
+    allStats(stats);
+    for (size_t i = 0; i < stats.size(); i++)
+    {
+      const rtPoolStats& s = stats[i];
+      if (s.allocs == 0)
+        continue;
+      rtLogInfo("pool %s(%u): %u in use, %u peak, %u slabs, %llu allocs",
+                s.name, (uint32_t)s.blockSize, s.inUse, s.peak, s.slabs,
+                (unsigned long long)s.allocs);
+    }
+  }
+
+private:
+  struct block { block* next; };
+
+  rtPool(const char* name, size_t blockSize, uint32_t blocksPerSlab)
+    : mName(name), mBlockSize((blockSize + 15) & ~(size_t)15),
+      mBlocksPerSlab(blocksPerSlab ? blocksPerSlab : 1), mFree(NULL),
+      mInUse(0), mPeak(0), mAllocs(0) {}
+
+  rtPool(const rtPool&);
+  rtPool& operator=(const rtPool&);
+
+  void grow()
+  {
+    char* slab = (char*)malloc(mBlockSize * mBlocksPerSlab);
+    if (!slab)
+      throw std::bad_alloc();
+    mSlabs.push_back(slab);
+    for (uint32_t i = mBlocksPerSlab; i > 0; i--)
+    {
+      block* b = (block*)(slab + (i - 1) * mBlockSize);
+      b->next = mFree;
+      mFree = b;
+    }
+  }
+
+  static std::vector<rtPool*>& registry()
+  {
+    static std::vector<rtPool*>* r = new std::vector<rtPool*>;
+    return *r;
+  }
+
+  static rtMutex& registryMutex()
+  {
+    static rtMutex* m = new rtMutex;
+    return *m;
+  }
+
+  const char* mName;
+  size_t mBlockSize;
+  uint32_t mBlocksPerSlab;
+  block* mFree;
+  std::vector<char*> mSlabs;
+  uint32_t mInUse;
+  uint32_t mPeak;
+  uint64_t mAllocs;
+  mutable rtMutex mMutex;
+};
+
+// A set of rtPools in steps of kGranularity bytes, for class hierarchies
+// whose instances come in many sizes.  Anything bigger than maxSize goes to
+// the regular heap.
+class rtSizedPool
+{
+public:
+  enum { kGranularity = 32 };
+
+  rtSizedPool(const char* name, size_t maxSize, uint32_t blocksPerSlab = 32)
+  {
+    size_t classes = (maxSize + kGranularity - 1) / kGranularity;
+    for (size_t i = 1; i <= classes; i++)
+      mPools.push_back(rtPool::create(name, i * kGranularity, blocksPerSlab));
+  }
+
+  void* alloc(size_t size)
+  {
+    rtPool* p = pool(size);
+    return p ? p->alloc() : ::operator new(size);
+  }
+
+  void free(void* ptr, size_t size)
+  {
+    rtPool* p = pool(size);
+    if (p)
+      p->free(ptr);
+    else
+      ::operator delete(ptr);
+  }
+
+private:
+  rtPool* pool(size_t size) const
+  {
+    size_t i = (size + kGranularity - 1) / kGranularity;
+    return (i > 0 && i <= mPools.size()) ? mPools[i - 1] : NULL;
+  }
+
+  std::vector<rtPool*> mPools;
+};
+
+#endif // RT_POOL_H
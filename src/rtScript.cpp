@@ -26,6 +26,8 @@
 
 #include "assert.h"
 
+#include <chrono>
+
 #if defined RTSCRIPT_SUPPORT_NODE || defined RTSCRIPT_SUPPORT_V8
 #include "rtScriptV8/rtScriptV8Node.h"
 #endif
@@ -60,6 +62,65 @@ args_t *s_gArgs;
 
 static int sLockCount;
 
+// Contention counters, only touched by the thread holding the lock
+static rtSceneLockStats sLockStats;
+static std::chrono::steady_clock::time_point sHoldStart;
+
+static double secondsSince(const std::chrono::steady_clock::time_point& t)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+}
+
+// Called with the lock just taken on the outermost enter; waitSeconds is 0
+// when it was free
+static void sceneLockAcquired(double waitSeconds)
+{
+  sLockStats.acquisitions++;
+  if (waitSeconds > 0)
+  {
+    sLockStats.contended++;
+    sLockStats.waitSeconds += waitSeconds;
+    if (waitSeconds > sLockStats.maxWaitSeconds)
+      sLockStats.maxWaitSeconds = waitSeconds;
+  }
+  sHoldStart = std::chrono::steady_clock::now();
+}
+
+// Called on the outermost exit, before the lock is released
+static void sceneLockReleasing()
+{
+  double held = secondsSince(sHoldStart);
+  sLockStats.holdSeconds += held;
+  if (held > sLockStats.maxHoldSeconds)
+    sLockStats.maxHoldSeconds = held;
+}
+
+#ifndef USE_STD_THREADS
+static void sceneLockMutex(pthread_mutex_t* m)
+{
+  if (pthread_mutex_trylock(m) == 0)
+  {
+    sceneLockAcquired(0);
+    return;
+  }
+  std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+  int r = pthread_mutex_lock(m);
+  assert(r == 0);
+  (void)r;
+  sceneLockAcquired(secondsSince(t));
+}
+#endif
+
+void rtWrapperSceneLockStats(rtSceneLockStats& stats)
+{
+  stats = sLockStats;
+}
+
+void rtWrapperSceneLockStatsReset()
+{
+  sLockStats = rtSceneLockStats();
+}
+
 bool rtWrapperSceneUpdateHasLock()
 {
 #ifdef USE_STD_THREADS
@@ -92,7 +153,14 @@ void rtWrapperSceneUpdateEnter()
     else 
     {
       //printf("rtWrapperSceneUpdateEnter locking\n");
-      uv_mutex_lock(&threadMutex);
+      if (uv_mutex_trylock(&threadMutex) == 0)
+        sceneLockAcquired(0);
+      else
+      {
+        std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+        uv_mutex_lock(&threadMutex);
+        sceneLockAcquired(secondsSince(t));
+      }
       //printf("rtWrapperSceneUpdateEnter GOT LOCK!!!\n");
       sCurrentSceneThread = pthread_self();
       sLockCount++;
@@ -101,11 +169,17 @@ void rtWrapperSceneUpdateEnter()
 #endif //USE_STD_THREADS
 
 #else // RUNINMAIN
+  // Binding calls made while a frame holds the lock only count the nesting
+  if (rtWrapperSceneUpdateHasLock())
+  {
+    sLockCount++;
+    return;
+  }
 #ifdef USE_STD_THREADS
   std::unique_lock<std::mutex> lock(sSceneLock);
   sCurrentSceneThread = std::this_thread::get_id();
 #else
-  assert(pthread_mutex_lock(&sSceneLock) == 0);
+  sceneLockMutex(&sSceneLock);
   sCurrentSceneThread = pthread_self();
 #endif
   sLockCount++;
@@ -140,6 +214,7 @@ void rtWrapperSceneUpdateExit()
   // Main thread is now NOT the node thread
   if (sLockCount == 0) {
     //printf("rtWrapperSceneUpdateExit unlocking\n");
+    sceneLockReleasing();
     uv_mutex_unlock(&threadMutex);
   }
 
@@ -151,23 +226,24 @@ void rtWrapperSceneUpdateExit()
   assert(rtWrapperSceneUpdateHasLock());
 #endif //RT_USE_SINGLE_RENDER_THREAD
 
-  sLockCount--;
-#ifdef USE_STD_THREADS
-  if (sLockCount == 0)
-    sCurrentSceneThread = std::thread::id();
-#else
-  if (sLockCount == 0)
-    sCurrentSceneThread = 0;
-#endif
-
+  if (--sLockCount > 0)
+    return;
 #ifdef USE_STD_THREADS
+  // sSceneLock isn't held between enter and exit here, so there is no
+  // acquire or hold time to record
+  sCurrentSceneThread = std::thread::id();
   std::unique_lock<std::mutex> lock(sSceneLock);
 #else
-  assert(pthread_mutex_unlock(&sSceneLock) == 0);
+  sceneLockReleasing();
+  sCurrentSceneThread = 0;
+  int r = pthread_mutex_unlock(&sSceneLock);
+  assert(r == 0);
+  (void)r;
 #endif
 #endif // RUNINMAIN
 }
 
+
 rtScript::rtScript():mInitialized(false)  {}
 rtScript::~rtScript() {}
 
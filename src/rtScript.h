@@ -29,6 +29,27 @@ bool rtWrapperSceneUpdateHasLock();
 void rtWrapperSceneUpdateEnter();
 void rtWrapperSceneUpdateExit();
 
+// Counts for the outermost acquisitions of the scene lock; nested enters
+// from the owning thread are free and not counted.  Builds with
+// USE_STD_THREADS don't hold the lock across enter and exit and leave
+// these at 0
+struct rtSceneLockStats
+{
+  rtSceneLockStats()
+    : acquisitions(0), contended(0), waitSeconds(0), maxWaitSeconds(0),
+      holdSeconds(0), maxHoldSeconds(0) {}
+
+  uint64_t acquisitions;
+  uint64_t contended;      // acquisitions that had to wait for another thread
+  double waitSeconds;
+  double maxWaitSeconds;
+  double holdSeconds;
+  double maxHoldSeconds;
+};
+
+void rtWrapperSceneLockStats(rtSceneLockStats& stats);
+void rtWrapperSceneLockStatsReset();
+
 #ifndef ENABLE_DEBUG_MODE
 typedef struct args_
 {
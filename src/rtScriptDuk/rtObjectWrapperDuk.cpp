@@ -365,6 +365,29 @@ void rtObjectWrapper::createFromObjectReference(duk_context *ctx, const rtObject
     rtError err = const_cast<rtObjectRef &>(ref).sendReturns<rtString>("description", desc);
     if (err == RT_OK && strcmp(desc.cString(), "rtMapObject") == 0)
     {
+      // local map ... walk the properties directly
+      rtMapObject* map = dynamic_cast<rtMapObject*>(ref.getPtr());
+      if (map)
+      {
+        (void)duk_push_object(ctx);
+
+        for (uint32_t i = 0; i < map->count(); ++i)
+        {
+          const char* key = map->keyAt(i).cString();
+          if (strcmp(key, "allKeys") == 0)
+            continue;
+
+          rt2duk(ctx, map->valueAt(i));
+          duk_bool_t rc = duk_put_prop_string(ctx, -2, key);
+          assert(rc);
+
+          // [obj]
+        }
+
+        // [obj]
+        return;
+      }
+
       rtObjectRef keys = ref.get<rtObjectRef>("allKeys");
       if (keys)
       {
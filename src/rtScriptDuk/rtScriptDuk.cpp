@@ -99,6 +99,9 @@ extern "C" {
 
 #include "rtScript.h"
 #include "rtPathUtils.h"
+#ifdef ENABLE_HTTP_CACHE
+#include "rtFileCache.h"
+#endif
 
 // TODO eliminate std::string
 #include <string>
@@ -824,6 +827,35 @@ static duk_ret_t duv_loadlib(duk_context *ctx) {
   return 1;
 }
 
+#ifdef ENABLE_HTTP_CACHE
+static duk_ret_t duv_load_function(duk_context *ctx) {
+  duk_load_function(ctx);
+  return 1;
+}
+
+// Bytecode of a module compiled on a previous run, if the cache has it.
+// Leaves the function on the stack and returns true on success.
+// Duktape trusts the bytecode it loads; rtCodeCache only hands back entries
+// from a private directory whose checksum matches.
+static bool duv_mod_load_cached(duk_context *ctx, const rtString& key) {
+  rtData data;
+  if (RT_OK != rtCodeCache::instance()->data(key, data)) {
+    return false;
+  }
+
+  void *buf = duk_push_fixed_buffer(ctx, data.length());
+  memcpy(buf, data.data(), data.length());
+
+  if (DUK_EXEC_SUCCESS != duk_safe_call(ctx, duv_load_function, 1, 1)) {
+    rtLogWarn("bytecode cache for '%s' rejected: %s", key.cString(), duk_safe_to_string(ctx, -1));
+    duk_pop(ctx);
+    rtCodeCache::instance()->removeData(key);
+    return false;
+  }
+  return true;
+}
+#endif
+
 // Given a module and js code, compile the code and execute as CJS module
 // return the result of the compiled code ran as a function.
 static duk_ret_t duv_mod_compile(duk_context *ctx) {
@@ -840,15 +872,44 @@ static duk_ret_t duv_mod_compile(duk_context *ctx) {
   duk_push_this(ctx);
   duk_get_prop_string(ctx, -1, "id");
 
-  // Wrap the code
-  duk_push_string(ctx, "function(){var module=this,exports=this.exports,require=this.require.bind(this);");
-  duk_dup(ctx, 0);
-  duk_push_string(ctx, "}");
-  duk_concat(ctx, 3);
-  duk_insert(ctx, -2);
+#ifdef ENABLE_HTTP_CACHE
+  // Cached bytecode is keyed by module id, Duktape version and source
+  rtString key;
+  if (rtCodeCache::instance()->enabled()) {
+    duk_size_t length = 0;
+    const char *code = duk_get_lstring(ctx, 0, &length);
+    std::stringstream engine;
+    engine << "duktape " << DUK_VERSION << "|" << duk_get_string(ctx, -1);
+    key = rtCodeCache::cacheKey(code, length, engine.str().c_str());
+  }
 
-  // Compile to a function
-  duk_compile(ctx, DUK_COMPILE_FUNCTION);
+  if (!key.isEmpty() && duv_mod_load_cached(ctx, key)) {
+    duk_remove(ctx, -2);
+  }
+  else
+#endif
+  {
+    // Wrap the code
+    duk_push_string(ctx, "function(){var module=this,exports=this.exports,require=this.require.bind(this);");
+    duk_dup(ctx, 0);
+    duk_push_string(ctx, "}");
+    duk_concat(ctx, 3);
+    duk_insert(ctx, -2);
+
+    // Compile to a function
+    duk_compile(ctx, DUK_COMPILE_FUNCTION);
+
+#ifdef ENABLE_HTTP_CACHE
+    if (!key.isEmpty()) {
+      duk_size_t size = 0;
+      duk_dup(ctx, -1);
+      duk_dump_function(ctx);
+      const uint8_t *bytecode = (const uint8_t *)duk_get_buffer(ctx, -1, &size);
+      rtCodeCache::instance()->addToCache(key, bytecode, (uint32_t)size);
+      duk_pop(ctx);
+    }
+#endif
+  }
 
   duk_push_this(ctx);
   duk_call_method(ctx, 0);
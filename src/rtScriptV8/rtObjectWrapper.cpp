@@ -22,6 +22,8 @@ limitations under the License.
 
 #include <rtLog.h>
 
+#include <map>
+
 using namespace v8;
 
 namespace rtScriptV8NodeUtils
@@ -51,6 +53,19 @@ static Handle<Value> makeIntegerFromKey(Isolate* isolate, rtObjectRef& , uint32_
 
 static Persistent<Function> ctor;
 
+#if defined ENABLE_NODE_V_6_9 || defined RTSCRIPT_SUPPORT_V8
+typedef std::pair<Isolate*, rtMethodMap*> classTemplateKey;
+static std::map<classTemplateKey, Persistent<FunctionTemplate>* > classTemplates;
+
+// Classes whose Get/Set serve names that are not in their rtMethodMap
+static bool hasDynamicProperties(const rtString& className)
+{
+  return className.compare("rtMapObject") == 0 ||
+         className.compare("rtArrayObject") == 0 ||
+         className.compare("pxObjectChildren") == 0;
+}
+#endif
+
 rtObjectWrapper::rtObjectWrapper(const rtObjectRef& ref)
   : rtWrapper(ref)
 {
@@ -69,6 +84,15 @@ void rtObjectWrapper::destroyPrototype()
     ctor.ClearWeak();
     ctor.Reset();
   }
+#if defined ENABLE_NODE_V_6_9 || defined RTSCRIPT_SUPPORT_V8
+  for (std::map<classTemplateKey, Persistent<FunctionTemplate>* >::iterator it = classTemplates.begin();
+       it != classTemplates.end(); ++it)
+  {
+    it->second->Reset();
+    delete it->second;
+  }
+  classTemplates.clear();
+#endif
 }
 
 void rtObjectWrapper::exportPrototype(Isolate* isolate, Handle<Object> exports)
@@ -104,6 +128,155 @@ void rtObjectWrapper::exportPrototype(Isolate* isolate, Handle<Object> exports)
   exports->Set(String::NewFromUtf8(isolate, kClassName), tmpl->GetFunction());
 }
 
+#if defined ENABLE_NODE_V_6_9 || defined RTSCRIPT_SUPPORT_V8
+Local<FunctionTemplate> rtObjectWrapper::classTemplate(Isolate* isolate, rtMethodMap* map)
+{
+  classTemplateKey key(isolate, map);
+  std::map<classTemplateKey, Persistent<FunctionTemplate>* >::iterator it = classTemplates.find(key);
+  if (it != classTemplates.end())
+    return PersistentToLocal(isolate, *it->second);
+
+  EscapableHandleScope scope(isolate);
+
+  Local<FunctionTemplate> tmpl = FunctionTemplate::New(isolate, create);
+  tmpl->SetClassName(String::NewFromUtf8(isolate, map->className));
+  if (map->parentsMap)
+    tmpl->Inherit(classTemplate(isolate, map->parentsMap));
+
+  // Declared names resolve on the prototype; the interceptors only see
+  // names no prototype has, such as ones added at runtime
+  Local<ObjectTemplate> inst = tmpl->InstanceTemplate();
+  inst->SetInternalFieldCount(1);
+  inst->SetHandler(NamedPropertyHandlerConfiguration(
+      &getDynamicProperty,
+      &setDynamicProperty,
+      NULL,
+      NULL,
+      &getEnumerablePropertyNames,
+      Local<Value>(),
+      static_cast<PropertyHandlerFlags>(
+        static_cast<int>(PropertyHandlerFlags::kNonMasking) |
+        static_cast<int>(PropertyHandlerFlags::kOnlyInterceptStrings))));
+  inst->SetIndexedPropertyHandler(
+      &getPropertyByIndex,
+      &setPropertyByIndex,
+      NULL,
+      NULL,
+      &getEnumerablePropertyIndecies);
+
+  // Enumeration keeps going through allKeys, so the prototype members are
+  // not enumerable
+  Local<ObjectTemplate> proto = tmpl->PrototypeTemplate();
+  Local<Signature> signature = Signature::New(isolate, tmpl);
+  for (rtPropertyEntry* e = map->getFirstProperty(); e; e = e->mNext)
+  {
+    Local<External> data = External::New(isolate, e);
+    Local<FunctionTemplate> getter = FunctionTemplate::New(isolate, getDeclaredProperty, data, signature);
+    Local<FunctionTemplate> setter;
+    if (e->mSetThunk)
+      setter = FunctionTemplate::New(isolate, setDeclaredProperty, data, signature);
+    proto->SetAccessorProperty(String::NewFromUtf8(isolate, e->mPropertyName), getter, setter, DontEnum);
+  }
+  for (rtMethodEntry* e = map->getFirstMethod(); e; e = e->mNext)
+  {
+    Local<External> data = External::New(isolate, e);
+    Local<FunctionTemplate> getter = FunctionTemplate::New(isolate, getDeclaredMethod, data, signature);
+    proto->SetAccessorProperty(String::NewFromUtf8(isolate, e->mMethodName), getter,
+                               Local<FunctionTemplate>(), DontEnum);
+  }
+
+  classTemplates[key] = new Persistent<FunctionTemplate>(isolate, tmpl);
+  return scope.Escape(tmpl);
+}
+
+void rtObjectWrapper::getDeclaredProperty(const FunctionCallbackInfo<Value>& args)
+{
+  Isolate* isolate = args.GetIsolate();
+  HandleScope handleScope(isolate);
+
+  rtObjectRef ref = unwrap(args.Holder());
+  if (!ref)
+    return;
+
+  rtPropertyEntry* e = static_cast<rtPropertyEntry*>(args.Data().As<External>()->Value());
+
+  // rtObject::Get would find the same entry by name; skip the search
+  rtValue value;
+  rtWrapperSceneUpdateEnter();
+  rtObject* obj = dynamic_cast<rtObject*>(ref.getPtr());
+  rtError err = obj ? (obj->*e->mGetThunk)(value) : ref->Get(e->mPropertyName, &value);
+  rtWrapperSceneUpdateExit();
+
+  if (err == RT_OK)
+  {
+    Local<Context> ctx = args.Holder()->CreationContext();
+    args.GetReturnValue().Set(rt2js(ctx, value));
+  }
+  else if (err != RT_PROP_NOT_FOUND)
+    throwRtError(isolate, err, "failed to get %s", e->mPropertyName);
+}
+
+void rtObjectWrapper::setDeclaredProperty(const FunctionCallbackInfo<Value>& args)
+{
+  Isolate* isolate = args.GetIsolate();
+  HandleScope handleScope(isolate);
+  Local<Context> ctx = args.Holder()->CreationContext();
+
+  rtPropertyEntry* e = static_cast<rtPropertyEntry*>(args.Data().As<External>()->Value());
+
+  rtWrapperError error;
+  rtValue value = js2rt(ctx, args[0], &error);
+  if (error.hasError())
+  {
+    isolate->ThrowException(error.toTypeError(isolate));
+    return;
+  }
+
+  // Through Set so that classes overriding it still see every change
+  rtWrapperSceneUpdateEnter();
+  rtError err = unwrap(args.Holder())->Set(e->mPropertyName, &value);
+  rtWrapperSceneUpdateExit();
+  if (err != RT_OK)
+    rtLogDebug("failed to set %s: %s", e->mPropertyName, rtStrError(err));
+}
+
+void rtObjectWrapper::getDeclaredMethod(const FunctionCallbackInfo<Value>& args)
+{
+  Isolate* isolate = args.GetIsolate();
+  HandleScope handleScope(isolate);
+
+  rtObjectRef ref = unwrap(args.Holder());
+  if (!ref)
+    return;
+
+  rtMethodEntry* e = static_cast<rtMethodEntry*>(args.Data().As<External>()->Value());
+
+  rtFunctionRef f;
+  rtObject* obj = dynamic_cast<rtObject*>(ref.getPtr());
+  if (obj)
+    f = new rtObjectFunction(obj, e->mThunk);
+  else
+    f = ref.get<rtFunctionRef>(e->mMethodName);
+
+  if (!f)
+    return throwRtError(isolate, RT_PROP_NOT_FOUND, "failed to get %s", e->mMethodName);
+  Local<Context> ctx = args.Holder()->CreationContext();
+  args.GetReturnValue().Set(rt2js(ctx, rtValue(f)));
+}
+
+void rtObjectWrapper::getDynamicProperty(Local<Name> prop, const PropertyCallbackInfo<Value>& info)
+{
+  rtString name = toString(prop.As<String>());
+  getProperty(name.cString(), info);
+}
+
+void rtObjectWrapper::setDynamicProperty(Local<Name> prop, Local<Value> val, const PropertyCallbackInfo<Value>& info)
+{
+  rtString name = toString(prop.As<String>());
+  setProperty(name.cString(), val, info);
+}
+#endif
+
 Handle<Object> rtObjectWrapper::createFromObjectReference(v8::Local<v8::Context>& ctx, const rtObjectRef& ref)
 {
   Isolate* isolate(ctx->GetIsolate());
@@ -149,6 +322,20 @@ Handle<Object> rtObjectWrapper::createFromObjectReference(v8::Local<v8::Context>
   // rtMapObject
   if (err == RT_OK && desc.compare("rtMapObject") == 0)
   {
+    // local map ... walk the properties directly
+    rtMapObject* map = dynamic_cast<rtMapObject*>(ref.getPtr());
+    if (map)
+    {
+      obj = Object::New(isolate);
+      for (uint32_t i = 0; i < map->count(); ++i)
+      {
+        const char* key = map->keyAt(i).cString();
+        if (strcmp(key, kFuncAllKeys) != 0)
+          obj->Set(String::NewFromUtf8(isolate, key), rt2js(ctx, map->valueAt(i)));
+      }
+      return scope.Escape(obj);
+    }
+
     rtValue allKeys;
     if (ref->Get(kFuncAllKeys, &allKeys) != RT_PROP_NOT_FOUND)
     {
@@ -201,10 +388,15 @@ Handle<Object> rtObjectWrapper::createFromObjectReference(v8::Local<v8::Context>
     External::New(isolate, ref.getPtr())
   };
 
-  Local<Function> func = PersistentToLocal(isolate, ctor);
+  Local<Function> func;
 #if defined ENABLE_NODE_V_6_9 || defined RTSCRIPT_SUPPORT_V8
+  if (err == RT_OK && !hasDynamicProperties(desc))
+    func = classTemplate(isolate, ref.getPtr()->getMap())->GetFunction(ctx).FromMaybe(Local<Function>());
+  if (func.IsEmpty())
+    func = PersistentToLocal(isolate, ctor);
   obj = (func->NewInstance(ctx, 1, argv)).FromMaybe(Local<Object>());
 #else
+  func = PersistentToLocal(isolate, ctor);
   obj = func->NewInstance(1, argv);
 #endif
 
@@ -434,6 +626,36 @@ rtError jsObjectWrapper::getAllKeys(Isolate* isolate, rtValue* value) const
   return RT_OK;
 }
 
+// Every enumerable property in one pass, for rtObjectBase::set
+rtError jsObjectWrapper::allProperties(rtValue& value) const
+{
+  if (mIsArray)
+    return RT_ERROR_NOT_IMPLEMENTED;
+
+  Locker locker(mIsolate);
+  Isolate::Scope isolate_scope(mIsolate);
+  HandleScope handleScope(mIsolate);
+  Local<Object> self = PersistentToLocal(mIsolate, mObject);
+  Local<Array> names = self->GetPropertyNames();
+  Local<Context> ctx = self->CreationContext();
+
+  uint32_t n = names->Length();
+  rtRefT<rtMapObject> result(new rtMapObject);
+  result->reserve(n);
+  for (uint32_t i = 0; i < n; ++i)
+  {
+    Local<Value> name = names->Get(i);
+    rtWrapperError error;
+    rtValue val = js2rt(ctx, self->Get(name), &error);
+    if (error.hasError())
+      return RT_FAIL;
+    result->set(toString(name).cString(), std::move(val));
+  }
+
+  value = rtValue(result);
+  return RT_OK;
+}
+
 rtError jsObjectWrapper::Get(const char* name, rtValue* value) const
 {
   Locker locker(mIsolate);
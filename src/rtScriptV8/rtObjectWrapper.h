@@ -47,6 +47,20 @@ public:
 private:
   static void create(const FunctionCallbackInfo<Value>& args);
 
+#if defined ENABLE_NODE_V_6_9 || defined RTSCRIPT_SUPPORT_V8
+  // Per class templates with the rtMethodMap's properties and methods as
+  // accessors on the prototype.  Methods read as functions bound to their
+  // object, so they still work when copied onto another receiver.
+  static Local<FunctionTemplate> classTemplate(Isolate* isolate, rtMethodMap* map);
+
+  static void getDeclaredProperty(const FunctionCallbackInfo<Value>& args);
+  static void setDeclaredProperty(const FunctionCallbackInfo<Value>& args);
+  static void getDeclaredMethod(const FunctionCallbackInfo<Value>& args);
+
+  static void getDynamicProperty(Local<Name> prop, const PropertyCallbackInfo<Value>& info);
+  static void setDynamicProperty(Local<Name> prop, Local<Value> val, const PropertyCallbackInfo<Value>& info);
+#endif
+
   static void getPropertyByName(Local<String> prop, const PropertyCallbackInfo<Value>& info);
   static void setPropertyByName(Local<String> prop, Local<Value> val, const PropertyCallbackInfo<Value>& info);
   static void getEnumerablePropertyNames(const PropertyCallbackInfo<Array>& info);
@@ -72,7 +86,7 @@ private:
 #endif
 };
 
-class jsObjectWrapper : public rtIObject
+class jsObjectWrapper : public rtIObject, public rtIPropertySnapshot
 {
 public:
   jsObjectWrapper(v8::Isolate* isolate, const Handle<Value>& val, bool isArray);
@@ -91,6 +105,7 @@ public:
   virtual rtError Set(const char* name, const rtValue* value);
   virtual rtError Set(uint32_t i, const rtValue* value);
   virtual rtMethodMap* getMap() const { return NULL; }
+  virtual rtError allProperties(rtValue& value) const;
   Local<Object> getWrappedObject();
 
 private:
@@ -642,13 +642,13 @@ rtNodeContext::~rtNodeContext()
   #endif
       mEnv = NULL;
       #ifndef USE_CONTEXTIFY_CLONES
-      HandleMap::clearAllForContext(mId);
+      HandleMap::clearAllForContext(mIsolate, mId);
       #endif
     }
     else
     {
     // clear out persistent javascript handles
-      HandleMap::clearAllForContext(mId);
+      HandleMap::clearAllForContext(mIsolate, mId);
 #if defined(ENABLE_NODE_V_6_9) && defined(USE_CONTEXTIFY_CLONES)
       node::deleteContextifyContext(mContextifyContext);
 #endif
@@ -858,10 +858,18 @@ rtError rtNodeContext::runScript(const char* script, rtValue* retVal /*= NULL*/,
   TryCatch tryCatch;
 #endif // ENABLE_NODE_V_6_9
 #endif
-    Local<String> source = String::NewFromUtf8(mIsolate, script);
-
     // Compile the source code.
+#ifdef ENABLE_NODE_V_6_9
+    Local<Script> run_script;
+    if (!compileWithCodeCache(local_context, script, NULL).ToLocal(&run_script))
+    {
+      rtLogWarn("script compilation failed");
+      return RT_FAIL;
+    }
+#else
+    Local<String> source = String::NewFromUtf8(mIsolate, script);
     Local<Script> run_script = Script::Compile(source);
+#endif
 
     // Run the script to get the result.
     Local<Value> result = run_script->Run();
@@ -1255,6 +1263,7 @@ rtError rtScriptNode::term()
   if(node_isolate)
   {
     rtLogWarn("\n++++++++++++++++++ DISPOSE\n\n");
+    HandleMap::clearAllForIsolate(mIsolate);
     node_isolate = NULL;
     mIsolate     = NULL;
   }
@@ -498,12 +498,9 @@ Local<Value> rtV8Context::loadV8Module(const rtString &name)
   contents1.append(contents.cString());
   contents1.append("; return this.exports; })");
 
-  v8::Local<v8::String> source =
-    v8::String::NewFromUtf8(mIsolate, contents1.cString(), v8::NewStringType::kNormal).ToLocalChecked();
-
   TryCatch tryCatch(mIsolate);
 
-  v8::MaybeLocal<v8::Script> script = v8::Script::Compile(localContext, source);
+  v8::MaybeLocal<v8::Script> script = compileWithCodeCache(localContext, contents1.cString(), path.cString());
 
   if (script.IsEmpty()) {
     rtLogWarn("module '%s' compilation failed (%s)", name.cString(), getTryCatchResult(localContext, tryCatch).cString());
@@ -693,10 +690,15 @@ rtError rtV8Context::runScript(const char *script, rtValue* retVal /*= NULL*/, c
     Context::Scope context_scope(local_context);
     // !CLF TODO: TEST FOR MT
     TryCatch tryCatch(mIsolate);
-    Local<String> source = String::NewFromUtf8(mIsolate, script);
 
     // Compile the source code.
-    Local<Script> run_script = Script::Compile(source);
+    Local<Script> run_script;
+    if (!compileWithCodeCache(local_context, script, NULL).ToLocal(&run_script)) {
+      String::Utf8Value trace(tryCatch.StackTrace());
+      rtLogWarn("%s", *trace);
+
+      return RT_FAIL;
+    }
 
     // Run the script to get the result.
     Local<Value> result = run_script->Run();
@@ -829,6 +831,7 @@ rtError rtScriptV8::init()
 rtError rtScriptV8::term()
 {
   if (mV8Initialized == true) {
+    HandleMap::clearAllForIsolate(mIsolate);
     V8::ShutdownPlatform();
     if (mPlatform) {
       delete mPlatform;
@@ -1276,9 +1279,20 @@ namespace rtScriptV8NodeUtils
     Local<Context> local_context = isolate->GetCurrentContext();
     Context::Scope context_scope(local_context);
 
+    rtString fileName;
+    if (args.Length() >= 3 && args[2]->IsObject()) {
+      Local<Value> name = args[2].As<Object>()->Get(String::NewFromUtf8(isolate, "filename"));
+      if (name->IsString())
+        fileName = toString(name);
+    }
+
     TryCatch tryCatch(isolate);
-    Local<String> source = String::NewFromUtf8(isolate, sourceCode.cString());
-    Local<Script> run_script = Script::Compile(source);
+    Local<Script> run_script;
+    if (!compileWithCodeCache(local_context, sourceCode.cString(), fileName.cString()).ToLocal(&run_script)) {
+      String::Utf8Value trace(tryCatch.StackTrace());
+      rtLogWarn("uvRunInContext: compilation failed '%s'", *trace);
+      return;
+    }
     Local<Value> result = run_script->Run();
 
     if (tryCatch.HasCaught()) {
@@ -1386,8 +1400,7 @@ namespace rtScriptV8NodeUtils
         v8ModuleBindings[i].mName, NewStringType::kNormal).ToLocalChecked(), fTemplate->GetFunction());
     }
 
-    Local<String> source = String::NewFromUtf8(isolate, sourceCode.cString());
-    MaybeLocal<Script> run_script = Script::Compile(toContext, source);
+    MaybeLocal<Script> run_script = compileWithCodeCache(toContext, sourceCode.cString(), NULL);
     if (run_script.IsEmpty()) {
       rtLogWarn("uvRunInNewContext: compilation failed");
       return;
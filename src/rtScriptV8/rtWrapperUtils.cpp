@@ -23,19 +23,10 @@ limitations under the License.
 extern uv_mutex_t threadMutex;
 #endif
 #include <rtMutex.h>
-
-#ifdef __APPLE__
-#ifndef RUNINMAIN
-static pthread_mutex_t sObjectMapMutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER; //PTHREAD_MUTEX_INITIALIZER;
-#endif //!RUNINMAIN
-#elif defined(USE_STD_THREADS)
-#include <thread>
-#include <mutex>
-#else
-#ifndef RUNINMAIN
-static pthread_mutex_t sObjectMapMutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
-#endif //!RUNINMAIN
+#ifdef ENABLE_HTTP_CACHE
+#include <rtFileCache.h>
 #endif
+#include <unordered_map>
 
 using namespace std;
 
@@ -44,6 +35,7 @@ using namespace std;
 namespace rtScriptV8NodeUtils
 {
 
+const int HandleMap::kIsolateDataIndex = 1;
 const int HandleMap::kContextIdIndex = 2;
 
 struct ObjectReference
@@ -53,8 +45,21 @@ struct ObjectReference
   uint32_t           CreationContextId;
 };
 
-typedef std::map< rtIObject*, ObjectReference*  > ObjectReferenceMap;
-static ObjectReferenceMap objectMap;
+// There is one map per isolate, kept in the isolate's data slot.  It is only
+// used with that isolate locked (its handles need the lock anyway), so it
+// needs no lock of its own and scenes in different isolates never contend.
+typedef std::unordered_map< rtIObject*, ObjectReference*  > ObjectReferenceMap;
+
+static ObjectReferenceMap& objectMapForIsolate(Isolate* isolate)
+{
+  ObjectReferenceMap* objectMap = static_cast<ObjectReferenceMap*>(isolate->GetData(HandleMap::kIsolateDataIndex));
+  if (!objectMap)
+  {
+    objectMap = new ObjectReferenceMap;
+    isolate->SetData(HandleMap::kIsolateDataIndex, objectMap);
+  }
+  return *objectMap;
+}
 
 uint32_t
 GetContextId(Local<Context>& ctx)
@@ -66,17 +71,12 @@ GetContextId(Local<Context>& ctx)
   assert(!val.IsEmpty());
   return val->Uint32Value();
 }
-#if defined ENABLE_NODE_V_6_9 || defined RTSCRIPT_SUPPORT_V8
-static void WeakCallback(const WeakCallbackInfo<rtIObject>& data) {
-  Locker locker(data.GetIsolate());
-  Isolate::Scope isolateScope(data.GetIsolate());
-  HandleScope handleScope(data.GetIsolate());
+
+static void releaseWeakReference(Isolate* isolate, rtIObject* from)
+{
   rtObjectRef temp;
-rtWrapperSceneUpdateEnter();
-#ifndef RUNINMAIN
-  pthread_mutex_lock(&sObjectMapMutex);
-#endif
-  ObjectReferenceMap::iterator j = objectMap.find(data.GetParameter());
+  ObjectReferenceMap& objectMap = objectMapForIsolate(isolate);
+  ObjectReferenceMap::iterator j = objectMap.find(from);
   if (j != objectMap.end())
   {
     // TODO: Removing this temporarily until we understand how this callback works. I
@@ -92,12 +92,9 @@ rtWrapperSceneUpdateEnter();
   }
   else
   {
-    rtLogWarn("failed to find:%p in map", data.GetParameter());
+    rtLogWarn("failed to find:%p in map", from);
   }
-rtWrapperSceneUpdateExit();
-#ifndef RUNINMAIN
-  pthread_mutex_unlock(&sObjectMapMutex);
-#endif
+
   if (NULL != temp.getPtr())
   {
     rtObjectRef parentRef;
@@ -111,13 +108,20 @@ rtWrapperSceneUpdateExit();
     }
   }
 }
+
+#if defined ENABLE_NODE_V_6_9 || defined RTSCRIPT_SUPPORT_V8
+static void WeakCallback(const WeakCallbackInfo<rtIObject>& data) {
+  Locker locker(data.GetIsolate());
+  Isolate::Scope isolateScope(data.GetIsolate());
+  HandleScope handleScope(data.GetIsolate());
+  releaseWeakReference(data.GetIsolate(), data.GetParameter());
+}
 #else
 void weakCallback_rt2v8(const WeakCallbackData<Object, rtIObject>& data)
 {
   Locker locker(data.GetIsolate());
   Isolate::Scope isolateScope(data.GetIsolate());
   HandleScope handleScope(data.GetIsolate());
-  rtObjectRef temp;
   // rtLogInfo("ptr: %p", data.GetParameter());
 
   Local<Object> obj = data.GetValue();
@@ -142,105 +146,60 @@ void weakCallback_rt2v8(const WeakCallbackData<Object, rtIObject>& data)
 
   // uint32_t contextId = GetContextId(ctx);
   // rtLogInfo("contextId: %u addr:%p", contextId, data.GetParameter());
-rtWrapperSceneUpdateEnter();
-#ifndef RUNINMAIN
-  pthread_mutex_lock(&sObjectMapMutex);
-#endif
-  ObjectReferenceMap::iterator j = objectMap.find(data.GetParameter());
-  if (j != objectMap.end())
-  {
-    // TODO: Removing this temporarily until we understand how this callback works. I
-    // would have assumed that this is a weak persistent since we called SetWeak() on it
-    // before inserting it into the objectMap_rt2v8 map.
-    // assert(p->IsWeak());
-    //
-    j->second->PersistentObject.ClearWeak();
-    j->second->PersistentObject.Reset();
-    temp = j->second->RTObject;
-#if 0
-    if (!p->IsWeak())
-      rtLogWarn("TODO: Why isn't this handle weak?");
-    if (p)
-    {
-      // delete p;
-    }
-    else
-    {
-      rtLogError("null handle in map");
-    }
-#endif
-    delete j->second;
-    objectMap.erase(j);
-  }
-  else
-  {
-    rtLogWarn("failed to find:%p in map", data.GetParameter());
-  }
-rtWrapperSceneUpdateExit();
-#ifndef RUNINMAIN
-  pthread_mutex_unlock(&sObjectMapMutex);
-#endif
-  if (NULL != temp.getPtr())
-  {
-    rtObjectRef parentRef;
-    rtError err = temp.get<rtObjectRef>("parent",parentRef);
-    if (err == RT_OK)
-    {
-        if (NULL == parentRef)
-        {
-          temp.send("dispose");
-        }
-    }
-  }
+  releaseWeakReference(data.GetIsolate(), data.GetParameter());
 }
 #endif
 
 void
-HandleMap::clearAllForContext(uint32_t contextId)
+HandleMap::clearAllForContext(v8::Isolate* isolate, uint32_t contextId)
 {
-  typedef ObjectReferenceMap::iterator iterator;
+  ObjectReferenceMap& objectMap = objectMapForIsolate(isolate);
 
   int n = 0;
-rtWrapperSceneUpdateEnter();
-#ifndef RUNINMAIN
-  pthread_mutex_lock(&sObjectMapMutex);
-#endif
   rtLogInfo("clearing all persistent handles for: %u size:%u", contextId,
     static_cast<unsigned>(objectMap.size()));
-  vector<iterator> refs;
-  for (iterator begin = objectMap.begin(), end = objectMap.end(); begin != end;)
+  for (ObjectReferenceMap::iterator it = objectMap.begin(); it != objectMap.end();)
   {
-      ObjectReference* ref = begin->second;
+      ObjectReference* ref = it->second;
       //rtLogInfo("looking at:%d == %d", ref->CreationContextId, contextId);
 
       if (ref->CreationContextId == contextId)
       {
-        refs.push_back(begin);
         ref->PersistentObject.ClearWeak();
         ref->PersistentObject.Reset();
         delete ref;
-        ref = NULL;
-        begin++;
+        it = objectMap.erase(it);
         n++;
       }
       else
       {
         //rtLogInfo("looping :%d == %d", ref->CreationContextId, contextId);
-        ++begin;
+        ++it;
       }
   }
+  //rtLogInfo("clear complete for id[%d] . removed:%d size:%u", contextId, n,
+      //static_cast<unsigned>(objectMap.size()));
+}
 
-  for(unsigned int i=0; i<refs.size();i++)
+void
+HandleMap::clearAllForIsolate(v8::Isolate* isolate)
+{
+  if (!isolate)
+    return;
+
+  Locker locker(isolate);
+  ObjectReferenceMap* objectMap = static_cast<ObjectReferenceMap*>(isolate->GetData(HandleMap::kIsolateDataIndex));
+  if (!objectMap)
+    return;
+
+  for (ObjectReferenceMap::iterator it = objectMap->begin(); it != objectMap->end(); ++it)
   {
-    objectMap.erase(refs[i]);
+    it->second->PersistentObject.ClearWeak();
+    it->second->PersistentObject.Reset();
+    delete it->second;
   }
-  refs.clear();
-  //rtLogInfo("clear complete for id[%d] . removed:%d size:%u", contextId, n,
-      //static_cast<unsigned>(objectMap.size()));
-rtWrapperSceneUpdateExit();
-#ifndef RUNINMAIN
-  pthread_mutex_unlock(&sObjectMapMutex);
-#endif
+  delete objectMap;
+  isolate->SetData(HandleMap::kIsolateDataIndex, NULL);
 }
 
 void HandleMap::addWeakReference(v8::Isolate* isolate, const rtObjectRef& from, Local<Object>& to)
@@ -250,10 +209,8 @@ void HandleMap::addWeakReference(v8::Isolate* isolate, const rtObjectRef& from,
 
   uint32_t const contextIdCreation = GetContextId(creationContext);
   assert(contextIdCreation != 0);
-rtWrapperSceneUpdateEnter();
-#ifndef RUNINMAIN
-  pthread_mutex_lock(&sObjectMapMutex);
-#endif
+
+  ObjectReferenceMap& objectMap = objectMapForIsolate(isolate);
   ObjectReferenceMap::iterator i = objectMap.find(from.getPtr());
   if (i != objectMap.end())
   {
@@ -278,10 +235,6 @@ rtWrapperSceneUpdateEnter();
     entry->CreationContextId = contextIdCreation;
     objectMap.insert(std::make_pair(from.getPtr(), entry));
   }
-rtWrapperSceneUpdateExit();
-#ifndef RUNINMAIN
-  pthread_mutex_unlock(&sObjectMapMutex);
-#endif
 
   #if 0
   static FILE* f = NULL;
@@ -302,26 +255,15 @@ Local<Object> HandleMap::lookupSurrogate(v8::Local<v8::Context>& ctx, const rtOb
   Isolate* isolate = ctx->GetIsolate();
   EscapableHandleScope scope(isolate);
   Local<Object> obj;
-rtWrapperSceneUpdateEnter();
-#ifndef RUNINMAIN
-  pthread_mutex_lock(&sObjectMapMutex);
-#endif
+
+  ObjectReferenceMap& objectMap = objectMapForIsolate(isolate);
   ObjectReferenceMap::iterator i = objectMap.find(from.getPtr());
   if (i == objectMap.end())
-  {
-    rtWrapperSceneUpdateExit();
-#ifndef RUNINMAIN
-    pthread_mutex_unlock(&sObjectMapMutex);
-#endif
     return scope.Escape(obj);
-  }
   obj = PersistentToLocal(isolate, i->second->PersistentObject);
-rtWrapperSceneUpdateExit();
-#ifndef RUNINMAIN
-  pthread_mutex_unlock(&sObjectMapMutex);
-#endif
 
-  #if 1
+  // The sanity check costs a property lookup on every hit
+  #ifndef NDEBUG
   if (!obj.IsEmpty())
   {
     // JR sanity check
@@ -491,4 +433,75 @@ rtValue js2rt(v8::Local<v8::Context>& ctx, const Handle<Value>& val, rtWrapperEr
   return rtValue(0);
 }
 
+#if defined ENABLE_NODE_V_6_9 || defined RTSCRIPT_SUPPORT_V8
+// Short snippets compile faster than a cache file can be read back
+static const size_t kMinCodeCacheSourceLength = 1024;
+
+MaybeLocal<Script> compileWithCodeCache(Local<Context>& ctx, const char* source, const char* name)
+{
+  Isolate* isolate = ctx->GetIsolate();
+  Local<String> sourceString = String::NewFromUtf8(isolate, source);
+  ScriptOrigin origin(String::NewFromUtf8(isolate, name ? name : ""));
+
+#ifndef ENABLE_HTTP_CACHE
+  // rtCodeCache is built with the rest of the disk caches
+  return Script::Compile(ctx, sourceString, &origin);
+#else
+  size_t length = strlen(source);
+  rtCodeCache* cache = rtCodeCache::instance();
+  if (length < kMinCodeCacheSourceLength || !cache->enabled())
+    return Script::Compile(ctx, sourceString, &origin);
+
+  rtString key = rtCodeCache::cacheKey(source, length, V8::GetVersion());
+
+  // data has to outlive scriptSource, which owns the CachedData wrapping it
+  rtData data;
+  ScriptCompiler::CachedData* cachedData = NULL;
+  if (RT_OK == cache->data(key, data))
+    cachedData = new ScriptCompiler::CachedData(data.data(), data.length());
+
+  ScriptCompiler::Source scriptSource(sourceString, origin, cachedData);
+#if V8_MAJOR_VERSION > 6 || (V8_MAJOR_VERSION == 6 && V8_MINOR_VERSION >= 6)
+  ScriptCompiler::CompileOptions options = cachedData ? ScriptCompiler::kConsumeCodeCache
+                                                      : ScriptCompiler::kNoCompileOptions;
+#else
+  ScriptCompiler::CompileOptions options = cachedData ? ScriptCompiler::kConsumeCodeCache
+                                                      : ScriptCompiler::kProduceCodeCache;
+#endif
+  MaybeLocal<Script> script = ScriptCompiler::Compile(ctx, &scriptSource, options);
+  if (script.IsEmpty())
+    return script;
+
+  if (cachedData)
+  {
+    if (!scriptSource.GetCachedData()->rejected)
+      return script;
+
+    // Built by another V8 or with other flags; V8 compiled from source
+    // instead, so drop the entry and store a fresh one
+    rtLogInfo("code cache for '%s' rejected", name ? name : "script");
+    cache->removeData(key);
+  }
+
+#if V8_MAJOR_VERSION > 6 || (V8_MAJOR_VERSION == 6 && V8_MINOR_VERSION >= 6)
+  ScriptCompiler::CachedData* produced =
+    ScriptCompiler::CreateCodeCache(script.ToLocalChecked()->GetUnboundScript());
+  if (produced)
+  {
+    cache->addToCache(key, produced->data, produced->length);
+    delete produced;
+  }
+#else
+  // Older V8 only produces while compiling from source, so a rejected
+  // entry is replaced on the next load
+  const ScriptCompiler::CachedData* produced = scriptSource.GetCachedData();
+  if (!cachedData && produced && produced->length > 0)
+    cache->addToCache(key, produced->data, produced->length);
+#endif
+
+  return script;
+#endif // ENABLE_HTTP_CACHE
+}
+#endif
+
 } // namespace
@@ -321,13 +321,24 @@ v8::Handle<v8::Value> rt2js(v8::Local<v8::Context>& ctx, const rtValue& val);
 class HandleMap
 {
 public:
+  static int const kIsolateDataIndex;
   static int const kContextIdIndex;
 
   static void addWeakReference(v8::Isolate* isolate, const rtObjectRef& from, v8::Local<v8::Object>& to);
   static v8::Local<v8::Object> lookupSurrogate(v8::Local<v8::Context>& ctx, const rtObjectRef& from);
-  static void clearAllForContext(uint32_t contextId);
+  static void clearAllForContext(v8::Isolate* isolate, uint32_t contextId);
+  // Frees the isolate's map and every handle left in it; call before the
+  // isolate goes away
+  static void clearAllForIsolate(v8::Isolate* isolate);
 };
 
+#if defined ENABLE_NODE_V_6_9 || defined RTSCRIPT_SUPPORT_V8
+// Compiles source using V8's code cache from a previous run when rtCodeCache
+// has one, storing a fresh one when it doesn't or V8 rejects it.  Builds
+// without ENABLE_HTTP_CACHE have no rtCodeCache and always compile from source
+v8::MaybeLocal<v8::Script> compileWithCodeCache(v8::Local<v8::Context>& ctx, const char* source, const char* name);
+#endif
+
 
 
 
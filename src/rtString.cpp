@@ -23,21 +23,24 @@
 #include <stdlib.h>
 
 #include <stdio.h>
+#include <string>
+#include <unordered_set>
 #include "rtLog.h"
+#include "rtMutex.h"
 extern "C"
 {
 #include "utf8.h"
 }
 
-rtString::rtString(): mData(NULL) {}
+rtString::rtString(): mData(NULL), mByteLength(0), mLength(-1), mStorage(kNone) {}
 
-rtString::rtString(const char* s): mData(NULL)
+rtString::rtString(const char* s): mData(NULL), mByteLength(0), mLength(-1), mStorage(kNone)
 {
   if (s)
-    mData = strdup(s);
+    assign(s, strlen(s));
 }
 
-rtString::rtString(const char* s, uint32_t byteLen): mData(NULL)
+rtString::rtString(const char* s, uint32_t byteLen): mData(NULL), mByteLength(0), mLength(-1), mStorage(kNone)
 {
   if (s)
   {
@@ -47,32 +50,102 @@ rtString::rtString(const char* s, uint32_t byteLen): mData(NULL)
 
 rtString& rtString::init(const char* s, size_t byteLen)
 {
-  mData = NULL;
-  
   if (s)
   {
-    mData = (char*)malloc(byteLen+1);
-    memcpy(mData, s, byteLen);
-    mData[byteLen] = 0; // null terminate
+    // stop at an embedded terminator, as cString() would
+    const char* end = (const char*)memchr(s, 0, byteLen);
+    assign(s, end ? (size_t)(end - s) : byteLen);
   }
+  else
+    term();
 
   return *this;
 }
 
-rtString::rtString(const rtString& s): mData(NULL)
+void rtString::assign(const char* s, size_t byteLen)
 {
-  if (s.mData)
-    mData = strdup(s.mData);
+  char* d;
+  if (byteLen < kInlineSize)
+  {
+    d = mInline;
+    // s may be our own inline text
+    memmove(d, s, byteLen);
+    if (mStorage == kHeap)
+      free(mData);
+    mStorage = kInline;
+  }
+  else
+  {
+    d = (char*)malloc(byteLen+1);
+    memcpy(d, s, byteLen);
+    if (mStorage == kHeap)
+      free(mData);
+    mStorage = kHeap;
+  }
+  d[byteLen] = 0; // null terminate
+  mData = d;
+  mByteLength = (uint32_t)byteLen;
+  mLength = -1;
 }
 
-rtString& rtString::operator=(const rtString& s) 
+void rtString::copy(const rtString& s)
 {
-  if (this != &s)
+  if (s.mStorage == kInterned)
   {
     term();
-    if (s.mData)
-      mData = strdup(s.mData);
+    mData = s.mData;
+    mByteLength = s.mByteLength;
+    mStorage = kInterned;
+  }
+  else if (s.mData)
+    assign(s.mData, s.mByteLength);
+  else
+    term();
+  mLength = s.mLength;
+}
+
+void rtString::move(rtString& s)
+{
+  if (s.mStorage == kInline)
+  {
+    assign(s.mData, s.mByteLength);
   }
+  else
+  {
+    if (mStorage == kHeap)
+      free(mData);
+    mData = s.mData;
+    mByteLength = s.mByteLength;
+    mStorage = s.mStorage;
+    s.mData = NULL;
+    s.mByteLength = 0;
+    s.mStorage = kNone;
+  }
+  mLength = s.mLength;
+  s.mLength = -1;
+}
+
+rtString::rtString(const rtString& s): mData(NULL), mByteLength(0), mLength(-1), mStorage(kNone)
+{
+  copy(s);
+}
+
+rtString::rtString(rtString&& s) noexcept: mData(NULL), mByteLength(0), mLength(-1), mStorage(kNone)
+{
+  move(s);
+}
+
+rtString& rtString::operator=(const rtString& s) 
+{
+  if (this != &s)
+    copy(s);
+  return *this;
+}
+
+rtString& rtString::operator=(rtString&& s) noexcept
+{
+  if (this != &s)
+    move(s);
   return *this;
 }
 
@@ -80,37 +153,113 @@ rtString& rtString::operator=(const char* s)
 {
   if (s != mData)
   {
-    term();
     if (s)
-      mData = strdup(s);
+      assign(s, strlen(s));
+    else
+      term();
   }
   return *this;
 }
 
 bool rtString::isEmpty() const
 {
-  return (!mData || !(*mData));
+  return mByteLength == 0;
 }
 
 rtString::~rtString() { term(); }
 
 void rtString::term() 
 {
-  if (mData)
+  if (mStorage == kHeap)
     free(mData);
   mData = 0;
+  mByteLength = 0;
+  mLength = -1;
+  mStorage = kNone;
 }
 
 rtString& rtString::append(const char* s)
 {
   size_t sl = s?strlen(s):0;
-  size_t dl = mData?strlen(mData):0;
-  mData = (char*)realloc((void*)mData, dl+sl+1);
-  strcpy(mData+dl, s?s:"");
-  
+  size_t dl = mByteLength;
+  size_t n = dl+sl;
+
+  if (n < kInlineSize && (mStorage == kNone || mStorage == kInline))
+  {
+    if (mStorage == kNone)
+    {
+      mData = mInline;
+      mStorage = kInline;
+    }
+    memmove(mData+dl, s?s:"", sl);
+  }
+  else if (mStorage == kHeap)
+  {
+    // s may point into our own text
+    size_t offset = (s >= mData && s <= mData+dl) ? (size_t)(s-mData) : (size_t)-1;
+    mData = (char*)realloc((void*)mData, n+1);
+    memmove(mData+dl, offset != (size_t)-1 ? mData+offset : s, sl);
+  }
+  else
+  {
+    char* d = (char*)malloc(n+1);
+    if (dl)
+      memcpy(d, mData, dl);
+    memcpy(d+dl, s?s:"", sl);
+    mData = d;
+    mStorage = kHeap;
+  }
+  mData[n] = 0;
+  mByteLength = (uint32_t)n;
+  mLength = -1;
+
   return *this;
 }
 
+static rtMutex& internMutex()
+{
+  static rtMutex sMutex;
+  return sMutex;
+}
+
+static std::unordered_set<std::string>& internedStrings()
+{
+  static std::unordered_set<std::string> sStrings;
+  return sStrings;
+}
+
+rtString rtString::intern(const char* s)
+{
+  rtString result;
+  if (s)
+  {
+    rtMutexLockGuard lock(internMutex());
+    // elements don't move once inserted, so their text is stable
+    const std::string& interned = *internedStrings().insert(s).first;
+    result.mData = (char*)interned.c_str();
+    result.mByteLength = (uint32_t)interned.size();
+    result.mStorage = kInterned;
+  }
+  return result;
+}
+
+rtString rtString::findInterned(const char* s)
+{
+  rtString result;
+  if (s)
+  {
+    rtMutexLockGuard lock(internMutex());
+    std::unordered_set<std::string>::const_iterator it = internedStrings().find(s);
+    if (it != internedStrings().end())
+    {
+      result.mData = (char*)it->c_str();
+      result.mByteLength = (uint32_t)it->size();
+      result.mStorage = kInterned;
+    }
+  }
+  return result;
+}
+
 int rtString::compare(const char* s) const 
 {
   const char *d = mData?mData:"";
@@ -129,19 +278,11 @@ int rtString::compare(const char* s) const
 }
 
 
-const char* rtString::cString() const 
-{
-  return mData?mData:"";
-}
-
 int32_t rtString::length() const 
 {
-  return mData?u8_strlen(mData):0;
-}
-
-int32_t rtString::byteLength() const 
-{
-  return (int32_t)(mData?strlen(mData):0);
+  if (mLength < 0)
+    mLength = mData?u8_strlen_n(mData, (int)mByteLength):0;
+  return mLength;
 }
 
 bool rtString::beginsWith(const char* s) const
@@ -226,6 +367,29 @@ int32_t rtString::find(size_t pos, uint32_t codePoint) const
   return -1;
 }
 
+rtUtf8Reader::rtUtf8Reader(const char* s, bool trackOffsets)
+  : mText(s?s:""), mByteLength(0), mPos(0), mCount(0), mIndex(0),
+    mTrackOffsets(trackOffsets)
+{
+  mByteLength = (int32_t)strlen(mText);
+}
+
+bool rtUtf8Reader::fill()
+{
+  int consumed = 0;
+  int start = mPos;
+  mIndex = 0;
+  mCount = u8_decode_span(mCodePoints, mTrackOffsets?mOffsets:NULL, kSpanSize,
+                          mText+mPos, mByteLength-mPos, &consumed);
+  mPos += consumed;
+  if (mTrackOffsets)
+  {
+    for (int32_t i = 0; i < mCount; i++)
+      mOffsets[i] += start;
+  }
+  return mCount > 0;
+}
+
 rtString rtString::substring(size_t pos, size_t len) const
 {
   char* s = mData;
@@ -32,6 +32,7 @@
 
 /**
   A lightweight utf-8 string class.
+  Short strings are stored inline so copying them doesn't allocate.
 */
 class rtString 
 {
@@ -47,17 +48,19 @@ public:
   rtString(const char* s, uint32_t byteLen);
 
   rtString(const rtString& s);
+  rtString(rtString&& s) noexcept;
   
   ~rtString();
 
   rtString& operator=(const rtString& s);
+  rtString& operator=(rtString&& s) noexcept;
   rtString& operator=(const char* s);
 
   friend
   rtString operator+(const rtString& lhs, const char *rhs)
   {
     rtString ans(lhs);
-    ans = ans.append(rhs);
+    ans.append(rhs);
     return ans;
   }
 
@@ -82,6 +85,7 @@ public:
 
   /**
    * The length of the string in utf8 characters.
+   * The count is cached until the string is modified.
    * @returns The number of utf8 characters.
    */
   int32_t length() const;
@@ -90,7 +94,24 @@ public:
    * The length of the string in bytes.
    * @returns The number of bytes in the string.
    */
-  int32_t byteLength() const;
+  int32_t byteLength() const { return (int32_t)mByteLength; }
+
+  /**
+   * Returns a copy of s backed by storage shared with every other interned
+   * copy of the same text and kept for the life of the process.  Copying an
+   * interned string never allocates, so use it for fixed identifiers that are
+   * copied often such as built-in event names; names coming from scripts
+   * would never be freed.
+   */
+  static rtString intern(const char* s);
+
+  /**
+   * Returns the interned copy of s if s has already been interned, otherwise
+   * an empty string.  Never interns s itself.
+   */
+  static rtString findInterned(const char* s);
+
+  bool isInterned() const { return mStorage == kInterned; }
 
 #if 0
   void subst(const char* before, const char* after) 
@@ -98,7 +119,7 @@ public:
   }
 #endif
 
-  const char* cString() const;
+  const char* cString() const { return mData?mData:""; }
   operator const char* () const { return mData?mData:""; }
 
   //uint32_t operator[](uint32_t i) const {}
@@ -123,7 +144,57 @@ public:
   int32_t find(size_t pos, uint32_t codePoint) const;
 
 private:
-  char* mData;
+  enum { kInlineSize = 15 }; // inline capacity in bytes, including the terminator
+  enum { kNone, kInline, kHeap, kInterned };
+
+  void assign(const char* s, size_t byteLen);
+  void copy(const rtString& s);
+  void move(rtString& s);
+
+  char* mData;             // NULL, mInline, heap or interned storage
+  uint32_t mByteLength;
+  mutable int32_t mLength; // cached utf8 character count, -1 if unknown
+  uint8_t mStorage;
+  char mInline[kInlineSize];
+};
+
+/**
+  Iterates the code points of a utf-8 string, decoding a span at a time
+  with the bulk decoder in utf8.c.  next() returns 0 at the end of the
+  text, like u8_nextchar.
+*/
+class rtUtf8Reader
+{
+public:
+  // if trackOffsets is set offset() reports byte positions
+  rtUtf8Reader(const char* s, bool trackOffsets = false);
+
+  finline uint32_t next()
+  {
+    if (mIndex >= mCount && !fill())
+      return 0;
+    return mCodePoints[mIndex++];
+  }
+
+  // byte offset just past the code point last returned by next()
+  finline int32_t offset() const
+  {
+    return mIndex < mCount ? mOffsets[mIndex] : mPos;
+  }
+
+private:
+  bool fill();
+
+  enum { kSpanSize = 64 };
+
+  const char* mText;
+  int32_t mByteLength;
+  int32_t mPos;
+  int32_t mCount;
+  int32_t mIndex;
+  bool mTrackOffsets;
+  uint32_t mCodePoints[kSpanSize];
+  int mOffsets[kSpanSize];
 };
 
 #endif
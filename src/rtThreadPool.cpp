@@ -19,32 +19,253 @@
 // rtThreadPool.h
 
 #include "rtThreadPool.h"
+#include "rtSettings.h"
 
+#include <thread>
 #include <iostream>
 using namespace std;
 
-#define RT_THREAD_POOL_DEFAULT_THREAD_COUNT 6
+#define RT_THREAD_POOL_DEFAULT_IO_THREAD_COUNT 6
 
-rtThreadPool* rtThreadPool::mGlobalInstance = new rtThreadPool(RT_THREAD_POOL_DEFAULT_THREAD_COUNT);
+// Sized when their first task is queued, which normally follows the
+// settings load; see the rtThreadPool constructor
+rtThreadPool* rtThreadPool::mGlobalInstance = new rtThreadPool(RT_THREAD_POOL_AUTO_THREAD_COUNT, "threadPoolSize");
+rtThreadPool* rtThreadPool::mIoInstance = new rtThreadPool(RT_THREAD_POOL_DEFAULT_IO_THREAD_COUNT, "ioThreadPoolSize");
 
 
-rtThreadPool::rtThreadPool(int numberOfThreads) : rtThreadPoolNative(numberOfThreads)
+rtThreadPool::rtThreadPool(int numberOfThreads, const char* sizeSetting) : rtThreadPoolNative(),
+    mNumberOfThreads(numberOfThreads), mRunning(true), mStarted(false),
+    mSizeSetting(sizeSetting), mThreadTaskMutex(), mThreadTaskCondition(),
+    mQueues(), mPendingTasks(0), mNextThreadIndex(0), mNextQueue(0)
 {
 }
 
 rtThreadPool::~rtThreadPool()
 {
+  if (mRunning)
+  {
+    destroy();
+  }
+  mThreads.clear();
+  for (size_t i = 0; i < mQueues.size(); i++)
+  {
+    for (size_t j = 0; j < mQueues[i]->tasks.size(); j++)
+    {
+      delete mQueues[i]->tasks[j].task;
+    }
+    delete mQueues[i];
+  }
+  mQueues.clear();
   if (mGlobalInstance == this)
   {
     mGlobalInstance = NULL;
   }
+  if (mIoInstance == this)
+  {
+    mIoInstance = NULL;
+  }
 }
 
 rtThreadPool* rtThreadPool::globalInstance()
 {
     if (mGlobalInstance == NULL)
     {
-        mGlobalInstance = new rtThreadPool(RT_THREAD_POOL_DEFAULT_THREAD_COUNT);
+        mGlobalInstance = new rtThreadPool(RT_THREAD_POOL_AUTO_THREAD_COUNT, "threadPoolSize");
     }
     return mGlobalInstance;
 }
+
+rtThreadPool* rtThreadPool::ioInstance()
+{
+    if (mIoInstance == NULL)
+    {
+        mIoInstance = new rtThreadPool(RT_THREAD_POOL_DEFAULT_IO_THREAD_COUNT, "ioThreadPoolSize");
+    }
+    return mIoInstance;
+}
+
+// Called with mThreadTaskMutex held
+bool rtThreadPool::initialize()
+{
+  mStarted = true;
+  if (!mSizeSetting.isEmpty())
+  {
+    rtValue val;
+    if (RT_OK == rtSettings::instance()->value(mSizeSetting, val) && val.toInt32() > 0)
+    {
+      mNumberOfThreads = val.toInt32();
+    }
+  }
+  if (mNumberOfThreads < 0)
+  {
+    mNumberOfThreads = (int)std::thread::hardware_concurrency();
+    if (mNumberOfThreads < 1)
+    {
+      mNumberOfThreads = 1;
+    }
+  }
+  for (int i = 0; i < mNumberOfThreads || i == 0; i++)
+  {
+    mQueues.push_back(new taskQueue());
+  }
+  return launchThreads(mNumberOfThreads);
+}
+
+void rtThreadPool::destroy()
+{
+  mThreadTaskMutex.lock();
+  mRunning = false; //mRunning is accessed by other threads
+  mThreadTaskMutex.unlock();
+  //broadcast to all the threads that we are shutting down
+  mThreadTaskCondition.broadcast();
+  for (size_t i = 0; i < mThreads.size(); i++)
+  {
+    joinThread(i);
+    //make another attempt to broadcast to threads
+    mThreadTaskCondition.broadcast();
+  }
+}
+
+rtThreadTask* rtThreadPool::popTask(size_t index, bool stolen)
+{
+  taskQueue* queue = mQueues[index];
+  queue->mutex.lock();
+  if (queue->tasks.empty())
+  {
+    queue->mutex.unlock();
+    return NULL;
+  }
+  queuedTask entry = queue->tasks.front();
+  queue->tasks.pop_front();
+  mPendingTasks--;
+
+  double wait = std::chrono::duration<double>(std::chrono::steady_clock::now() - entry.queuedTime).count();
+  queue->executed++;
+  if (stolen)
+  {
+    queue->stolen++;
+  }
+  queue->waitSeconds += wait;
+  if (wait > queue->maxWaitSeconds)
+  {
+    queue->maxWaitSeconds = wait;
+  }
+  queue->mutex.unlock();
+  return entry.task;
+}
+
+rtThreadTask* rtThreadPool::nextTask(size_t index)
+{
+  rtThreadTask* threadTask = popTask(index, false);
+  for (size_t i = 1; threadTask == NULL && i < mQueues.size(); i++)
+  {
+    threadTask = popTask((index + i) % mQueues.size(), true);
+  }
+  return threadTask;
+}
+
+void rtThreadPool::startThread()
+{
+  size_t index = mNextThreadIndex++ % mQueues.size();
+  while(true)
+  {
+    rtThreadTask* threadTask = mRunning ? nextTask(index) : NULL;
+    if (threadTask == NULL)
+    {
+      mThreadTaskMutex.lock();
+      while (mRunning && mPendingTasks == 0)
+      {
+#ifdef WIN32
+        // the Windows condition takes the mutex itself
+        mThreadTaskMutex.unlock();
+        mThreadTaskCondition.wait(mThreadTaskMutex.getNativeMutexDescription());
+        mThreadTaskMutex.lock();
+#else
+        mThreadTaskCondition.wait(mThreadTaskMutex.getNativeMutexDescription());
+#endif
+      }
+      if (!mRunning)
+      {
+        mThreadTaskMutex.unlock();
+        return;
+      }
+      mThreadTaskMutex.unlock();
+      continue;
+    }
+
+    threadTask->execute();
+    delete threadTask;
+  }
+}
+
+void rtThreadPool::executeTask(rtThreadTask* threadTask)
+{
+  queuedTask entry;
+  entry.task = threadTask;
+  entry.queuedTime = std::chrono::steady_clock::now();
+
+  mThreadTaskMutex.lock();
+  if (!mStarted)
+  {
+    initialize();
+  }
+  taskQueue* queue = mQueues[mNextQueue++ % mQueues.size()];
+  queue->mutex.lock();
+  queue->tasks.push_back(entry);
+  queue->mutex.unlock();
+  // counted under mThreadTaskMutex so an idle thread can't miss the signal
+  mPendingTasks++;
+  mThreadTaskCondition.signal();
+  mThreadTaskMutex.unlock();
+}
+
+void rtThreadPool::raisePriority(rtString key)
+{
+  mThreadTaskMutex.lock();
+  for (size_t i = 0; i < mQueues.size(); i++)
+  {
+    taskQueue* queue = mQueues[i];
+    bool found = false;
+    queue->mutex.lock();
+    for (std::deque<queuedTask>::iterator it = queue->tasks.begin(); it != queue->tasks.end(); ++it)
+    {
+      if (it->task->getKey().compare(key) == 0)
+      {
+        queuedTask entry = *it;
+        queue->tasks.erase(it);
+        queue->tasks.push_front(entry);
+        found = true;
+        break;
+      }
+    }
+    queue->mutex.unlock();
+    if (found)
+    {
+      break;
+    }
+  }
+  mThreadTaskCondition.signal();
+  mThreadTaskMutex.unlock();
+}
+
+void rtThreadPool::stats(rtThreadPoolStats& stats)
+{
+  stats = rtThreadPoolStats();
+  mThreadTaskMutex.lock();
+  stats.threads = mStarted ? mNumberOfThreads : 0;
+  for (size_t i = 0; i < mQueues.size(); i++)
+  {
+    taskQueue* queue = mQueues[i];
+    queue->mutex.lock();
+    stats.queued += (uint32_t)queue->tasks.size();
+    stats.executed += queue->executed;
+    stats.stolen += queue->stolen;
+    stats.waitSeconds += queue->waitSeconds;
+    if (queue->maxWaitSeconds > stats.maxWaitSeconds)
+    {
+      stats.maxWaitSeconds = queue->maxWaitSeconds;
+    }
+    queue->mutex.unlock();
+  }
+  mThreadTaskMutex.unlock();
+}
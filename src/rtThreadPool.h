@@ -20,22 +20,85 @@ limitations under the License.
 #define RT_THREAD_POOL_H
 
 #include "rtCore.h"
+#include "rtMutex.h"
+#include "rtThreadTask.h"
+#include "rtString.h"
 
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <deque>
+
+// Pass RT_THREAD_POOL_AUTO_THREAD_COUNT for one thread per core
+#define RT_THREAD_POOL_AUTO_THREAD_COUNT -1
+
+// Tasks are dealt round robin to one queue per thread, and a thread that
+// runs its own queue dry steals from the others, oldest task first.  The
+// queues are plain locked deques, not per-thread work-stealing deques: a
+// task never queues follow-up work on its own thread.
 class rtThreadPool : public rtThreadPoolNative
 {
 public:
-    rtThreadPool(int numberOfThreads);
+    // A negative numberOfThreads sizes the pool from the number of cores.
+    // When sizeSetting names an rtSettings value it overrides the count.
+    // Threads are started, and the count fixed, when the first task is
+    // queued; a task queued before rtSettings has loaded leaves the pool at
+    // numberOfThreads for the life of the process.
+    rtThreadPool(int numberOfThreads, const char* sizeSetting = NULL);
     ~rtThreadPool();
     
+    void executeTask(rtThreadTask* threadTask);
+    void raisePriority(rtString key);
+    virtual void startThread();
+    void destroy();
+    void stats(rtThreadPoolStats& stats);
+
+    // CPU bound work such as decoding; one thread per core unless the
+    // threadPoolSize setting says otherwise
     static rtThreadPool* globalInstance();
 
-	void raisePriority(const rtString & /*url*/) {
-		//TODO
-	};
+    // Work that blocks on the network or disk, so it never holds up the
+    // CPU bound tasks; sized by the ioThreadPoolSize setting
+    static rtThreadPool* ioInstance();
     
 private:
+
+    struct queuedTask
+    {
+        rtThreadTask* task;
+        std::chrono::steady_clock::time_point queuedTime;
+    };
+
+    struct taskQueue
+    {
+        taskQueue() : mutex(), tasks(), executed(0), stolen(0),
+            waitSeconds(0), maxWaitSeconds(0) {}
+
+        rtMutex mutex;
+        std::deque<queuedTask> tasks;
+        uint64_t executed;
+        uint64_t stolen;
+        double waitSeconds;
+        double maxWaitSeconds;
+    };
+
+    bool initialize();
+    rtThreadTask* nextTask(size_t index);
+    rtThreadTask* popTask(size_t index, bool stolen);
+
+    int mNumberOfThreads;
+    std::atomic<bool> mRunning;
+    bool mStarted;
+    rtString mSizeSetting;
+    rtMutex mThreadTaskMutex;
+    rtThreadCondition mThreadTaskCondition;
+    std::vector<taskQueue*> mQueues;
+    std::atomic<uint32_t> mPendingTasks;
+    std::atomic<uint32_t> mNextThreadIndex;
+    uint32_t mNextQueue;
     
     static rtThreadPool* mGlobalInstance;
+    static rtThreadPool* mIoInstance;
 };
 
 #endif //RT_THREAD_POOL_H
@@ -21,6 +21,8 @@
 
 #include "rtString.h"
 
+#include <stdint.h>
+
 class rtThreadTask
 {  
 public:
@@ -35,4 +37,20 @@ private:
     rtString mKey;
 };
 
+// Counts for a thread pool since it was created.  Wait is the time a task
+// spent queued before a thread picked it up.
+struct rtThreadPoolStats
+{
+  rtThreadPoolStats()
+    : threads(0), queued(0), executed(0), stolen(0), waitSeconds(0),
+      maxWaitSeconds(0) {}
+
+  int threads;
+  uint32_t queued;         // tasks waiting right now
+  uint64_t executed;
+  uint64_t stolen;         // tasks run by a thread other than the one queued to
+  double waitSeconds;
+  double maxWaitSeconds;
+};
+
 #endif //RT_THREAD_TASK_H
@@ -18,6 +18,7 @@
 */
 
 #include <stdio.h>
+#include <new>
 
 #include "rtCore.h"
 #include "rtString.h"
@@ -36,11 +37,13 @@ rtValue::rtValue(float v)               :mType(0) { setFloat(v);  }
 rtValue::rtValue(double v)              :mType(0) { setDouble(v); }
 rtValue::rtValue(const char* v)         :mType(0) { setString(v); }
 rtValue::rtValue(const rtString& v)     :mType(0) { setString(v); }
+rtValue::rtValue(rtString&& v)          :mType(0) { setString(std::move(v)); }
 rtValue::rtValue(const rtIObject* v)    :mType(0) { setObject(v); }
 rtValue::rtValue(const rtObjectRef& v)  :mType(0) { setObject(v); }
 rtValue::rtValue(const rtIFunction* v)  :mType(0) { setFunction(v); }
 rtValue::rtValue(const rtFunctionRef& v):mType(0) { setFunction(v); }
 rtValue::rtValue(const rtValue& v)      :mType(0) { setValue(v);  }
+rtValue::rtValue(rtValue&& v) noexcept  :mType(0) { setValue(std::move(v)); }
 rtValue::rtValue(voidPtr v)             :mType(0) { setVoidPtr(v); }
 
 rtValue::~rtValue()
@@ -70,14 +73,7 @@ bool rtValue::compare(const rtValue& lhs, const rtValue& rhs)
     case RT_uint64_tType: result = (lhs.mValue.uint64Value == rhs.mValue.uint64Value); break;
     case RT_floatType:    result = (lhs.mValue.floatValue == rhs.mValue.floatValue); break;
     case RT_doubleType:   result = (lhs.mValue.doubleValue == rhs.mValue.doubleValue); break;
-    case RT_stringType:
-    {
-      if (lhs.mValue.stringValue && rhs.mValue.stringValue)
-        result = (*lhs.mValue.stringValue == *rhs.mValue.stringValue);
-      else
-        result = (lhs.mValue.stringValue == rhs.mValue.stringValue);
-    }
-    break;
+    case RT_stringType:   result = (lhs.mValue.stringValue == rhs.mValue.stringValue); break;
     case RT_objectType:   result = (lhs.mValue.objectValue == rhs.mValue.objectValue); break;
     case RT_functionType: result = (lhs.mValue.functionValue == rhs.mValue.functionValue); break;
     }
@@ -121,11 +117,7 @@ void rtValue::setEmpty()
   }
   else if (mType == RT_stringType)
   {
-    if (mValue.stringValue)
-    {
-      delete mValue.stringValue;
-      mValue.stringValue = NULL;
-    }
+    mValue.stringValue.~rtString();
   }
 
   // TODO setting this to '0' makes node wrappers unhappy
@@ -139,27 +131,46 @@ void rtValue::setValue(const rtValue& v)
 {
   if (this != &v)
   {
-    setEmpty();
-    mType = v.mType;
-    if (mType == RT_objectType && v.mValue.objectValue != NULL)
+    if (v.mType == RT_stringType)
     {
-      mValue.objectValue = v.mValue.objectValue;
-      mValue.objectValue->AddRef();
+      setString(v.mValue.stringValue);
     }
-    else if (mType == RT_functionType && v.mValue.functionValue != NULL)
+    else
     {
-      mValue.functionValue = v.mValue.functionValue;
-      mValue.functionValue->AddRef();
+      setEmpty();
+      mType = v.mType;
+      // every other member fits in the 64 bits
+      mValue.uint64Value = v.mValue.uint64Value;
+      if (mType == RT_objectType && mValue.objectValue != NULL)
+        mValue.objectValue->AddRef();
+      else if (mType == RT_functionType && mValue.functionValue != NULL)
+        mValue.functionValue->AddRef();
     }
-#if 1
-    else if (mType == RT_stringType && v.mValue.stringValue != NULL)
+    mIsEmpty = v.mIsEmpty;
+  }
+}
+
+void rtValue::setValue(rtValue&& v)
+{
+  if (this != &v)
+  {
+    if (v.mType == RT_stringType)
     {
-      setString(*(v.mValue.stringValue));
+      setString(std::move(v.mValue.stringValue));
+      mIsEmpty = v.mIsEmpty;
+      v.setEmpty();
     }
-#endif
     else
-      mValue = v.mValue;
-    mIsEmpty = v.mIsEmpty;
+    {
+      setEmpty();
+      // take over any object or function reference
+      mType = v.mType;
+      mValue.uint64Value = v.mValue.uint64Value;
+      mIsEmpty = v.mIsEmpty;
+      v.mType = 0;
+      v.mValue.uint64Value = 0;
+      v.mIsEmpty = true;
+    }
   }
 }
 
@@ -228,8 +239,28 @@ void rtValue::setDouble(double v)
 
 void rtValue::setString(const rtString& v)
 {
-  setEmpty();
-  mType    = RT_stringType; mValue.stringValue = new rtString(v);
+  // reuse the string we already hold, this also makes v == ours safe
+  if (mType == RT_stringType)
+    mValue.stringValue = v;
+  else
+  {
+    setEmpty();
+    new (&mValue.stringValue) rtString(v);
+    mType  = RT_stringType;
+  }
+  mIsEmpty = false;
+}
+
+void rtValue::setString(rtString&& v)
+{
+  if (mType == RT_stringType)
+    mValue.stringValue = std::move(v);
+  else
+  {
+    setEmpty();
+    new (&mValue.stringValue) rtString(std::move(v));
+    mType  = RT_stringType;
+  }
   mIsEmpty = false;
 }
 
@@ -300,9 +331,7 @@ rtError rtValue::getBool(bool& v) const
     case RT_doubleType:   v = (mValue.doubleValue==0.0) ? false:true; break;
     case RT_stringType:
     {
-      if (mValue.stringValue) {
-        v = (*mValue.stringValue=="")?false:true;
-      }
+      v = mValue.stringValue.isEmpty()?false:true;
     }
     break;
     case RT_objectType: v = mValue.objectValue?     true:false; break;
@@ -338,8 +367,7 @@ rtError rtValue::getInt8(int8_t& v)  const
     case RT_doubleType:   v = (int8_t)mValue.doubleValue;   break;
     case RT_stringType:
     {
-      if (mValue.stringValue)
-        v = (int8_t)atol(mValue.stringValue->cString());
+      v = (int8_t)atol(mValue.stringValue.cString());
     }
     break;
     case RT_objectType: /* Leave as default */ break;
@@ -380,8 +408,7 @@ rtError rtValue::getUInt8(uint8_t& v) const
 #endif //PX_RTVALUE_CAST_UINT_BASIC
     case RT_stringType:
     {
-      if (mValue.stringValue)
-        v = (uint8_t)atol(mValue.stringValue->cString());
+      v = (uint8_t)atol(mValue.stringValue.cString());
     }
     break;
     case RT_objectType:   /* Leave as default */ break;
@@ -417,8 +444,7 @@ rtError rtValue::getInt32(int32_t& v) const
     case RT_doubleType:   v = (int32_t)mValue.doubleValue;   break;
     case RT_stringType:
     {
-      if (mValue.stringValue)
-        v = (int32_t)atol(mValue.stringValue->cString());
+      v = (int32_t)atol(mValue.stringValue.cString());
     }
     break;
     case RT_objectType:   /* Leave as default */ break;
@@ -459,8 +485,7 @@ rtError rtValue::getUInt32(uint32_t& v) const
 #endif //PX_RTVALUE_CAST_UINT_BASIC
     case RT_stringType:
     {
-      if (mValue.stringValue)
-        v = (uint32_t)atol(mValue.stringValue->cString());
+      v = (uint32_t)atol(mValue.stringValue.cString());
     }
     break;
     case RT_objectType:   /* Leave as default */ break;
@@ -496,8 +521,7 @@ rtError rtValue::getInt64(int64_t& v) const
     case RT_doubleType:   v = (int64_t)mValue.doubleValue;   break;
     case RT_stringType:
     {
-      if (mValue.stringValue)
-        v = (int64_t)atoll(mValue.stringValue->cString());
+      v = (int64_t)atoll(mValue.stringValue.cString());
     }
     break;
     case RT_objectType:   /* Leave as default */ break;
@@ -538,8 +562,7 @@ rtError rtValue::getUInt64(uint64_t& v) const
 #endif
     case RT_stringType:
     {
-      if (mValue.stringValue)
-        v = (uint64_t)atoll(mValue.stringValue->cString());
+      v = (uint64_t)atoll(mValue.stringValue.cString());
     }
     break;
     case RT_objectType:   /* Leave as default */ break;
@@ -574,8 +597,7 @@ rtError rtValue::getFloat(float& v) const
     case RT_doubleType: v = (float)mValue.doubleValue;    break;
     case RT_stringType:
     {
-      if (mValue.stringValue)
-        v = (float)atof(mValue.stringValue->cString());
+      v = (float)atof(mValue.stringValue.cString());
     }
     break;
     case RT_objectType:   /* Leave as default */ break;
@@ -610,8 +632,7 @@ rtError rtValue::getDouble(double& v) const
 //    case RT_doubleType: break;
     case RT_stringType:
     {
-      if (mValue.stringValue)
-        v = atof(mValue.stringValue->cString());
+      v = atof(mValue.stringValue.cString());
     }
     break;
     case RT_objectType:   /* Leave as default */ break;
@@ -627,8 +648,8 @@ rtError rtValue::getDouble(double& v) const
 
 rtError rtValue::getString(rtString& v) const
 {
-  if (mType == RT_stringType && mValue.stringValue)
-    v = *mValue.stringValue;
+  if (mType == RT_stringType)
+    v = mValue.stringValue;
   else
   {
     // TODO EVIL buffer on stack
@@ -21,6 +21,7 @@
 #define RT_VALUE_H
 
 #include <stdio.h>
+#include <utility>
 
 #include "rtCore.h"
 #include "rtString.h"
@@ -89,10 +90,13 @@ union rtValue_
   uint32_t    uint32Value;
   float       floatValue;
   double      doubleValue;
-  rtString    *stringValue;
+  rtString    stringValue;   // Only constructed while the type is RT_stringType
   rtIObject   *objectValue;
   rtIFunction *functionValue;
   voidPtr     voidPtrValue;  // For creating mischief
+
+  rtValue_() {}
+  ~rtValue_() {}
 };
 
 typedef char rtType;
@@ -112,11 +116,13 @@ class rtValue
   rtValue(double v);
   rtValue(const char* v);
   rtValue(const rtString& v);
+  rtValue(rtString&& v);
   rtValue(const rtIObject* v);
   rtValue(const rtObjectRef& v);
   rtValue(const rtIFunction* v);
   rtValue(const rtFunctionRef& v);
   rtValue(const rtValue& v);
+  rtValue(rtValue&& v) noexcept;
   rtValue(voidPtr v);
   ~rtValue();
 
@@ -133,11 +139,13 @@ class rtValue
   finline rtValue& operator=(double v)              { setDouble(v);   return *this; }
   finline rtValue& operator=(const char* v)         { setString(v);   return *this; }
   finline rtValue& operator=(const rtString& v)     { setString(v);   return *this; }
+  finline rtValue& operator=(rtString&& v)          { setString(std::move(v)); return *this; }
   finline rtValue& operator=(const rtIObject* v)    { setObject(v);   return *this; }
   finline rtValue& operator=(const rtObjectRef& v)  { setObject(v);   return *this; }
   finline rtValue& operator=(const rtIFunction* v)  { setFunction(v); return *this; }
   finline rtValue& operator=(const rtFunctionRef& v){ setFunction(v); return *this; }
   finline rtValue& operator=(const rtValue& v)      { setValue(v);    return *this; }
+  finline rtValue& operator=(rtValue&& v) noexcept  { setValue(std::move(v)); return *this; }
   finline rtValue& operator=(voidPtr v)             { setVoidPtr(v);  return *this; }
 
   bool operator!=(const rtValue& rhs) const { return !(*this == rhs); }
@@ -166,6 +174,7 @@ class rtValue
 
   void setEmpty();
   void setValue(const rtValue& v);
+  void setValue(rtValue&& v);
   void setBool(bool v);
   void setInt8(int8_t v);
   void setUInt8(uint8_t v);
@@ -176,6 +185,7 @@ class rtValue
   void setFloat(float v);
   void setDouble(double v);
   void setString(const rtString& v);
+  void setString(rtString&& v);
   void setObject(const rtIObject* v);
   void setObject(const rtObjectRef& v);
   void setFunction(const rtIFunction* v);
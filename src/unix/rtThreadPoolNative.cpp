@@ -28,26 +28,18 @@ void* launchThread(void* threadPool)
     return NULL;
 }
 
-rtThreadPoolNative::rtThreadPoolNative(int numberOfThreads) : 
-    mNumberOfThreads(numberOfThreads), mRunning(false), mThreadTaskMutex(),
-    mThreadTaskCondition(), mThreads(), mThreadTasks()
+rtThreadPoolNative::rtThreadPoolNative() : mThreads()
 {
-    initialize();
 }
 
 rtThreadPoolNative::~rtThreadPoolNative()
 {
-    if (mRunning)
-    {
-        destroy();
-    }
     mThreads.clear();
 }
 
-bool rtThreadPoolNative::initialize()
+bool rtThreadPoolNative::launchThreads(int numberOfThreads)
 {
-    mRunning = true;
-    for (int i = 0; i < mNumberOfThreads; i++)
+    for (int i = 0; i < numberOfThreads; i++)
     {
         pthread_t tid;
         int returnValue = pthread_create(&tid, NULL, launchThread, (void*) this);
@@ -61,79 +53,12 @@ bool rtThreadPoolNative::initialize()
     return true;
 }
 
-void rtThreadPoolNative::destroy()
-{
-    mThreadTaskMutex.lock();
-    mRunning = false; //mRunning is accessed by other threads
-    mThreadTaskMutex.unlock();
-    //broadcast to all the threads that we are shutting down
-    mThreadTaskCondition.broadcast();
-    for (int i = 0; i < mNumberOfThreads; i++)
-    {
-        void* result;
-        int returnValue = pthread_join(mThreads[i], &result);
-        if (returnValue != 0)
-        {
-            cout << "Error joining threads" << endl;
-        }
-        //make another attempt to broadcast to threads 
-        mThreadTaskCondition.broadcast();
-    }
-}
-
-void rtThreadPoolNative::startThread()
-{
-    rtThreadTask* threadTask = NULL;
-    while(true)
-    {
-        mThreadTaskMutex.lock();
-        while (mRunning && (mThreadTasks.empty()))
-        {
-            mThreadTaskCondition.wait(mThreadTaskMutex.getNativeMutexDescription());
-        }
-        if (!mRunning)
-        {
-            mThreadTaskMutex.unlock();
-            pthread_exit(NULL);
-        }
-        threadTask = mThreadTasks.front();
-        mThreadTasks.pop_front();
-        mThreadTaskMutex.unlock();
-        
-        if (threadTask != NULL)
-        {
-            threadTask->execute();
-            delete threadTask;
-            threadTask = NULL;
-        }
-    }
-}
-
-void rtThreadPoolNative::executeTask(rtThreadTask* threadTask)
+void rtThreadPoolNative::joinThread(size_t index)
 {
-    mThreadTaskMutex.lock();
-    mThreadTasks.push_back(threadTask);
-    mThreadTaskCondition.signal();
-    mThreadTaskMutex.unlock();
-}
-
-void rtThreadPoolNative::raisePriority(rtString key)
-{
-    mThreadTaskMutex.lock();
-    rtThreadTask* threadTask = NULL;
-    for (std::deque<rtThreadTask*>::iterator it = mThreadTasks.begin(); it!=mThreadTasks.end(); ++it)
-    {
-        if ((*it)->getKey().compare(key) == 0)
-        {
-            threadTask = *it;
-            it = mThreadTasks.erase(it);
-            break;
-        }
-    }
-    if (threadTask != NULL)
+    void* result;
+    int returnValue = pthread_join(mThreads[index], &result);
+    if (returnValue != 0)
     {
-        mThreadTasks.push_front(threadTask);
+        cout << "Error joining threads" << endl;
     }
-    mThreadTaskCondition.signal();
-    mThreadTaskMutex.unlock();
 }
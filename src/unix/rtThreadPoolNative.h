@@ -26,30 +26,23 @@ limitations under the License.
 #include <pthread.h>
 
 #include <vector>
-#include <deque>
 
+// Starts and joins the threads of an rtThreadPool; the queues live there
 class rtThreadPoolNative
 {
 public:
-    rtThreadPoolNative(int numberOfThreads);
-    ~rtThreadPoolNative();
+    rtThreadPoolNative();
+    virtual ~rtThreadPoolNative();
     
-    void executeTask(rtThreadTask* threadTask);
-    void raisePriority(rtString key);
-    void startThread();
-    void destroy();
+    // Run by each launched thread until the pool shuts down
+    virtual void startThread() = 0;
     
 protected:
     
-    bool initialize();
+    bool launchThreads(int numberOfThreads);
+    void joinThread(size_t index);
 
-    
-    int mNumberOfThreads;
-    bool mRunning;
-    rtMutex mThreadTaskMutex;
-    rtThreadCondition mThreadTaskCondition;
     std::vector<pthread_t> mThreads;
-    std::deque<rtThreadTask*> mThreadTasks;
 };
 
 #endif //RT_THREAD_POOL_H
@@ -39,6 +39,14 @@ limitations under the License.
 
 #include "./utf8.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define U8_SIMD_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define U8_SIMD_NEON 1
+#endif
+
 static const u_int32_t offsetsFromUTF8[6] = {
     0x00000000UL, 0x00003080UL, 0x000E2080UL,
     0x03C82080UL, 0xFA082080UL, 0x82082080UL
@@ -222,6 +230,157 @@ int u8_strlen(char *s)
     return count;
 }
 
+static int u8_popcount16(unsigned int m)
+{
+    m = m - ((m >> 1) & 0x5555);
+    m = (m & 0x3333) + ((m >> 2) & 0x3333);
+    m = (m + (m >> 4)) & 0x0F0F;
+    return (int)((m + (m >> 8)) & 0x1F);
+}
+
+/* # of leading ASCII bytes in s, at most sz */
+static int u8_ascii_prefix(const char *s, int sz)
+{
+    int i = 0;
+#if defined(U8_SIMD_SSE2)
+    while (i + 16 <= sz) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+        if (_mm_movemask_epi8(v))
+            break;
+        i += 16;
+    }
+#elif defined(U8_SIMD_NEON)
+    while (i + 16 <= sz) {
+        uint64x2_t v = vreinterpretq_u64_u8(vandq_u8(vld1q_u8((const uint8_t*)(s + i)), vdupq_n_u8(0x80)));
+        if (vgetq_lane_u64(v, 0) | vgetq_lane_u64(v, 1))
+            break;
+        i += 16;
+    }
+#endif
+    while (i + 8 <= sz) {
+        u_int32_t w[2];
+        memcpy(w, s + i, 8);
+        if ((w[0] | w[1]) & 0x80808080UL)
+            break;
+        i += 8;
+    }
+    while (i < sz && !(s[i] & 0x80))
+        i++;
+    return i;
+}
+
+int u8_strlen_n(const char *s, int sz)
+{
+    int count = 0;
+    int i = 0;
+
+#if defined(U8_SIMD_SSE2)
+    /* continuation bytes 0x80-0xBF are the only bytes below -64 as signed */
+    const __m128i cont = _mm_set1_epi8((char)0xC0);
+    while (i + 16 <= sz) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+        count += 16 - u8_popcount16((unsigned int)_mm_movemask_epi8(_mm_cmplt_epi8(v, cont)));
+        i += 16;
+    }
+#else
+    while (i + 16 <= sz) {
+        int run = u8_ascii_prefix(s + i, 16);
+        count += run;
+        i += run;
+        if (run < 16)
+            break;
+    }
+#endif
+    for (; i < sz; i++)
+        count += isutf(s[i]);
+    return count;
+}
+
+int u8_decode_span(u_int32_t *dest, int *offsets, int sz,
+                   const char *src, int srcsz, int *consumed)
+{
+    int n = 0;
+    int i = 0;
+
+    while (n < sz && i < srcsz) {
+        if (!(src[i] & 0x80)) {
+            int run = u8_ascii_prefix(src + i, (srcsz - i) < (sz - n) ? (srcsz - i) : (sz - n));
+            int end = i + run;
+#if defined(U8_SIMD_SSE2)
+            if (!offsets) {
+                const __m128i zero = _mm_setzero_si128();
+                while (i + 16 <= end) {
+                    __m128i v  = _mm_loadu_si128((const __m128i*)(src + i));
+                    __m128i lo = _mm_unpacklo_epi8(v, zero);
+                    __m128i hi = _mm_unpackhi_epi8(v, zero);
+                    _mm_storeu_si128((__m128i*)(dest + n),      _mm_unpacklo_epi16(lo, zero));
+                    _mm_storeu_si128((__m128i*)(dest + n + 4),  _mm_unpackhi_epi16(lo, zero));
+                    _mm_storeu_si128((__m128i*)(dest + n + 8),  _mm_unpacklo_epi16(hi, zero));
+                    _mm_storeu_si128((__m128i*)(dest + n + 12), _mm_unpackhi_epi16(hi, zero));
+                    i += 16;
+                    n += 16;
+                }
+            }
+#endif
+            for (; i < end; i++, n++) {
+                if (offsets)
+                    offsets[n] = i;
+                dest[n] = (unsigned char)src[i];
+            }
+        }
+        else {
+            /* same accumulation as u8_nextchar, bounded by srcsz */
+            u_int32_t ch = 0;
+            int len = 0;
+            if (offsets)
+                offsets[n] = i;
+            do {
+                ch <<= 6;
+                ch += (unsigned char)src[i++];
+                len++;
+            } while (i < srcsz && len < 6 && !isutf(src[i]));
+            dest[n++] = ch - offsetsFromUTF8[len-1];
+        }
+    }
+    if (consumed)
+        *consumed = i;
+    return n;
+}
+
+int u8_isvalid(const char *s, int sz)
+{
+    const unsigned char *p = (const unsigned char*)s;
+    int i = 0;
+
+    while (i < sz) {
+        unsigned char c;
+        int trail, k;
+        u_int32_t ch;
+
+        i += u8_ascii_prefix(s + i, sz - i);
+        if (i >= sz)
+            break;
+
+        c = p[i];
+        if (c < 0xC2 || c > 0xF4)
+            return 0;
+        trail = trailingBytesForUTF8[c];
+        if (i + trail >= sz)
+            return 0;
+        ch = c & (0x3F >> trail);
+        for (k = 1; k <= trail; k++) {
+            if ((p[i+k] & 0xC0) != 0x80)
+                return 0;
+            ch = (ch << 6) | (p[i+k] & 0x3F);
+        }
+        if ((trail == 2 && (ch < 0x800 || (ch >= 0xD800 && ch <= 0xDFFF))) ||
+            (trail == 3 && (ch < 0x10000 || ch > 0x10FFFF)))
+            return 0;
+        i += trail + 1;
+    }
+    return 1;
+}
+
 /* reads the next utf-8 sequence out of a string, updating an index */
 u_int32_t u8_nextchar(char *s, int *i)
 {
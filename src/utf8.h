@@ -96,6 +96,23 @@ char *u8_memchr(char *s, u_int32_t ch, size_t sz, int *charn);
 /* count the number of characters in a UTF-8 string */
 int u8_strlen(char *s);
 
+/* count the number of characters in the first sz bytes of s.
+   counts lead bytes in bulk, so it agrees with u8_strlen for
+   well formed input */
+int u8_strlen_n(const char *s, int sz);
+
+/* bulk decoding with an ASCII fast path.
+   decodes up to sz characters from the first srcsz bytes of src into dest.
+   if offsets is not NULL it receives the byte offset of each character.
+   returns # characters decoded; *consumed is set to the # bytes read,
+   which always ends on a character boundary */
+int u8_decode_span(u_int32_t *dest, int *offsets, int sz,
+                   const char *src, int srcsz, int *consumed);
+
+/* returns nonzero if the first sz bytes of s are well formed UTF-8
+   (no overlong forms, surrogates or code points above U+10FFFF) */
+int u8_isvalid(const char *s, int sz);
+
 int u8_is_locale_utf8(char *locale);
 
 /* printf where the format string and arguments may be in UTF-8.
@@ -38,6 +38,7 @@ pxError pxOffscreen::init(int width, int height)
 	setHeight(height);
 	setStride(width*4);
 	setUpsideDown(false);
+	setPremultiplied(false);
 	e = PX_OK;
     }
 
@@ -68,6 +68,7 @@ pxError pxOffscreen::init(int width, int height)
     setHeight(height);
     setStride(width*4);
     setUpsideDown(true);
+    setPremultiplied(false);
     
     return bitmap?PX_OK:PX_FAIL;
 }
@@ -41,25 +41,17 @@ void* launchThread(void* threadPool)
 #endif
 }
 
-rtThreadPoolNative::rtThreadPoolNative(int numberOfThreads) : 
-    mNumberOfThreads(numberOfThreads), mRunning(false), mThreadTaskMutex(),
-    mThreadTaskCondition(), mThreads(), mThreadTasks()
+rtThreadPoolNative::rtThreadPoolNative() : mThreads()
 {
-    initialize();
 }
 
 rtThreadPoolNative::~rtThreadPoolNative()
 {
-    if (mRunning)
-    {
-        destroy();
-    }
 }
 
-bool rtThreadPoolNative::initialize()
+bool rtThreadPoolNative::launchThreads(int numberOfThreads)
 {
-    mRunning = true;
-    for (int i = 0; i < mNumberOfThreads; i++)
+    for (int i = 0; i < numberOfThreads; i++)
     {
       uintptr_t threadHandle = _beginthread(launchThread, 0, this);
       mThreads.push_back((HANDLE) threadHandle );
@@ -67,56 +59,7 @@ bool rtThreadPoolNative::initialize()
     return true;
 }
 
-void rtThreadPoolNative::destroy()
-{
-    mThreadTaskMutex.lock();
-    mRunning = false; //mRunning is accessed by other threads
-    mThreadTaskMutex.unlock();
-    //broadcast to all the threads that we are shutting down
-    mThreadTaskCondition.broadcast();
-    for (int i = 0; i < mNumberOfThreads; i++)
-    {
-      WaitForSingleObject(mThreads[i], 10000);
-      
-        //make another attempt to broadcast to threads 
-        mThreadTaskCondition.broadcast();
-    }
-}
-
-void rtThreadPoolNative::startThread()
-{
-    rtThreadTask* threadTask = NULL;
-    while(true)
-    {
-        mThreadTaskMutex.lock();
-        while (mRunning && (mThreadTasks.empty()))
-        {
-			mThreadTaskMutex.unlock();
-            mThreadTaskCondition.wait(mThreadTaskMutex.getNativeMutexDescription());
-			mThreadTaskMutex.lock();
-        }
-        if (!mRunning)
-        {
-            mThreadTaskMutex.unlock();
-            return;
-        }
-        threadTask = mThreadTasks.front();
-        mThreadTasks.pop_front();
-        mThreadTaskMutex.unlock();
-        
-        if (threadTask != NULL)
-        {
-            threadTask->execute();
-            delete threadTask;
-            threadTask = NULL;
-        }
-    }
-}
-
-void rtThreadPoolNative::executeTask(rtThreadTask* threadTask)
+void rtThreadPoolNative::joinThread(size_t index)
 {
-    mThreadTaskMutex.lock();
-    mThreadTasks.push_back(threadTask);
-    mThreadTaskCondition.signal();
-    mThreadTaskMutex.unlock();
+    WaitForSingleObject(mThreads[index], 10000);
 }
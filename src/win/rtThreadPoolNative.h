@@ -23,29 +23,23 @@ limitations under the License.
 #include "../rtThreadTask.h"
 
 #include <vector>
-#include <deque>
 
+// Starts and joins the threads of an rtThreadPool; the queues live there
 class rtThreadPoolNative
 {
 public:
-  rtThreadPoolNative(int numberOfThreads);
-  ~rtThreadPoolNative();
+  rtThreadPoolNative();
+  virtual ~rtThreadPoolNative();
 
-  void executeTask(rtThreadTask* threadTask);
-  void startThread();
-
-  void destroy();
+  // Run by each launched thread until the pool shuts down
+  virtual void startThread() = 0;
 
 protected:
 
-  bool initialize();
+  bool launchThreads(int numberOfThreads);
+  void joinThread(size_t index);
 
-  int mNumberOfThreads;
-  bool mRunning;
-  rtMutex mThreadTaskMutex;
-  rtThreadCondition mThreadTaskCondition;
   std::vector<void*> mThreads;
-  std::deque<rtThreadTask*> mThreadTasks;
 };
 
 #endif //RT_THREAD_POOL_H
@@ -94,7 +94,7 @@ private:
       rtObjectRef e = new rtMapObject;
       mScene->mEmit.send("addEventsProper",e);
       process();
-      EXPECT_TRUE(mTestObj->mEmit->mEntries.size() == 1);
+      EXPECT_TRUE(mTestObj->mEmit->listenerCount() == 1);
     }
 
     void runDelListenerImproperTest()
@@ -102,7 +102,7 @@ private:
       rtObjectRef e = new rtMapObject;
       mScene->mEmit.send("removeEventsImProper",e);
       process();
-      EXPECT_TRUE(mTestObj->mEmit->mEntries.size() == 1);
+      EXPECT_TRUE(mTestObj->mEmit->listenerCount() == 1);
     }
 
     void runDelListenerProperTest()
@@ -110,7 +110,7 @@ private:
       rtObjectRef e = new rtMapObject;
       mScene->mEmit.send("removeEventsProper",e);
       process();
-      EXPECT_TRUE(mTestObj->mEmit->mEntries.size() == 0);
+      EXPECT_TRUE(mTestObj->mEmit->listenerCount() == 0);
     }
 
     void runPendingListenerTest()
@@ -124,17 +124,17 @@ private:
     void sendSyncEventTest()
     {
       rtObjectRef e = new rtMapObject;
-      int eventEntriesSizeBefore = mTestObj->mEmit->mEntries.size();
+      int eventEntriesSizeBefore = mTestObj->mEmit->listenerCount();
       mScene->mEmit.send("syncEvent",e);
-      EXPECT_TRUE(eventEntriesSizeBefore+1 == mTestObj->mEmit->mEntries.size());
+      EXPECT_TRUE(eventEntriesSizeBefore+1 == mTestObj->mEmit->listenerCount());
     }
 
     void sendAsyncEventTest()
     {
       rtObjectRef e = new rtMapObject;
-      int eventEntriesSizeBefore = mTestObj->mEmit->mEntries.size();
+      int eventEntriesSizeBefore = mTestObj->mEmit->listenerCount();
       mScene->mEmit.sendAsync("asyncEvent",e);
-      EXPECT_TRUE(eventEntriesSizeBefore == mTestObj->mEmit->mEntries.size());
+      EXPECT_TRUE(eventEntriesSizeBefore == mTestObj->mEmit->listenerCount());
     }
 
 private:
@@ -347,6 +347,233 @@ TEST_F(pxFileCacheTest, fileCacheCompleteTest)
   improperCacheFileFailReadTest();
 }
 
+class rtPixelCacheTest : public testing::Test
+{
+  public:
+    virtual void SetUp()
+    {
+      rtPixelCache::instance()->setCacheDirectory("/tmp/pixelcache");
+      rtPixelCache::instance()->clearCache();
+      mImage.init(37,21);
+      for (int y = 0; y < mImage.height(); y++)
+      {
+        for (int x = 0; x < mImage.width(); x++)
+        {
+          pxPixel* p = mImage.scanline(y) + x;
+          p->r = x; p->g = y; p->b = x ^ y; p->a = 200;
+        }
+      }
+      mKey = rtPixelCache::cacheKey("http://fileserver/a.png","\"fb4-53e51895552f0\"",0,0);
+    }
+
+    virtual void TearDown()
+    {
+      rtPixelCache::instance()->setCompressionEnabled(false);
+      rtPixelCache::instance()->clearCache();
+      rtPixelCache::destroy();
+    }
+
+    bool samePixels(pxOffscreen& o)
+    {
+      if (o.width() != mImage.width() || o.height() != mImage.height())
+        return false;
+      for (int y = 0; y < o.height(); y++)
+      {
+        if (memcmp(o.scanline(y), mImage.scanline(y), o.width()*4) != 0)
+          return false;
+      }
+      return true;
+    }
+
+    void cacheKeyEmptyValidatorTest()
+    {
+      EXPECT_TRUE (rtPixelCache::cacheKey("http://fileserver/a.png","",0,0).isEmpty());
+      EXPECT_TRUE (rtPixelCache::cacheKey("http://fileserver/a.png","1",100,100) != rtPixelCache::cacheKey("http://fileserver/a.png","1",0,0));
+      EXPECT_TRUE (rtPixelCache::cacheKey("http://fileserver/a.svg","1",0,0,2.0f,2.0f) != rtPixelCache::cacheKey("http://fileserver/a.svg","1",0,0,1.0f,1.0f));
+    }
+
+    void addAndReadPixelsTest()
+    {
+      pxOffscreen o;
+      EXPECT_TRUE (RT_OK == rtPixelCache::instance()->addToCache(mKey, mImage));
+      EXPECT_TRUE (RT_OK == rtPixelCache::instance()->pixels(mKey, o));
+      EXPECT_TRUE (samePixels(o));
+    }
+
+    void addAndReadCompressedPixelsTest()
+    {
+      pxOffscreen o;
+      rtPixelCache::instance()->setCompressionEnabled(true);
+      EXPECT_TRUE (RT_OK == rtPixelCache::instance()->addToCache(mKey, mImage));
+      EXPECT_TRUE (rtPixelCache::instance()->cacheSize() < mImage.width()*mImage.height()*4);
+      EXPECT_TRUE (RT_OK == rtPixelCache::instance()->pixels(mKey, o));
+      EXPECT_TRUE (samePixels(o));
+    }
+
+    void readMissingPixelsTest()
+    {
+      pxOffscreen o;
+      EXPECT_TRUE (RT_ERROR == rtPixelCache::instance()->pixels(rtPixelCache::cacheKey("http://fileserver/b.png","1",0,0), o));
+    }
+
+    void corruptHeaderTest()
+    {
+      pxOffscreen o;
+      rtPixelCache::instance()->setCompressionEnabled(true);
+      EXPECT_TRUE (RT_OK == rtPixelCache::instance()->addToCache(mKey, mImage));
+      rtPixelCache::instance()->setCompressionEnabled(false);
+
+      // width and height follow the magic and version
+      rtString path = rtPixelCache::instance()->absPath(rtPixelCache::instance()->hashedFileName(mKey));
+      FILE* fp = fopen(path.cString(), "r+b");
+      EXPECT_TRUE (fp != NULL);
+      if (fp != NULL)
+      {
+        int32_t size[2] = { 1 << 20, 1 << 20 };
+        fseek(fp, 8, SEEK_SET);
+        fwrite(size, sizeof(size), 1, fp);
+        fclose(fp);
+      }
+      EXPECT_TRUE (RT_ERROR == rtPixelCache::instance()->pixels(mKey, o));
+      EXPECT_TRUE (o.width() == 0);
+    }
+
+    void populateExistingFilesTest()
+    {
+      rtPixelCache::instance()->addToCache(mKey, mImage);
+      int64_t size = rtPixelCache::instance()->cacheSize();
+      rtPixelCache::destroy();
+      EXPECT_TRUE (size == rtPixelCache::instance()->cacheSize());
+    }
+
+    void cleanupOnMaxSizeTest()
+    {
+      pxOffscreen o;
+      rtPixelCache::instance()->addToCache(mKey, mImage);
+      rtPixelCache::instance()->setMaxCacheSize(10);
+      EXPECT_TRUE (0 == rtPixelCache::instance()->cacheSize());
+      EXPECT_TRUE (RT_ERROR == rtPixelCache::instance()->pixels(mKey, o));
+    }
+
+  private:
+    pxOffscreen mImage;
+    rtString mKey;
+};
+
+TEST_F(rtPixelCacheTest, pixelCacheCompleteTest)
+{
+  cacheKeyEmptyValidatorTest();
+  addAndReadPixelsTest();
+  addAndReadCompressedPixelsTest();
+  readMissingPixelsTest();
+  corruptHeaderTest();
+  populateExistingFilesTest();
+  cleanupOnMaxSizeTest();
+}
+
+class rtCodeCacheTest : public testing::Test
+{
+  public:
+    virtual void SetUp()
+    {
+      bool sysret = system("rm -rf /tmp/codecachetest");
+      UNUSED_PARAM(sysret);
+      EXPECT_TRUE (RT_OK == rtCodeCache::instance()->setCacheDirectory("/tmp/codecachetest"));
+      rtCodeCache::instance()->clearCache();
+      const char* source = "function f(a) { return a + 1; }";
+      mKey = rtCodeCache::cacheKey(source, strlen(source), "5.1.281");
+    }
+
+    virtual void TearDown()
+    {
+      rtCodeCache::instance()->clearCache();
+      rtCodeCache::destroy();
+    }
+
+    void cacheKeyTest()
+    {
+      const char* source = "function f(a) { return a + 2; }";
+      EXPECT_TRUE (mKey != rtCodeCache::cacheKey(source, strlen(source), "5.1.281"));
+      source = "function f(a) { return a + 1; }";
+      EXPECT_TRUE (mKey != rtCodeCache::cacheKey(source, strlen(source), "6.9.351"));
+      EXPECT_TRUE (mKey == rtCodeCache::cacheKey(source, strlen(source), "5.1.281"));
+    }
+
+    void addAndReadDataTest()
+    {
+      const uint8_t compiled[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+      rtData d;
+      EXPECT_TRUE (RT_OK == rtCodeCache::instance()->addToCache(mKey, compiled, sizeof(compiled)));
+      EXPECT_TRUE (RT_OK == rtCodeCache::instance()->data(mKey, d));
+      EXPECT_TRUE (d.length() == sizeof(compiled));
+      EXPECT_TRUE (0 == memcmp(d.data(), compiled, sizeof(compiled)));
+    }
+
+    void readRemovedDataTest()
+    {
+      const uint8_t compiled[] = { 1, 2, 3, 4 };
+      rtData d;
+      rtCodeCache::instance()->addToCache(mKey, compiled, sizeof(compiled));
+      EXPECT_TRUE (RT_OK == rtCodeCache::instance()->removeData(mKey));
+      EXPECT_TRUE (RT_ERROR == rtCodeCache::instance()->data(mKey, d));
+      EXPECT_TRUE (0 == rtCodeCache::instance()->cacheSize());
+    }
+
+    void cleanupOnMaxSizeTest()
+    {
+      const uint8_t compiled[] = { 1, 2, 3, 4 };
+      rtData d;
+      rtCodeCache::instance()->addToCache(mKey, compiled, sizeof(compiled));
+      rtCodeCache::instance()->setMaxCacheSize(10);
+      EXPECT_TRUE (0 == rtCodeCache::instance()->cacheSize());
+      EXPECT_TRUE (RT_ERROR == rtCodeCache::instance()->data(mKey, d));
+    }
+
+    void corruptedDataTest()
+    {
+      const uint8_t compiled[] = { 1, 2, 3, 4 };
+      rtData d;
+      rtCodeCache::instance()->setMaxCacheSize(1024);
+      rtCodeCache::instance()->addToCache(mKey, compiled, sizeof(compiled));
+      rtString path = rtCodeCache::instance()->absPath(rtCodeCache::instance()->hashedFileName(mKey));
+      FILE* fp = fopen(path.cString(), "r+b");
+      EXPECT_TRUE (NULL != fp);
+      if (NULL != fp)
+      {
+        fseek(fp, -1, SEEK_END);
+        fputc(0xff, fp);
+        fclose(fp);
+      }
+      EXPECT_TRUE (RT_ERROR == rtCodeCache::instance()->data(mKey, d));
+      EXPECT_TRUE (0 != access(path.cString(), F_OK));
+    }
+
+    void sharedDirectoryTest()
+    {
+      const uint8_t compiled[] = { 1, 2, 3, 4 };
+      bool sysret = system("rm -rf /tmp/codecacheshared && mkdir /tmp/codecacheshared && chmod 777 /tmp/codecacheshared");
+      UNUSED_PARAM(sysret);
+      EXPECT_TRUE (RT_ERROR == rtCodeCache::instance()->setCacheDirectory("/tmp/codecacheshared"));
+      EXPECT_FALSE (rtCodeCache::instance()->enabled());
+      EXPECT_TRUE (RT_ERROR == rtCodeCache::instance()->addToCache(mKey, compiled, sizeof(compiled)));
+      sysret = system("rm -rf /tmp/codecacheshared");
+      UNUSED_PARAM(sysret);
+    }
+
+  private:
+    rtString mKey;
+};
+
+TEST_F(rtCodeCacheTest, codeCacheCompleteTest)
+{
+  cacheKeyTest();
+  addAndReadDataTest();
+  readRemovedDataTest();
+  cleanupOnMaxSizeTest();
+  corruptedDataTest();
+  sharedDirectoryTest();
+}
+
 class rtHttpCacheTest : public testing::Test, public commonTestFns
 {
   public:
@@ -205,7 +205,106 @@ class pxScene2dTest : public testing::Test
       EXPECT_TRUE(false == sceneptr->onChar(65));
       
     }
+
+    void pxObjectFootprintTest()
+    {
+      pxScene2d* scene = new pxScene2d();
+      rtRef<pxObject> root = new pxObject(scene);
+      const int count = 10000;
+      for (int i = 0; i < count; i++)
+      {
+        rtRef<pxObject> o = new pxObject(scene);
+        o->setParent(root.getPtr());
+      }
+
+      // rare state lives in pxObjectExtra; grow this only deliberately
+      if (sizeof(void*) == 8)
+      {
+        EXPECT_TRUE (sizeof(pxObject) <= 264);
+      }
+
+      // plain nodes never allocate their side state, even once updated
+      double start = pxMilliseconds();
+      root->update(pxSeconds());
+      double elapsed = pxMilliseconds() - start;
+      ASSERT_TRUE (count == (int)root->mChildren.size());
+      int allocated = 0;
+      for (int i = 0; i < count; i++)
+      {
+        pxObject* o = root->mChildren[i].getPtr();
+        EXPECT_TRUE (RT_OK == o->setX(10));
+        if (o->mExtra != NULL)
+          allocated++;
+      }
+      EXPECT_TRUE (0 == allocated);
+
+      pxObject* first = root->mChildren[0].getPtr();
+      EXPECT_TRUE (RT_OK == first->setId("first"));
+      EXPECT_TRUE (NULL != first->mExtra);
+      EXPECT_TRUE (NULL == root->mChildren[1]->mExtra);
+      EXPECT_TRUE (first == pxObject::getObjectById("first", root.getPtr()));
+      rtLogInfo("pxObject: %u bytes per node, %g ms to update %d nodes",
+                (uint32_t)sizeof(pxObject), elapsed, count);
+
+      EXPECT_TRUE (RT_OK == root->removeAll());
+      delete scene;
+    }
    
+    void batchTest()
+    {
+      pxScene2d* scene = new pxScene2d();
+      rtRef<pxObject> root = new pxObject(scene);
+
+      rtRefT<rtArrayObject> descriptors = new rtArrayObject;
+      for (int i = 0; i < 3; i++)
+      {
+        rtObjectRef d = new rtMapObject;
+        d.set("t", "object");
+        d.set("parent", rtObjectRef(root.getPtr()));
+        d.set("x", i * 10);
+        descriptors->pushBack(d);
+      }
+      rtObjectRef objects;
+      EXPECT_TRUE (RT_OK == scene->createAll(rtObjectRef(descriptors.getPtr()), objects));
+      EXPECT_TRUE (3 == objects.get<uint32_t>("length"));
+      EXPECT_TRUE (3 == root->numChildren());
+      rtObjectRef second = objects.get<rtObjectRef>(1);
+      EXPECT_TRUE (10 == second.get<float>("x"));
+
+      rtObjectRef props = new rtMapObject;
+      props.set("x", 5);
+      props.set("a", 0.5);
+      rtRefT<rtArrayObject> updates = new rtArrayObject;
+      updates->pushBack(second);
+      updates->pushBack(props);
+      EXPECT_TRUE (RT_OK == scene->applyBatch(rtObjectRef(updates.getPtr())));
+      EXPECT_TRUE (5 == second.get<float>("x"));
+      EXPECT_TRUE (0.5 == second.get<float>("a"));
+      updates->pushBack(second);
+      EXPECT_TRUE (RT_ERROR_INVALID_ARG == scene->applyBatch(rtObjectRef(updates.getPtr())));
+
+      pxObject* third = (pxObject*)objects.get<rtObjectRef>(2).getPtr();
+      rtObjectRef moreProps = new rtMapObject;
+      moreProps.set("y", 7);
+      moreProps.set("w", 20);
+      EXPECT_TRUE (RT_OK == third->setProps(moreProps));
+      EXPECT_TRUE (7 == third->y());
+      EXPECT_TRUE (20 == third->w());
+      EXPECT_TRUE (RT_ERROR_INVALID_ARG == third->setProps(rtObjectRef()));
+
+      // a failing descriptor leaves nothing from the batch attached
+      rtObjectRef bad = new rtMapObject;
+      bad.set("t", "noSuchType");
+      descriptors->pushBack(bad);
+      rtObjectRef none;
+      EXPECT_TRUE (RT_OK != scene->createAll(rtObjectRef(descriptors.getPtr()), none));
+      EXPECT_TRUE (!none);
+      EXPECT_TRUE (3 == root->numChildren());
+
+      EXPECT_TRUE (RT_OK == root->removeAll());
+      delete scene;
+    }
+
     void pxScene2dClassTest()
     {
       mUrl = "test_OSCILLATE.js";
@@ -394,6 +493,49 @@ class pxScene2dTest : public testing::Test
 
  }
 
+ static rtError createTestType(pxScene2d* scene, rtObjectRef p, rtObjectRef& o)
+ {
+   o = new pxObject(scene);
+   o.set(p);
+   return RT_OK;
+ }
+
+ void registeredTypeTest()
+ {
+   pxScene2d::registerType("testType", createTestType);
+   pxScene2d* scene = new pxScene2d();
+   rtObjectRef objs[3];
+   for (int i = 0; i < 3; i++)
+   {
+     rtObjectRef p = new rtMapObject;
+     p.set("t", "testType");
+     p.set("x", 5);
+     EXPECT_TRUE(RT_OK == scene->create(p, objs[i]));
+   }
+   EXPECT_TRUE(3 == scene->mInnerpxObjects.size());
+   EXPECT_TRUE(5 == objs[0].get<int32_t>("x"));
+
+   // disposing from the front moves the last object into its slot
+   ((pxObject*)objs[0].getPtr())->dispose(false);
+   EXPECT_TRUE(2 == scene->mInnerpxObjects.size());
+   EXPECT_TRUE(objs[2].getPtr() == scene->mInnerpxObjects[0].getPtr());
+   EXPECT_TRUE(0 == ((pxObject*)objs[2].getPtr())->mSceneIndex);
+   EXPECT_TRUE(-1 == ((pxObject*)objs[0].getPtr())->mSceneIndex);
+
+   rtObjectRef p = new rtMapObject;
+   p.set("t", "noSuchType");
+   rtObjectRef o;
+   EXPECT_TRUE(RT_FAIL == scene->create(p, o));
+   delete scene;
+
+   // leave the global type table as other tests expect it
+   pxScene2d::unregisterType("testType");
+   scene = new pxScene2d();
+   p.set("t", "testType");
+   EXPECT_TRUE(RT_FAIL == scene->create(p, o));
+   delete scene;
+ }
+
  void multipleArchiveTest()
  {
    pxScene2d* scene = new pxScene2d();
@@ -423,9 +565,12 @@ TEST_F(pxScene2dTest, pxScene2dTests)
     populateAllAppsConfigTest();
     populateAllAppDetailsTest();
     pxObjectTest();
+    pxObjectFootprintTest();
+    batchTest();
     pxScene2dClassTest();
     //pxScene2dHdrTest();
     pxScriptViewTest();
     multipleArchiveTest();
+    registeredTypeTest();
   
 }
@@ -32,6 +32,7 @@ limitations under the License.
 #include <pxOffscreen.h>
 #include <pxUtil.h>
 #include <pxCore.h>
+#include <pxTimer.h>
 #include <dlfcn.h>
 #include <png.h>
 
@@ -273,6 +274,87 @@ class pxUtilTest : public testing::Test
       EXPECT_TRUE (ret == RT_OK);
     }
 
+    void pxLoadPNGImageScaledTest()
+    {
+      rtData d;
+      rtError loadImageSuccess = rtLoadFile("supportfiles/status_bg.png", d);
+      EXPECT_TRUE (loadImageSuccess == RT_OK);
+
+      // 1623x1064 source reduced by 4 still covers the requested 400x200
+      pxOffscreen o;
+      rtError ret = pxLoadPNGImage((const char*)d.data(), d.length(), o, 400, 200);
+      EXPECT_TRUE (ret == RT_OK);
+      EXPECT_EQ (406, o.width());
+      EXPECT_EQ (266, o.height());
+
+      ret = pxLoadImage((const char*)d.data(), d.length(), o, 400, 200);
+      EXPECT_TRUE (ret == RT_OK);
+      EXPECT_EQ (406, o.width());
+
+      // Targets larger than the source leave it at full size
+      ret = pxLoadPNGImage((const char*)d.data(), d.length(), o, 2000, 2000);
+      EXPECT_TRUE (ret == RT_OK);
+      EXPECT_EQ (1623, o.width());
+      EXPECT_EQ (1064, o.height());
+    }
+
+    void pxImageStreamDecoderTest()
+    {
+      rtData d;
+      rtError loadImageSuccess = rtLoadFile("supportfiles/status_bg.png", d);
+      EXPECT_TRUE (loadImageSuccess == RT_OK);
+
+      pxOffscreen o;
+      pxImageStreamDecoder decoder(o, 400, 200);
+      const char* data = (const char*)d.data();
+      size_t half = d.length() / 2;
+
+      // Header arrives in the first chunk
+      EXPECT_TRUE (decoder.feed(data, 1000) == RT_OK);
+      EXPECT_TRUE (decoder.hasDimensions());
+      EXPECT_EQ (406, decoder.width());
+      EXPECT_EQ (266, decoder.height());
+
+      EXPECT_TRUE (decoder.feed(data + 1000, half - 1000) == RT_OK);
+      EXPECT_FALSE (decoder.isComplete());
+
+      EXPECT_TRUE (decoder.feed(data + half, d.length() - half) == RT_OK);
+      EXPECT_TRUE (decoder.isComplete());
+      EXPECT_EQ (406, o.width());
+
+      // Not an image we can stream
+      pxOffscreen svg;
+      pxImageStreamDecoder svgDecoder(svg);
+      rtString s("<svg xmlns=\"http://www.w3.org/2000/svg\"></svg>");
+      EXPECT_TRUE (svgDecoder.feed(s.cString(), s.byteLength()) == RT_FAIL);
+      EXPECT_TRUE (svgDecoder.failed());
+    }
+
+    void pxReduceImageTest()
+    {
+      // 5x3 of opaque white with one transparent red pixel in the first 2x2 block
+      pxOffscreen src;
+      src.initWithColor(5, 3, pxPixel(255, 255, 255, 255));
+      src.pixel(0, 0)->u = pxPixel(255, 0, 0, 0).u;
+
+      pxOffscreen dst;
+      EXPECT_TRUE (pxReduceImage(src, dst, 2, 2, true) == RT_OK);
+      EXPECT_EQ (3, dst.width());
+      EXPECT_EQ (2, dst.height());
+      EXPECT_TRUE (dst.upsideDown());
+
+      // Transparent color doesn't bleed into the average
+      pxPixel* p = dst.pixel(0, 0);
+      EXPECT_EQ (255, p->g);
+      EXPECT_EQ (191, p->a);
+
+      // Partial blocks at the edges average only the pixels they cover
+      EXPECT_EQ (255, dst.pixel(2, 1)->a);
+      EXPECT_EQ (255, dst.pixel(2, 1)->b);
+
+      EXPECT_TRUE (pxReduceImage(src, dst, 0, 2) == RT_ERROR_INVALID_ARG);
+    }
+
     void pxLoadPNGImage2ArgsFailureTest()
     {
       rtError ret = pxLoadPNGImage("bad_path_to_file/status_bg.png", mPngData);
@@ -353,6 +435,41 @@ class pxUtilTest : public testing::Test
       }
     }
 
+    void pxLoadAPngFramesTest ()
+    {
+      if (false == mDownloadImageFailed && mAnimatedPngData.numFrames() > 1)
+      {
+        // frames are decoded ahead on a worker, including after looping back
+        // to the start; each cursor keeps its own position in the sequence
+        rtRef<pxTimedOffscreenCursor> cursor = new pxTimedOffscreenCursor(mAnimatedPngData);
+        rtRef<pxTimedOffscreenCursor> other = new pxTimedOffscreenCursor(mAnimatedPngData);
+        for (uint32_t loop = 0; loop < 2; loop++)
+        {
+          for (uint32_t i = 0; i < mAnimatedPngData.numFrames(); i++)
+          {
+            pxOffscreen* o = NULL;
+            for (int tries = 0; o == NULL && tries < 500; tries++)
+            {
+              o = cursor->frame(i);
+              if (o == NULL)
+                pxSleepMS(10);
+            }
+            ASSERT_TRUE (o != NULL);
+            EXPECT_TRUE ((uint32_t)o->width() == mAnimatedPngData.width());
+            EXPECT_TRUE ((uint32_t)o->height() == mAnimatedPngData.height());
+          }
+        }
+        EXPECT_TRUE (other->frame(0) != NULL);
+
+        int32_t x, y, w, h;
+        EXPECT_TRUE (mAnimatedPngData.dirtyRect(0, 1, x, y, w, h));
+        EXPECT_TRUE (x >= 0 && y >= 0 && w > 0 && h > 0);
+        EXPECT_TRUE ((uint32_t)(x + w) <= mAnimatedPngData.width());
+        EXPECT_TRUE ((uint32_t)(y + h) <= mAnimatedPngData.height());
+        EXPECT_TRUE (false == mAnimatedPngData.dirtyRect(1, 0, x, y, w, h));
+      }
+    }
+
     void pxLoadAPngFailureTest ()
     {
       pxTimedOffscreenSequence o;
@@ -404,6 +521,9 @@ TEST_F(pxUtilTest, pxutilsTest)
     pxLoadPNGImage2ArgsSuccessTest();
     pxLoadPNGImage2ArgsFailureTest();
     pxLoadPNGImage3ArgsCreateReadStructFailTest();
+    pxLoadPNGImageScaledTest();
+    pxReduceImageTest();
+    pxImageStreamDecoderTest();
 
     // SVG tests...
     pxLoadSVGImage2ArgsSuccessTest();
@@ -431,6 +551,7 @@ TEST_F(pxUtilTest, pxutilsTest)
     //pxStorePngImagertdataCreateInfoStructFailTest();
 
     pxLoadAPngSuccessTest();
+    pxLoadAPngFramesTest();
     pxLoadAPngFailureTest();
 
     pxLoadAPNGImage2ArgsSmallImageLengthTest();
@@ -22,6 +22,7 @@ limitations under the License.
 #define protected public
 
 #include "rtObject.h"
+#include "rtPool.h"
 #include "rtString.h"
 #include <string.h>
 #include <unistd.h>
@@ -42,6 +43,43 @@ rtError callbackFn(int numArgs, const rtValue* args, rtValue* result, void* cont
 }
 rtFunctionCallback fnCallback(&callbackFn,NULL);
 
+// Stands in for a script object that hands over its properties in one call
+class snapshotObject: public rtObject, public rtIPropertySnapshot
+{
+public:
+  snapshotObject(): mSnapshots(0) {}
+
+  virtual rtError allProperties(rtValue& v) const
+  {
+    mSnapshots++;
+    rtRefT<rtMapObject> m = new rtMapObject;
+    m->set("x", rtValue(3));
+    m->set("allKeys", rtValue(1));
+    v = rtObjectRef(m.getPtr());
+    return RT_OK;
+  }
+
+  mutable int mSnapshots;
+};
+
+struct removingListenerContext
+{
+  rtEmit* emit;
+  rtIFunction* other;
+  int calls;
+};
+
+rtError removingCallbackFn(int numArgs, const rtValue* args, rtValue* result, void* context)
+{
+  UNUSED_PARAM(numArgs);
+  UNUSED_PARAM(args);
+  UNUSED_PARAM(result);
+  removingListenerContext* c = (removingListenerContext*)context;
+  c->calls++;
+  c->emit->delListener("eventremove", c->other);
+  return RT_OK;
+}
+
 class rtEmitTest : public testing::Test
 {
   public:
@@ -58,23 +96,23 @@ class rtEmitTest : public testing::Test
     {
       rtString event("eventone");
       EXPECT_TRUE (RT_OK == mEmit->setListener(event.cString(),&fnCallback));
-      EXPECT_TRUE (1 == mEmit->mEntries.size());
+      EXPECT_TRUE (1 == mEmit->listenerCount());
     }
 
     void addListenerEmptyFnTest()
     {
       rtString event("eventone");
-      size_t listenerCountBeforeAdd = mEmit->mEntries.size();
+      size_t listenerCountBeforeAdd = mEmit->listenerCount();
       EXPECT_TRUE (RT_ERROR == mEmit->addListener(event.cString(),NULL));
-      EXPECT_TRUE (listenerCountBeforeAdd == mEmit->mEntries.size());
+      EXPECT_TRUE (listenerCountBeforeAdd == mEmit->listenerCount());
     }
 
     void addListenerDuplicateEventTest()
     {
       rtString event("eventone");
-      size_t listenerCountBeforeAdd = mEmit->mEntries.size();
+      size_t listenerCountBeforeAdd = mEmit->listenerCount();
       EXPECT_TRUE (RT_OK == mEmit->addListener(event.cString(),&fnCallback));
-      EXPECT_TRUE (listenerCountBeforeAdd /* TODO: remove +1 */ + 1 == mEmit->mEntries.size());
+      EXPECT_TRUE (listenerCountBeforeAdd /* TODO: remove +1 */ + 1 == mEmit->listenerCount());
     }
 
     void addPendingEventTest()
@@ -87,9 +125,59 @@ class rtEmitTest : public testing::Test
     void delListenerTest()
     {
       rtString event("eventone");
-      size_t listenerCountBeforeDel = mEmit->mEntries.size();
+      size_t listenerCountBeforeDel = mEmit->listenerCount();
       EXPECT_TRUE (RT_OK == mEmit->delListener(event.cString(),&fnCallback));
-      EXPECT_TRUE (listenerCountBeforeDel - 1 == mEmit->mEntries.size());
+      EXPECT_TRUE (listenerCountBeforeDel - 1 == mEmit->listenerCount());
+    }
+
+    void hasListenersTest()
+    {
+      rtEmitRef emit = new rtEmit();
+      EXPECT_FALSE (emit->hasListeners("eventone"));
+      EXPECT_TRUE (RT_OK == emit->addListener("eventone",&fnCallback));
+      EXPECT_TRUE (emit->hasListeners("eventone"));
+      // names from listeners are not interned
+      EXPECT_TRUE (rtString::findInterned("eventone").isEmpty());
+      // a name interned after its bucket was made is still found
+      EXPECT_TRUE (emit->hasListeners(rtString::intern("eventone")));
+      EXPECT_FALSE (emit->hasListeners("eventtwo"));
+      EXPECT_TRUE (RT_OK == emit->delListener("eventone",&fnCallback));
+      EXPECT_FALSE (emit->hasListeners("eventone"));
+      EXPECT_TRUE (0 == emit->mEvents.size());
+    }
+
+    void internedEventNameTest()
+    {
+      rtEmitRef emit = new rtEmit();
+      rtString builtin = rtString::intern("eventbuiltin");
+      EXPECT_TRUE (RT_OK == emit->addListener("eventbuiltin",&fnCallback));
+      EXPECT_TRUE (RT_OK == emit->addListener("eventscript",&fnCallback));
+      // the bucket shares the interned text, so lookups compare pointers
+      EXPECT_TRUE (emit->findEvent(builtin)->n.cString() == builtin.cString());
+      EXPECT_FALSE (emit->findEvent("eventscript")->n.isInterned());
+      EXPECT_TRUE (emit->hasListeners(builtin));
+      EXPECT_TRUE (emit->hasListeners("eventbuiltin"));
+      EXPECT_FALSE (emit->hasListeners(rtString::intern("eventother")));
+    }
+
+    void delListenerDuringSendTest()
+    {
+      rtEmitRef emit = new rtEmit();
+      removingListenerContext first = { emit.getPtr(), NULL, 0 };
+      removingListenerContext second = { emit.getPtr(), NULL, 0 };
+      rtFunctionRef f1 = new rtFunctionCallback(&removingCallbackFn, &first);
+      rtFunctionRef f2 = new rtFunctionCallback(&removingCallbackFn, &second);
+      first.other = f2.getPtr();
+      second.other = f1.getPtr();
+      emit->addListener("eventremove", f1.getPtr());
+      emit->addListener("eventremove", f2.getPtr());
+
+      // the first listener removes the second before it is reached
+      emit.send("eventremove");
+      EXPECT_TRUE (1 == first.calls);
+      EXPECT_TRUE (0 == second.calls);
+      EXPECT_TRUE (1 == emit->listenerCount());
+      EXPECT_TRUE (0 == emit->mDispatchDepth);
     }
 
   private:
@@ -103,6 +191,9 @@ TEST_F(rtEmitTest, rtEmitTests)
   addListenerEmptyFnTest();
   addPendingEventTest();
   delListenerTest();
+  hasListenersTest();
+  internedEventNameTest();
+  delListenerDuringSendTest();
 }
 
 class rtArrayObjectTest : public testing::Test
@@ -286,6 +377,119 @@ class rtMapObjectTest : public testing::Test
       rtMapObject obj;
       EXPECT_TRUE (RT_FAIL == obj.Set("entry",NULL));
     }
+
+    void manyKeysTest()
+    {
+      // enough properties to build and grow the hash index
+      rtRefT<rtMapObject> obj = new rtMapObject;
+      char name[16];
+      for (int i = 0; i < 200; i++)
+      {
+        sprintf(name, "key%d", i);
+        EXPECT_TRUE (RT_OK == obj->set(name, rtValue(i)));
+      }
+      EXPECT_TRUE (200 == obj->count());
+
+      // overwriting keeps the count and position
+      rtValue v("replaced");
+      EXPECT_TRUE (RT_OK == obj->Set("key7", &v));
+      EXPECT_TRUE (200 == obj->count());
+      EXPECT_TRUE (obj->keyAt(7) == "key7");
+
+      rtValue got;
+      for (int i = 0; i < 200; i++)
+      {
+        sprintf(name, "key%d", i);
+        EXPECT_TRUE (RT_OK == obj->Get(name, &got));
+        if (i != 7)
+          EXPECT_TRUE (got.toInt32() == i);
+      }
+      EXPECT_TRUE (RT_OK == obj->Get("key7", &got));
+      EXPECT_TRUE (got.toString() == "replaced");
+      EXPECT_TRUE (RT_PROP_NOT_FOUND == obj->Get("key200", &got));
+
+      // allKeys keeps insertion order
+      rtObjectRef keys;
+      EXPECT_TRUE (RT_OK == obj->Get("allKeys", &got));
+      keys = got.toObject();
+      EXPECT_TRUE (200 == keys.get<uint32_t>("length"));
+      EXPECT_TRUE (keys.get<rtString>(150) == "key150");
+    }
+
+    void reserveTest()
+    {
+      rtMapObject obj;
+      obj.reserve(64);
+      obj.set("a", rtValue(1));
+      obj.set("b", rtValue("two"));
+      EXPECT_TRUE (2 == obj.count());
+      EXPECT_TRUE (obj.valueAt(1).toString() == "two");
+
+      // setting a property from another of the same map
+      EXPECT_TRUE (RT_OK == obj.Set("c", &obj.valueAt(1)));
+      EXPECT_TRUE (obj.get<rtString>("c") == "two");
+    }
+
+    void poolTest()
+    {
+      rtRefT<rtMapObject> a = new rtMapObject;
+      a->set("x", rtValue(1));
+      void* p = a.getPtr();
+      a = NULL;
+      rtRefT<rtMapObject> b = new rtMapObject;
+#ifndef DISABLE_RT_POOL
+      // freed block is handed out again
+      EXPECT_TRUE (p == b.getPtr());
+#else
+      (void)p;
+#endif
+      EXPECT_TRUE (0 == b->count());
+    }
+
+    void setFromMapTest()
+    {
+      rtRefT<rtMapObject> props = new rtMapObject;
+      props->set("x", rtValue(10));
+      props->set("label", rtValue("batched"));
+
+      rtRefT<rtMapObject> target = new rtMapObject;
+      target->set("x", rtValue(1));
+      target->set(rtObjectRef(props));
+      EXPECT_TRUE (2 == target->count());
+      EXPECT_TRUE (target->get<int32_t>("x") == 10);
+      EXPECT_TRUE (target->get<rtString>("label") == "batched");
+
+      // a snapshot is taken once and its allKeys entry is not copied
+      rtRefT<snapshotObject> snapshot = new snapshotObject;
+      rtRefT<rtMapObject> other = new rtMapObject;
+      other->set(rtObjectRef(snapshot.getPtr()));
+      EXPECT_TRUE (1 == snapshot->mSnapshots);
+      EXPECT_TRUE (1 == other->count());
+      EXPECT_TRUE (other->get<int32_t>("x") == 3);
+    }
+
+    void eventCacheTest()
+    {
+      rtMapObjectCache cache;
+      rtObjectRef e = cache.get();
+      rtIObject* p = e.getPtr();
+      e.set("x", 1);
+      cache.recycle(e);
+      EXPECT_TRUE (NULL == e.getPtr());
+      EXPECT_TRUE (1 == cache.cached());
+
+      e = cache.get();
+      EXPECT_TRUE (p == e.getPtr());
+      EXPECT_TRUE (1 == cache.reused());
+      rtValue v;
+      EXPECT_TRUE (RT_PROP_NOT_FOUND == e->Get("x", &v));
+
+      // a retained event is left alone
+      rtObjectRef kept = e;
+      cache.recycle(e);
+      EXPECT_TRUE (0 == cache.cached());
+      EXPECT_TRUE (p == kept.getPtr());
+    }
 };
 
 TEST_F(rtMapObjectTest, rtMapObjectTests)
@@ -293,5 +497,10 @@ TEST_F(rtMapObjectTest, rtMapObjectTests)
   setValByIndexTest();
   getValByIndexTest();
   setValByIndexWithEmptyValTest();
+  manyKeysTest();
+  reserveTest();
+  poolTest();
+  setFromMapTest();
+  eventCacheTest();
 }
 
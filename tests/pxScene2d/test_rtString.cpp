@@ -92,6 +92,30 @@ class rtStringTest : public testing::Test
 
       EXPECT_TRUE(mData.length()     == 3); // UTF char count
       EXPECT_TRUE(mData.byteLength() == 3); // byte count
+
+      // cached count must follow modifications
+      mData.append("\xE2\x80\xA6");
+      EXPECT_TRUE(mData.length()     == 4);
+      EXPECT_TRUE(mData.byteLength() == 6);
+      rtString copy(mData);
+      EXPECT_TRUE(copy.length()      == 4);
+      mData = "ab";
+      EXPECT_TRUE(mData.length()     == 2);
+    }
+
+    void readerTest()
+    {
+      rtUtf8Reader reader("a\xC3\xA9" "b", true);
+      EXPECT_TRUE(reader.next()   == 'a');
+      EXPECT_TRUE(reader.offset() == 1);
+      EXPECT_TRUE(reader.next()   == 0xE9);
+      EXPECT_TRUE(reader.offset() == 3);
+      EXPECT_TRUE(reader.next()   == 'b');
+      EXPECT_TRUE(reader.offset() == 4);
+      EXPECT_TRUE(reader.next()   == 0);
+
+      rtUtf8Reader empty(NULL);
+      EXPECT_TRUE(empty.next()    == 0);
     }
 
     void cStringTest()
@@ -157,6 +181,69 @@ class rtStringTest : public testing::Test
        EXPECT_TRUE(mData.find(0, 0x34) == -1 );  // Bad !   0x34 = "4"
     }
 
+    void inlineStorageTest()
+    {
+      rtString shortStr("short");
+      EXPECT_TRUE(shortStr.mStorage     == rtString::kInline);
+      EXPECT_TRUE(shortStr.byteLength() == 5);
+
+      rtString longStr("too long to be stored inline");
+      EXPECT_TRUE(longStr.mStorage      == rtString::kHeap);
+      EXPECT_TRUE(longStr.byteLength()  == 28);
+
+      shortStr.append(" grows past the inline space");
+      EXPECT_TRUE(shortStr.mStorage     == rtString::kHeap);
+      EXPECT_TRUE(shortStr == "short grows past the inline space");
+
+      shortStr = "short";
+      EXPECT_TRUE(shortStr.mStorage     == rtString::kInline);
+      EXPECT_TRUE(shortStr.byteLength() == 5);
+
+      // appending a string to itself
+      longStr += longStr;
+      EXPECT_TRUE(longStr == "too long to be stored inlinetoo long to be stored inline");
+    }
+
+    void moveTest()
+    {
+      rtString heapStr("too long to be stored inline");
+      const char* text = heapStr.cString();
+
+      rtString moved(std::move(heapStr));
+      EXPECT_TRUE(moved.cString() == text);
+      EXPECT_TRUE(heapStr.isEmpty());
+
+      rtString inlineStr("short");
+      moved = std::move(inlineStr);
+      EXPECT_TRUE(moved == "short");
+      EXPECT_TRUE(moved.byteLength() == 5);
+    }
+
+    void internTest()
+    {
+      rtString a = rtString::intern("onMouseDown");
+      rtString b = rtString::intern("onMouseDown");
+
+      EXPECT_TRUE(a.isInterned());
+      EXPECT_TRUE(a.cString() == b.cString());
+
+      // copies share the interned text until they are modified
+      rtString c(a);
+      EXPECT_TRUE(c.cString() == a.cString());
+      c.append("!");
+      EXPECT_FALSE(c.isInterned());
+      EXPECT_TRUE(c == "onMouseDown!");
+      EXPECT_TRUE(a == "onMouseDown");
+
+      EXPECT_TRUE(rtString::intern(NULL).isEmpty());
+
+      // lookups don't intern
+      EXPECT_TRUE(rtString::findInterned("onMouseDown").cString() == a.cString());
+      EXPECT_TRUE(rtString::findInterned("notInternedName").isEmpty());
+      EXPECT_TRUE(rtString::findInterned("notInternedName").isEmpty());
+      EXPECT_TRUE(rtString::findInterned(NULL).isEmpty());
+    }
+
     private:
       rtString mData;
 };
@@ -168,11 +255,15 @@ TEST_F(rtStringTest, rtStringTests)
   appendNULLTest();
   compareTest();
   lengthTest();
+  readerTest();
   cStringTest();
 
   operatorTests();
   beginsTest();
   substringTest();
   findTests();
+  inlineStorageTest();
+  moveTest();
+  internTest();
 }
 
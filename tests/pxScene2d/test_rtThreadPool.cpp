@@ -22,13 +22,39 @@ limitations under the License.
 #define protected public
 
 #include "rtThreadPool.h"
+#include "rtSettings.h"
 #include "rtString.h"
 #include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 #include "test_includes.h" // Needs to be included last
 
 using namespace std;
 
+static std::atomic<bool> blockedTaskReleased(false);
+static std::atomic<int> tasksRun(0);
+
+static void blockedTask(void*)
+{
+  while (!blockedTaskReleased)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  tasksRun++;
+}
+
+static void quickTask(void*)
+{
+  tasksRun++;
+}
+
+static bool waitForTasks(int count)
+{
+  for (int i = 0; i < 2000 && tasksRun < count; i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  return tasksRun >= count;
+}
+
 class rtThreadPoolTest : public testing::Test
 {
   public:
@@ -72,6 +98,40 @@ class rtThreadPoolTest : public testing::Test
       p.raisePriority(s);
       EXPECT_TRUE(p.mRunning == true);
     }
+
+    void sizeSettingTest()
+    {
+      rtSettings::instance()->setValue("rtThreadPoolTestSize", rtValue(2));
+      rtThreadPool p(RT_THREAD_POOL_AUTO_THREAD_COUNT, "rtThreadPoolTestSize");
+      EXPECT_TRUE(p.mThreads.empty());
+      tasksRun = 0;
+      p.executeTask(new rtThreadTask(quickTask, NULL, ""));
+      EXPECT_TRUE(p.mNumberOfThreads == 2);
+      EXPECT_TRUE(p.mQueues.size() == 2);
+      EXPECT_TRUE(waitForTasks(1));
+      rtSettings::instance()->remove("rtThreadPoolTestSize");
+    }
+
+    void stealTest()
+    {
+      rtThreadPool p(2);
+      blockedTaskReleased = false;
+      tasksRun = 0;
+      // every other task lands in the blocked thread's queue
+      p.executeTask(new rtThreadTask(blockedTask, NULL, ""));
+      for (int i = 0; i < 4; i++)
+        p.executeTask(new rtThreadTask(quickTask, NULL, ""));
+      EXPECT_TRUE(waitForTasks(4));
+      blockedTaskReleased = true;
+      EXPECT_TRUE(waitForTasks(5));
+
+      rtThreadPoolStats stats;
+      p.stats(stats);
+      EXPECT_EQ(2, stats.threads);
+      EXPECT_EQ(0u, stats.queued);
+      EXPECT_EQ(5u, stats.executed);
+      EXPECT_TRUE(stats.stolen > 0);
+    }
 };
 
 TEST_F(rtThreadPoolTest, rtThreadPoolTests)
@@ -80,4 +140,6 @@ TEST_F(rtThreadPoolTest, rtThreadPoolTests)
   destructionNonGlobalTest();
   destructionGlobalTest();
   raisePriorityTest();
+  sizeSettingTest();
+  stealTest();
 }
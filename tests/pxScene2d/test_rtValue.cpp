@@ -625,6 +625,33 @@ class rtValueTest : public testing::Test
         // voidPtrVal.setVALUE(voidPtr v);               EXPECT_TRUE(   fv == 3.14f);
     }
 
+    void moveTest()
+    {
+        rtString text("long enough to be heap allocated");
+        const char* data = text.cString();
+
+        // the string is moved into the value and on, not copied
+        rtValue v(std::move(text));
+        EXPECT_TRUE(v.mValue.stringValue.cString() == data);
+
+        rtValue moved(std::move(v));
+        EXPECT_TRUE(moved.getType() == RT_stringType);
+        EXPECT_TRUE(moved.mValue.stringValue.cString() == data);
+        EXPECT_TRUE(v.isEmpty());
+        EXPECT_TRUE(v.getType() == RT_voidType);
+
+        rtValue num(int32_t(7));
+        num = std::move(moved);
+        EXPECT_TRUE(num.toString() == "long enough to be heap allocated");
+
+        // setting a value from its own string
+        num.setString(num.mValue.stringValue);
+        EXPECT_TRUE(num.toString() == "long enough to be heap allocated");
+
+        num = int32_t(5);
+        EXPECT_TRUE(num.toInt32() == 5);
+    }
+
     void compareTest()
     {
         rtValue    myVal_1(true);
@@ -796,5 +823,6 @@ TEST_F(rtValueTest, rtValueTests)
   testStringType();
   
   compareTest();
+  moveTest();
 }
 
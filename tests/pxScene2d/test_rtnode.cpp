@@ -17,6 +17,7 @@ limitations under the License.
 */
 
 #include "rtScript.h"
+#include "rtObject.h"
 #include "pxTimer.h"
 
 #include "test_includes.h" // Needs to be included last
@@ -27,6 +28,12 @@ bool rtNodeInit()
     return true;
 }
 
+static rtError getWrapTestObjects(int /*numArgs*/, const rtValue* /*args*/, rtValue* result, void* context)
+{
+    *result = rtObjectRef((rtIObject*)context);
+    return RT_OK;
+}
+
 TEST(pxScene2dTests, rtNodeTests)
 {
     // Create rtNode
@@ -182,6 +189,36 @@ TEST(pxScene2dTests, rtNodeTests)
     }
     #endif
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Test wrapping performance.  The first call wraps every element, the
+    // rest only look their wrappers up in the handle map.
+    {
+        rtRefT<rtArrayObject> objects = new rtArrayObject;
+        for (int i = 0; i < 1000; i++)
+          objects->pushBack(rtObjectRef(new rtObject));
+        ctx->add("wrapTestObjects", rtFunctionRef(new rtFunctionCallback(getWrapTestObjects, objects.getPtr())));
+
+        double s = pxMilliseconds();
+        rtValue val;
+        rtError err = ctx->runScript("var n = 0; for (var i = 0; i < 100; i++) n += wrapTestObjects().length; n", &val);
+        double e = pxMilliseconds();
+
+        EXPECT_TRUE( err == RT_OK );
+        EXPECT_TRUE( val.toInt32() == 100000 );
+        rtLogInfo("wrapped 100000 objects in %g ms", e - s);
+    }
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Test that a method copied off its object still calls that object, as
+    // scene.1.js does with addServiceProvider
+    {
+        ctx->add("detachTestObject", rtObjectRef(new rtObject));
+
+        rtValue val;
+        rtError err = ctx->runScript("var holder = { d: detachTestObject.description }; holder.d()", &val);
+
+        EXPECT_TRUE( err == RT_OK );
+        EXPECT_TRUE( strcmp(val.toString().cString(), "rtObject") == 0);
+    }
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     // Test Clone create performance.
     double total = 0.0;
     double count = 1000;
@@ -292,6 +292,48 @@ class UTF8Test : public testing::Test
 	EXPECT_TRUE (dest[0] == 8230); 
 	EXPECT_TRUE (retVal == 6); 
     }
+
+    void lengthSpanTest()
+    {
+      const char* str = "0123456789abcdef\xC3\xA9\xE2\x80\xA6\xF0\x9F\x98\x80 tail";
+      char* copy = strdup(str);
+      EXPECT_TRUE (u8_strlen_n(str, strlen(str)) == u8_strlen(copy));
+      EXPECT_TRUE (u8_strlen_n(str, 16) == 16);
+      EXPECT_TRUE (u8_strlen_n(str, 0) == 0);
+      free(copy);
+    }
+
+    void decodeSpanTest()
+    {
+      const char* str = "0123456789abcdefghij\xC3\xA9\xE2\x80\xA6!";
+      u_int32_t dest[STR_SIZE];
+      int offsets[STR_SIZE];
+      int consumed = 0;
+      int n = u8_decode_span(dest, offsets, STR_SIZE, str, strlen(str), &consumed);
+      EXPECT_TRUE (n == 23);
+      EXPECT_TRUE (consumed == (int)strlen(str));
+      EXPECT_TRUE (dest[0] == '0');
+      EXPECT_TRUE (dest[20] == 0xE9);
+      EXPECT_TRUE (dest[21] == 0x2026);
+      EXPECT_TRUE (dest[22] == '!');
+      EXPECT_TRUE (offsets[21] == 22);
+      EXPECT_TRUE (offsets[22] == 25);
+
+      // spans stop on character boundaries
+      n = u8_decode_span(dest, NULL, 21, str, strlen(str), &consumed);
+      EXPECT_TRUE (n == 21);
+      EXPECT_TRUE (consumed == 22);
+    }
+
+    void isValidTest()
+    {
+      EXPECT_TRUE (1 == u8_isvalid("plain ascii text", 16));
+      EXPECT_TRUE (1 == u8_isvalid("\xC3\xA9\xE2\x80\xA6\xF0\x9F\x98\x80", 9));
+      EXPECT_TRUE (0 == u8_isvalid("\xC0\x80", 2));          // overlong
+      EXPECT_TRUE (0 == u8_isvalid("\xED\xA0\x80", 3));      // surrogate
+      EXPECT_TRUE (0 == u8_isvalid("\xE2\x80", 2));          // truncated
+      EXPECT_TRUE (0 == u8_isvalid("\xF4\x90\x80\x80", 4));  // above U+10FFFF
+    }
 };
 
 TEST_F(UTF8Test, UTF8Tests)
@@ -320,4 +362,7 @@ TEST_F(UTF8Test, UTF8Tests)
   u8_incTest();
   u8_decTest();
   u8_toucsTest();
+  lengthSpanTest();
+  decodeSpanTest();
+  isValidTest();
 }